@@ -0,0 +1,259 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file channel_db.c
+ * \brief
+ * Fajl se mapira sa MAP_SHARED, tako da upis posljednjeg programa ne trazi
+ * poziv write; kernel ga sam upisuje na disk. Nova verzija se pravi u
+ * memoriji, poredi sa mapiranom i upisuje samo ako se razlikuje.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "channel_db.h"
+#include "crc32.h"
+#include "section_assembler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CHANNEL_DB_CRC_OFFSET offsetof(ChannelDbHeader, crc)
+
+static pthread_mutex_t dbMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t* dbMap = NULL;
+static size_t dbSize = 0;
+
+static uint32_t channelDbCrc(const uint8_t* image, size_t size)
+{
+    uint32_t crc = crc32Mpeg2(image, (uint32_t) CHANNEL_DB_CRC_OFFSET);
+    return crc32Mpeg2Update(crc, image + sizeof (ChannelDbHeader), (uint32_t) (size - sizeof (ChannelDbHeader)));
+}
+
+static int32_t channelDbValid(const uint8_t* image, size_t size)
+{
+    const ChannelDbHeader* header = (const ChannelDbHeader*) image;
+    if (size < sizeof (ChannelDbHeader))
+        return 0;
+    if (header->magic != CHANNEL_DB_MAGIC || header->version != CHANNEL_DB_VERSION ||
+            header->serviceSize != sizeof (ChannelDbService))
+        return 0;
+    if (size != sizeof (ChannelDbHeader) + (size_t) header->serviceCount * sizeof (ChannelDbService))
+        return 0;
+    return channelDbCrc(image, size) == header->crc;
+}
+
+int32_t channelDbOpen(const char* path)
+{
+    struct stat st;
+    void* map;
+    int fd;
+    channelDbClose();
+    fd = open(path, O_RDWR);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t) sizeof (ChannelDbHeader))
+    {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    if (!channelDbValid((const uint8_t*) map, (size_t) st.st_size))
+    {
+        printf("%s: ERROR %s is not a valid channel database\n", __FUNCTION__, path);
+        munmap(map, (size_t) st.st_size);
+        return -1;
+    }
+    pthread_mutex_lock(&dbMutex);
+    dbMap = (uint8_t*) map;
+    dbSize = (size_t) st.st_size;
+    pthread_mutex_unlock(&dbMutex);
+    return 0;
+}
+
+void channelDbClose(void)
+{
+    pthread_mutex_lock(&dbMutex);
+    if (dbMap != NULL)
+    {
+        munmap(dbMap, dbSize);
+        dbMap = NULL;
+        dbSize = 0;
+    }
+    pthread_mutex_unlock(&dbMutex);
+}
+
+const ChannelDbHeader* channelDbHeader(void)
+{
+    return (const ChannelDbHeader*) dbMap;
+}
+
+const ChannelDbService* channelDbService(uint32_t service_number)
+{
+    const ChannelDbHeader* header = channelDbHeader();
+    if (header == NULL || service_number >= header->serviceCount)
+        return NULL;
+    return (const ChannelDbService*) (dbMap + sizeof (ChannelDbHeader)) + service_number;
+}
+
+/* name of a service that is not in the SDT cache yet is kept from the previous database */
+static void channelDbKeepName(ChannelDbService* service)
+{
+    const ChannelDbHeader* header = channelDbHeader();
+    const ChannelDbService* old;
+    uint32_t i;
+    if (header == NULL)
+        return;
+    for (i = 0; i < header->serviceCount; i++)
+    {
+        old = channelDbService(i);
+        if (old->program_number == service->program_number)
+        {
+            memcpy(service->name, old->name, sizeof (service->name));
+            service->service_type = old->service_type;
+            return;
+        }
+    }
+}
+
+static void channelDbFillService(ChannelDbService* service, const PatServiceInfo* pat, const PmtTable* pmt)
+{
+    ServiceInfo info;
+    uint32_t i;
+    memset(service, 0, sizeof (ChannelDbService));
+    service->program_number = pat->program_number;
+    service->pmt_pid = pat->pid;
+    service->pcr_pid = TS_NULL_PID;
+    service->pmtVersion = 0xFF;
+    // program 0 points to the NIT and has no PMT
+    if (pat->program_number == 0 || pmt == NULL || pmt->streamCount == 0)
+        return;
+    service->pcr_pid = pmt->pmtHeader->pcr_pid;
+    service->pmtVersion = pmt->pmtHeader->version_number;
+    service->streamCount = pmt->streamCount;
+    service->teletekst = pmt->teletekst;
+    for (i = 0; i < pmt->streamCount && i < MAX_NUM_OF_PIDS; i++)
+    {
+        service->streams[i].pid = pmt->pmtServiceInfoArray[i].el_pid;
+        service->streams[i].stream_type = pmt->pmtServiceInfoArray[i].stream_type;
+        service->streams[i].stream_class = pmt->pmtServiceInfoArray[i].stream_class;
+        service->streams[i].codec = pmt->pmtServiceInfoArray[i].codec;
+        memcpy(service->streams[i].language, pmt->pmtServiceInfoArray[i].language, sizeof (service->streams[i].language));
+    }
+    if (serviceCacheGet(pat->program_number, &info) == 0)
+    {
+        memcpy(service->name, info.name, sizeof (service->name));
+        service->service_type = info.service_type;
+    }
+    else
+    {
+        channelDbKeepName(service);
+    }
+}
+
+static int32_t channelDbWrite(const char* path, const uint8_t* image, size_t size)
+{
+    char tmpPath[256];
+    ssize_t written;
+    int fd;
+    snprintf(tmpPath, sizeof (tmpPath), "%s.tmp", path);
+    fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        printf("%s: ERROR cannot create %s\n", __FUNCTION__, tmpPath);
+        return -1;
+    }
+    written = write(fd, image, size);
+    // the data has to be on disk before the rename makes it visible
+    if (written != (ssize_t) size || fsync(fd) != 0)
+    {
+        printf("%s: ERROR cannot write %s\n", __FUNCTION__, tmpPath);
+        close(fd);
+        unlink(tmpPath);
+        return -1;
+    }
+    close(fd);
+    if (rename(tmpPath, path) != 0)
+    {
+        unlink(tmpPath);
+        return -1;
+    }
+    return 0;
+}
+
+int32_t channelDbSave(const char* path, uint32_t frequency, const PatTable* patTable, PmtTable* const* pmtTable,
+                      uint32_t lastService)
+{
+    ChannelDbHeader* header;
+    ChannelDbService* services;
+    uint8_t* image;
+    size_t size;
+    uint32_t i;
+    int32_t result;
+
+    size = sizeof (ChannelDbHeader) + (size_t) patTable->serviceInfoCount * sizeof (ChannelDbService);
+    image = (uint8_t*) malloc(size);
+    if (image == NULL)
+        return -1;
+    header = (ChannelDbHeader*) image;
+    services = (ChannelDbService*) (image + sizeof (ChannelDbHeader));
+    memset(header, 0, sizeof (ChannelDbHeader));
+    header->magic = CHANNEL_DB_MAGIC;
+    header->version = CHANNEL_DB_VERSION;
+    header->serviceSize = sizeof (ChannelDbService);
+    header->frequency = frequency;
+    header->transport_stream_id = patTable->patHeader->transport_stream_id;
+    header->patVersion = patTable->patHeader->version_number;
+    header->serviceCount = patTable->serviceInfoCount;
+    for (i = 0; i < patTable->serviceInfoCount; i++)
+    {
+        channelDbFillService(&services[i], &(patTable->patServiceInfoArray[i]), pmtTable[i]);
+    }
+    header->crc = channelDbCrc(image, size);
+    header->lastService = lastService;
+
+    // unchanged multiplex: only the last service is stored, in place
+    if (dbMap != NULL && dbSize == size && ((ChannelDbHeader*) dbMap)->crc == header->crc &&
+            memcmp(dbMap, image, CHANNEL_DB_CRC_OFFSET) == 0 &&
+            memcmp(dbMap + sizeof (ChannelDbHeader), image + sizeof (ChannelDbHeader), size - sizeof (ChannelDbHeader)) == 0)
+    {
+        free(image);
+        channelDbSetLastService(lastService);
+        return 0;
+    }
+    result = channelDbWrite(path, image, size);
+    free(image);
+    if (result != 0)
+        return -1;
+    // the old mapping still points to the replaced file
+    channelDbOpen(path);
+    return 1;
+}
+
+void channelDbSetLastService(uint32_t service_number)
+{
+    pthread_mutex_lock(&dbMutex);
+    if (dbMap != NULL)
+    {
+        ((ChannelDbHeader*) dbMap)->lastService = service_number;
+    }
+    pthread_mutex_unlock(&dbMutex);
+}
@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file channel_db.h
+ * \brief
+ * Ovaj modul cuva listu programa multipleksa (PID-ovi, tipovi streamova,
+ * nazivi i posljednji gledani program) u binarnom fajlu koji se pri pokretanju
+ * mapira u memoriju. Tako posljednji program moze poceti da se reprodukuje
+ * odmah nakon zakljucavanja tjunera, dok se PAT i PMT tabele provjeravaju.
+ *
+ * Fajl ima zaglavlje i niz zapisa fiksne duzine, redom kao u PAT tabeli, tako
+ * da je redni broj programa isti kao indeks u patTable/pmtTable. Fajl se
+ * upisuje u privremeni fajl koji se zatim preimenuje, pa je uvijek ili stara
+ * ili nova verzija cijela. Posljednji gledani program nije pokriven CRC-om i
+ * mijenja se direktno u mapiranoj memoriji.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef CHANNEL_DB_H
+#define CHANNEL_DB_H
+
+#include <stdint.h>
+#include "table_parser.h"
+#include "service_cache.h"
+
+/* host programs build device_control.c with their own path */
+#ifndef CHANNEL_DB_PATH
+#define CHANNEL_DB_PATH "/home/my_config/channels.db"
+#endif
+#define CHANNEL_DB_MAGIC 0x42445443 // "CTDB"
+#define CHANNEL_DB_VERSION 1
+
+typedef struct _ChannelDbStream
+{
+    uint16_t pid;
+    uint8_t stream_type;
+    uint8_t stream_class; // StreamClass
+    uint8_t codec; // StreamCodec
+    uint8_t reserved;
+    char language[4];
+} ChannelDbStream;
+
+typedef struct _ChannelDbService
+{
+    uint16_t program_number; // 0 za NIT zapis iz PAT tabele
+    uint16_t pmt_pid;
+    uint16_t pcr_pid;
+    uint8_t pmtVersion;
+    uint8_t streamCount;
+    uint8_t teletekst;
+    uint8_t service_type; // iz SDT, 0 ako nije poznat
+    uint16_t reserved;
+    char name[SERVICE_NAME_SIZE]; // iz SDT, "" ako nije poznat
+    ChannelDbStream streams[MAX_NUM_OF_PIDS];
+} ChannelDbService;
+
+typedef struct _ChannelDbHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t serviceSize; // sizeof (ChannelDbService), stiti od promjene rasporeda
+    uint32_t frequency; // MHz, kao u konfiguraciji
+    uint16_t transport_stream_id;
+    uint8_t patVersion;
+    uint8_t serviceCount;
+    uint32_t crc; // CRC_32 (MPEG-2) zaglavlja do ovog polja i svih zapisa
+    uint32_t lastService; // van CRC-a, mijenja se na svaku promjenu programa
+} ChannelDbHeader;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja mapira fajl i provjerava zaglavlje i CRC.
+ *
+ * @param path - [in] putanja do fajla
+ * @return 0 ako je fajl ispravan, -1 ako ne postoji ili nije ispravan
+ *****************************************************************************/
+int32_t channelDbOpen(const char* path);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja uklanja mapiranje fajla.
+ *
+ *****************************************************************************/
+void channelDbClose(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca zaglavlje mapiranog fajla.
+ *
+ * @return zaglavlje, NULL ako fajl nije otvoren
+ *****************************************************************************/
+const ChannelDbHeader* channelDbHeader(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca zapis programa iz mapiranog fajla.
+ *
+ * @param service_number - [in] redni broj programa (indeks u PAT tabeli)
+ * @return zapis, NULL ako fajl nije otvoren ili program ne postoji
+ *****************************************************************************/
+const ChannelDbService* channelDbService(uint32_t service_number);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje PAT i PMT tabele u fajl, ako se razlikuju od
+ * mapiranog sadrzaja, i ponovo mapira fajl. Nazivi programa se uzimaju iz
+ * SDT kesa, a ako program jos nije u kesu, iz prethodne verzije fajla.
+ *
+ * @param path - [in] putanja do fajla
+ * @param frequency - [in] frekvencija multipleksa (MHz)
+ * @param patTable - [in] PAT tabela
+ * @param pmtTable - [in] PMT tabele, redom kao u PAT tabeli
+ * @param lastService - [in] posljednji gledani program
+ * @return 1 ako je fajl upisan, 0 ako nije bilo promjena, -1 u slucaju greske
+ *****************************************************************************/
+int32_t channelDbSave(const char* path, uint32_t frequency, const PatTable* patTable, PmtTable* const* pmtTable,
+                      uint32_t lastService);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pamti posljednji gledani program u mapiranom fajlu.
+ *
+ * @param service_number - [in] redni broj programa
+ *****************************************************************************/
+void channelDbSetLastService(uint32_t service_number);
+
+#endif
@@ -0,0 +1,392 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file clock_source.c
+ * \brief
+ * U virtuelnom rezimu svaka nit koja ceka upisuje se u listu cekanja sa svojim
+ * rokom, a zatim ceka na svojoj uslovnoj promjenljivoj bez vremenskog
+ * ogranicenja. clockAdvance uzima najraniji dogadjaj (tajmer ili cekanje),
+ * postavlja vrijeme na njegov rok i izvrsava ga. Nit koja ceka se budi tako
+ * sto se zakljuca njen mutex, pa signal ne moze biti izgubljen. Mutex sata se
+ * nikada ne drzi dok se zakljucava mutex niti ili poziva funkcija tajmera.
+ * Vodjene niti probudjene signalom (clockBroadcast) ili predajom posla
+ * (clockHandOff) broje se u busyThreads isto kao niti koje je probudio sat.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "clock_source.h"
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+typedef struct _ClockWaiter
+{
+    pthread_cond_t* condition;
+    pthread_mutex_t* mutex;
+    uint64_t deadline;
+    uint8_t driven;
+    uint8_t woken; // probudio je clockAdvance (rok je istekao)
+    uint8_t kicked; // vodjena nit probudjena signalom, racuna se u busyThreads
+    struct _ClockWaiter* next;
+} ClockWaiter;
+
+static uint8_t virtualMode = 0;
+static uint64_t virtualNow = 0;
+static pthread_mutex_t clockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t settledCondition = PTHREAD_COND_INITIALIZER;
+static ClockWaiter* waiters = NULL;
+static ClockTimer* timers = NULL;
+/* broj poslova vodjenih niti (budjenja i predaja) koji jos nisu zavrseni */
+static uint32_t busyThreads = 0;
+
+static __thread uint8_t threadDriven = 0;
+/* poslovi ove niti koji se zavrsavaju u sljedecem clockWait */
+static __thread uint32_t threadWoken = 0;
+
+static uint64_t clockMonotonic(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * CLOCK_NS_PER_SEC + (uint64_t) ts.tv_nsec;
+}
+
+/* called with clockMutex held */
+static void clockThreadSettled(void)
+{
+    if (threadWoken)
+    {
+        busyThreads -= threadWoken;
+        threadWoken = 0;
+        pthread_cond_broadcast(&settledCondition);
+    }
+}
+
+/* called with clockMutex held, before the condition is broadcast */
+static void clockKick(pthread_cond_t* condition)
+{
+    ClockWaiter* waiter;
+    for (waiter = waiters; waiter != NULL; waiter = waiter->next)
+    {
+        if (waiter->condition == condition && waiter->driven && !waiter->kicked)
+        {
+            waiter->kicked = 1;
+            busyThreads++;
+        }
+    }
+}
+
+static void clockUnlinkWaiter(ClockWaiter* waiter)
+{
+    ClockWaiter** link;
+    for (link = &waiters; *link != NULL; link = &((*link)->next))
+    {
+        if (*link == waiter)
+        {
+            *link = waiter->next;
+            return;
+        }
+    }
+}
+
+static void clockUnlinkTimer(ClockTimer* timer)
+{
+    ClockTimer** link;
+    for (link = &timers; *link != NULL; link = &((*link)->next))
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->linked = 0;
+}
+
+void clockUseVirtual(uint64_t start)
+{
+    pthread_mutex_lock(&clockMutex);
+    virtualMode = 1;
+    virtualNow = start;
+    pthread_mutex_unlock(&clockMutex);
+}
+
+uint8_t clockIsVirtual(void)
+{
+    return virtualMode;
+}
+
+uint64_t clockNow(void)
+{
+    uint64_t now;
+    if (!virtualMode)
+        return clockMonotonic();
+    pthread_mutex_lock(&clockMutex);
+    now = virtualNow;
+    pthread_mutex_unlock(&clockMutex);
+    return now;
+}
+
+int32_t clockWait(pthread_cond_t* condition, pthread_mutex_t* mutex, uint64_t deadline)
+{
+    ClockWaiter waiter;
+    struct timespec absolute;
+    uint64_t now;
+    uint64_t remaining;
+    int32_t result;
+
+    if (!virtualMode)
+    {
+        if (deadline == CLOCK_FOREVER)
+            return pthread_cond_wait(condition, mutex);
+        // condition variables use CLOCK_REALTIME, only the remaining time is taken from the monotonic clock
+        now = clockMonotonic();
+        remaining = (deadline > now) ? deadline - now : 0;
+        clock_gettime(CLOCK_REALTIME, &absolute);
+        remaining += (uint64_t) absolute.tv_nsec;
+        absolute.tv_sec += (time_t) (remaining / CLOCK_NS_PER_SEC);
+        absolute.tv_nsec = (long) (remaining % CLOCK_NS_PER_SEC);
+        return pthread_cond_timedwait(condition, mutex, &absolute);
+    }
+
+    pthread_mutex_lock(&clockMutex);
+    clockThreadSettled();
+    if (virtualNow >= deadline)
+    {
+        pthread_mutex_unlock(&clockMutex);
+        return ETIMEDOUT;
+    }
+    waiter.condition = condition;
+    waiter.mutex = mutex;
+    waiter.deadline = deadline;
+    waiter.driven = threadDriven;
+    waiter.woken = 0;
+    waiter.kicked = 0;
+    waiter.next = waiters;
+    waiters = &waiter;
+    pthread_mutex_unlock(&clockMutex);
+
+    // clockAdvance takes the mutex before signalling, so the wakeup cannot slip in before this wait
+    pthread_cond_wait(condition, mutex);
+
+    pthread_mutex_lock(&clockMutex);
+    if (waiter.woken)
+    {
+        threadWoken += waiter.driven;
+        result = ETIMEDOUT;
+    }
+    else
+    {
+        clockUnlinkWaiter(&waiter);
+        threadWoken += waiter.kicked;
+        result = 0;
+    }
+    pthread_mutex_unlock(&clockMutex);
+    return result;
+}
+
+void clockThreadDriven(uint8_t driven)
+{
+    threadDriven = driven;
+    if (!driven && virtualMode)
+    {
+        pthread_mutex_lock(&clockMutex);
+        clockThreadSettled();
+        pthread_mutex_unlock(&clockMutex);
+    }
+}
+
+void clockBroadcast(pthread_cond_t* condition)
+{
+    if (virtualMode)
+    {
+        pthread_mutex_lock(&clockMutex);
+        clockKick(condition);
+        pthread_mutex_unlock(&clockMutex);
+    }
+    pthread_cond_broadcast(condition);
+}
+
+void clockHandOff(void)
+{
+    if (!virtualMode)
+        return;
+    pthread_mutex_lock(&clockMutex);
+    busyThreads++;
+    pthread_mutex_unlock(&clockMutex);
+}
+
+void clockTakeOver(void)
+{
+    if (virtualMode)
+        threadWoken++;
+}
+
+void clockThreadIdle(void)
+{
+    if (!virtualMode)
+        return;
+    pthread_mutex_lock(&clockMutex);
+    clockThreadSettled();
+    pthread_mutex_unlock(&clockMutex);
+}
+
+void clockAdvance(uint64_t duration)
+{
+    uint64_t target;
+    ClockWaiter* waiter;
+    ClockWaiter* firstWaiter;
+    ClockTimer* timer;
+    ClockTimer* firstTimer;
+    pthread_cond_t* condition;
+    pthread_mutex_t* mutex;
+    Clock_Timer_Callback callback;
+    void* arg;
+
+    if (!virtualMode)
+        return;
+    pthread_mutex_lock(&clockMutex);
+    target = virtualNow + duration;
+    while (1)
+    {
+        // work started by the previous step (or before this call) may add earlier deadlines
+        while (busyThreads > 0)
+            pthread_cond_wait(&settledCondition, &clockMutex);
+        firstWaiter = NULL;
+        for (waiter = waiters; waiter != NULL; waiter = waiter->next)
+        {
+            if (waiter->deadline <= target && (firstWaiter == NULL || waiter->deadline <= firstWaiter->deadline))
+                firstWaiter = waiter;
+        }
+        firstTimer = NULL;
+        for (timer = timers; timer != NULL; timer = timer->next)
+        {
+            if (timer->armed && timer->deadline <= target && (firstTimer == NULL || timer->deadline < firstTimer->deadline))
+                firstTimer = timer;
+        }
+        if (firstWaiter == NULL && firstTimer == NULL)
+            break;
+
+        // timers win ties, so a wait with the same deadline sees the timer's effect
+        if (firstTimer != NULL && (firstWaiter == NULL || firstTimer->deadline <= firstWaiter->deadline))
+        {
+            if (firstTimer->deadline > virtualNow)
+                virtualNow = firstTimer->deadline;
+            firstTimer->armed = 0;
+            callback = firstTimer->callback;
+            arg = firstTimer->arg;
+            pthread_mutex_unlock(&clockMutex);
+            callback(arg);
+            pthread_mutex_lock(&clockMutex);
+            continue;
+        }
+
+        if (firstWaiter->deadline > virtualNow)
+            virtualNow = firstWaiter->deadline;
+        clockUnlinkWaiter(firstWaiter);
+        firstWaiter->woken = 1;
+        if (firstWaiter->driven)
+            busyThreads++;
+        condition = firstWaiter->condition;
+        mutex = firstWaiter->mutex;
+        pthread_mutex_unlock(&clockMutex);
+        pthread_mutex_lock(mutex);
+        // the broadcast also wakes the other driven threads waiting on the same condition
+        clockBroadcast(condition);
+        pthread_mutex_unlock(mutex);
+        pthread_mutex_lock(&clockMutex);
+    }
+    virtualNow = target;
+    pthread_mutex_unlock(&clockMutex);
+}
+
+static void clockTimerThread(union sigval value)
+{
+    ClockTimer* timer = (ClockTimer*) value.sival_ptr;
+    timer->callback(timer->arg);
+}
+
+int32_t clockTimerStart(ClockTimer* timer, uint32_t timeoutMs, Clock_Timer_Callback callback, void* arg)
+{
+    struct sigevent signalEvent;
+    struct itimerspec timerSpec;
+
+    if (virtualMode)
+    {
+        pthread_mutex_lock(&clockMutex);
+        timer->callback = callback;
+        timer->arg = arg;
+        timer->deadline = virtualNow + (uint64_t) timeoutMs * CLOCK_NS_PER_MS;
+        timer->armed = 1;
+        if (!timer->linked)
+        {
+            timer->next = timers;
+            timers = timer;
+            timer->linked = 1;
+        }
+        pthread_mutex_unlock(&clockMutex);
+        return 0;
+    }
+
+    timer->callback = callback;
+    timer->arg = arg;
+    if (!timer->created)
+    {
+        memset(&signalEvent, 0, sizeof (signalEvent));
+        signalEvent.sigev_notify = SIGEV_THREAD;
+        signalEvent.sigev_notify_function = clockTimerThread;
+        signalEvent.sigev_value.sival_ptr = timer;
+        signalEvent.sigev_notify_attributes = NULL;
+        if (timer_create(CLOCK_MONOTONIC, &signalEvent, &(timer->timerId)) != 0)
+            return -1;
+        timer->created = 1;
+    }
+    memset(&timerSpec, 0, sizeof (timerSpec));
+    timerSpec.it_value.tv_sec = timeoutMs / 1000;
+    timerSpec.it_value.tv_nsec = (long) (timeoutMs % 1000) * 1000000L;
+    // a zero it_value would disarm the timer instead of firing it
+    if (timeoutMs == 0)
+        timerSpec.it_value.tv_nsec = 1;
+    return (timer_settime(timer->timerId, 0, &timerSpec, NULL) == 0) ? 0 : -1;
+}
+
+void clockTimerStop(ClockTimer* timer)
+{
+    struct itimerspec timerSpec;
+    if (virtualMode)
+    {
+        pthread_mutex_lock(&clockMutex);
+        timer->armed = 0;
+        pthread_mutex_unlock(&clockMutex);
+        return;
+    }
+    if (timer->created)
+    {
+        memset(&timerSpec, 0, sizeof (timerSpec));
+        timer_settime(timer->timerId, 0, &timerSpec, NULL);
+    }
+}
+
+void clockTimerDelete(ClockTimer* timer)
+{
+    pthread_mutex_lock(&clockMutex);
+    timer->armed = 0;
+    if (timer->linked)
+        clockUnlinkTimer(timer);
+    pthread_mutex_unlock(&clockMutex);
+    if (timer->created)
+    {
+        timer_delete(timer->timerId);
+        timer->created = 0;
+    }
+}
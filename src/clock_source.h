@@ -0,0 +1,201 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file clock_source.h
+ * \brief
+ * Ovaj modul realizuje izvor vremena za sva cekanja sa vremenskim
+ * ogranicenjem i za tajmere. U stvarnom rezimu vrijeme je CLOCK_MONOTONIC, a
+ * u virtuelnom rezimu vrijeme stoji dok ga simulacija ne pomjeri funkcijom
+ * clockAdvance. Pomjeranje redom izvrsava tajmere i budi niti ciji je rok
+ * istekao, pa se sat simulacije moze vrtiti mnogo brze od stvarnog vremena.
+ *
+ * Nit oznacena sa clockThreadDriven(1) je vodjena satom: kada je
+ * clockAdvance probudi, sat ne ide dalje dok se nit ponovo ne vrati u
+ * clockWait (ili ne pozove clockThreadDriven(0)), tako da je redoslijed
+ * dogadjaja u simulaciji uvijek isti. Isto vazi i kada vodjenu nit probudi
+ * druga nit: preko clockBroadcast, ili preko para clockHandOff/clockTakeOver
+ * kada posao ne stize kroz clockWait (npr. petlja dogadjaja nad epoll-om).
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef CLOCK_SOURCE_H
+#define CLOCK_SOURCE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define CLOCK_NS_PER_MS 1000000ull
+#define CLOCK_NS_PER_SEC 1000000000ull
+/* rok za clockWait koje ceka samo signal */
+#define CLOCK_FOREVER UINT64_MAX
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja se poziva kada tajmer istekne. U stvarnom rezimu se
+ * poziva iz posebne niti, a u virtuelnom iz clockAdvance.
+ *
+ * @param arg - [in] pokazivac proslijedjen pri pokretanju tajmera
+ *****************************************************************************/
+typedef void(*Clock_Timer_Callback)(void* arg);
+
+typedef struct _ClockTimer
+{
+    Clock_Timer_Callback callback;
+    void* arg;
+    timer_t timerId; // stvarni rezim
+    uint8_t created;
+    uint64_t deadline; // virtuelni rezim
+    uint8_t armed;
+    uint8_t linked;
+    struct _ClockTimer* next;
+} ClockTimer;
+
+#define CLOCK_TIMER_INITIALIZER {NULL, NULL, 0, 0, 0, 0, 0, NULL}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja prebacuje sat u virtuelni rezim. Poziva se prije prvog
+ * cekanja i prvog tajmera.
+ *
+ * @param start - [in] pocetno vrijeme u ns
+ *****************************************************************************/
+void clockUseVirtual(uint64_t start);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja provjerava da li je sat u virtuelnom rezimu.
+ *
+ * @return 1 za virtuelni, 0 za stvarni rezim
+ *****************************************************************************/
+uint8_t clockIsVirtual(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca trenutno vrijeme sata.
+ *
+ * @return vrijeme u ns
+ *****************************************************************************/
+uint64_t clockNow(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ceka na uslovnu promjenljivu najkasnije do zadatog vremena.
+ * Poziva se sa zakljucanim mutex-om, kao pthread_cond_timedwait.
+ *
+ * @param condition - [in] uslovna promjenljiva
+ * @param mutex - [in] zakljucani mutex
+ * @param deadline - [in] rok po satu (clockNow() + timeout), ili CLOCK_FOREVER
+ * @return 0 ako je promjenljiva signalizirana, ETIMEDOUT ako je rok istekao
+ *****************************************************************************/
+int32_t clockWait(pthread_cond_t* condition, pthread_mutex_t* mutex, uint64_t deadline);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oznacava da je nit koja je poziva vodjena satom.
+ *
+ * @param driven - [in] 1 da bi clockAdvance cekao nit, 0 da ne bi
+ *****************************************************************************/
+void clockThreadDriven(uint8_t driven);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja budi sve niti koje cekaju na uslovnoj promjenljivoj. U
+ * virtuelnom rezimu sat ne ide dalje dok se probudjene vodjene niti ne vrate
+ * u clockWait. Poziva se sa zakljucanim mutex-om uslovne promjenljive.
+ *
+ * @param condition - [in] uslovna promjenljiva
+ *****************************************************************************/
+void clockBroadcast(pthread_cond_t* condition);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koju poziva nit koja predaje posao vodjenoj niti mimo clockWait.
+ * U virtuelnom rezimu sat ne ide dalje dok nit koja preuzme posao
+ * (clockTakeOver) ne zavrsi. Poziva se prije nego sto posao postane vidljiv
+ * niti koja ga preuzima.
+ *
+ *****************************************************************************/
+void clockHandOff(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koju poziva nit kada preuzme posao predat sa clockHandOff. Posao
+ * je zavrsen kada nit ponovo pozove clockWait ili clockThreadIdle.
+ *
+ *****************************************************************************/
+void clockTakeOver(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koju poziva nit prije nego sto pocne da ceka mimo sata (epoll,
+ * pthread_cond_wait), da bi zavrsila preuzete poslove.
+ *
+ *****************************************************************************/
+void clockThreadIdle(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pomjera virtuelni sat. Tajmeri i cekanja se zavrsavaju redom
+ * po rokovima. Ne smije se pozivati sa zakljucanim mutex-om neke niti koja
+ * ceka u clockWait. U stvarnom rezimu ne radi nista.
+ *
+ * @param duration - [in] pomjeraj u ns
+ *****************************************************************************/
+void clockAdvance(uint64_t duration);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pokrece jednokratni tajmer. Ako tajmer vec ceka, novi rok
+ * zamjenjuje stari.
+ *
+ * @param timer - [in/out] tajmer (CLOCK_TIMER_INITIALIZER)
+ * @param timeoutMs - [in] vrijeme do isteka u ms
+ * @param callback - [in] funkcija koja se poziva po isteku
+ * @param arg - [in] argument funkcije
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t clockTimerStart(ClockTimer* timer, uint32_t timeoutMs, Clock_Timer_Callback callback, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja tajmer ako jos nije istekao.
+ *
+ * @param timer - [in/out] tajmer
+ *****************************************************************************/
+void clockTimerStop(ClockTimer* timer);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja tajmer i oslobadja njegove resurse.
+ *
+ * @param timer - [in/out] tajmer
+ *****************************************************************************/
+void clockTimerDelete(ClockTimer* timer);
+
+#endif
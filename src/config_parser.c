@@ -78,6 +78,8 @@ int32_t parseConfig(config_parameters * parms, char* config_file_path)
             sscanf(value, "%d", &(parms->aPid));
         else if (strcmp(name, "vPID") == 0)
             sscanf(value, "%d", &(parms->vPid));
+        else if (strcmp(name, "zapSettle") == 0)
+            sscanf(value, "%u", &(parms->zapSettleMs));
         else if (strcmp(name, "module") == 0)
         {
             parms->module = str2TModule(value);
@@ -112,6 +114,7 @@ void dumpConfig(const config_parameters * const parms)
     printf("aPid:%d\n", parms->aPid);
     printf("vType:%d\n", parms->vType);
     printf("aType:%d\n", parms->aType);
+    printf("zapSettle:%u\n", parms->zapSettleMs);
 }
 
 void initDefaultValues(config_parameters* parms)
@@ -127,6 +130,7 @@ void initDefaultValues(config_parameters* parms)
     parms->module = DVB_T;
     parms->aType = AUDIO_TYPE_DOLBY_AC3;
     parms->vType = VIDEO_TYPE_MPEG2;
+    parms->zapSettleMs = ZAP_SETTLE_DEFAULT_MS;
 }
 
 tStreamType str2AudioType(char* aType)
@@ -29,6 +29,8 @@
 #include "tdp_api.h"
 
 #define MHZ 1000000U
+/* ms bez nove promjene programa nakon kojih se mijenjaju streamovi */
+#define ZAP_SETTLE_DEFAULT_MS 300
 
 typedef struct config_parameters_s
 {
@@ -39,6 +41,7 @@ typedef struct config_parameters_s
     t_Module module;
     tStreamType aType;
     tStreamType vType;
+    uint32_t zapSettleMs;
 }
 config_parameters;
 
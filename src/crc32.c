@@ -0,0 +1,311 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file crc32.c
+ * \brief
+ * Ovaj modul realizuje racunanje CRC_32 (MPEG-2) kojim su zasticene PSI/SI
+ * sekcije. Implementacija se bira u toku izvrsavanja: carry-less mnozenje
+ * (PCLMULQDQ na x86, PMULL na ARMv8) ako ga procesor podrzava, a u suprotnom
+ * tabelarni slicing-by-8 algoritam.
+ *
+ * CRC_32 (MPEG-2) nije reflektovan, pa se u carry-less varijanti svaki blok od
+ * 16 bajta obrne u big-endian redoslijed. Blokovi se "presavijaju" (fold)
+ * mnozenjem sa x^D mod P sve dok ne ostane jedan blok, koji se zajedno sa
+ * ostatkom niza zavrsava tabelarnim algoritmom, tako da Barrett redukcija
+ * nije potrebna.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "crc32.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC32_HAVE_CLMUL 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC32_HAVE_CLMUL 1
+#endif
+
+#define CRC32_MPEG2_POLY 0x04C11DB7
+/* ispod ove duzine carry-less varijanta nema prednost nad tabelom */
+#define CRC32_CLMUL_MIN_LENGTH 64
+
+typedef uint32_t(*Crc32Function)(uint32_t crc, const uint8_t* data, uint32_t length);
+
+static uint32_t crcTable[8][256];
+static pthread_once_t crcOnce = PTHREAD_ONCE_INIT;
+static Crc32Function crcFunction = NULL;
+static Crc32Implementation crcImplementation = CRC32_IMPL_TABLE;
+static uint8_t clmulSupported = 0;
+
+/* konstante za presavijanje: {x^D mod P, x^(D+64) mod P} */
+static uint64_t fold128[2];
+static uint64_t fold512[2];
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja racuna x^k mod P.
+ *
+ * @param k - [in] stepen
+ * @return x^k mod P
+ *****************************************************************************/
+static uint32_t crc32XPowModP(uint32_t k)
+{
+    uint32_t r = 1;
+    while (k--)
+    {
+        r = (r & 0x80000000) ? (r << 1) ^ CRC32_MPEG2_POLY : (r << 1);
+    }
+    return r;
+}
+
+static uint32_t crc32Table(uint32_t crc, const uint8_t* data, uint32_t length)
+{
+    uint32_t one;
+    uint32_t two;
+    while (length >= 8)
+    {
+        one = crc ^ (((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3]);
+        two = ((uint32_t) data[4] << 24) | ((uint32_t) data[5] << 16) | ((uint32_t) data[6] << 8) | data[7];
+        crc = crcTable[7][one >> 24] ^ crcTable[6][(one >> 16) & 0xFF] ^
+                crcTable[5][(one >> 8) & 0xFF] ^ crcTable[4][one & 0xFF] ^
+                crcTable[3][two >> 24] ^ crcTable[2][(two >> 16) & 0xFF] ^
+                crcTable[1][(two >> 8) & 0xFF] ^ crcTable[0][two & 0xFF];
+        data += 8;
+        length -= 8;
+    }
+    while (length--)
+    {
+        crc = (crc << 8) ^ crcTable[0][(crc >> 24) ^ *data++];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i crc32Fold(__m128i x, __m128i k, __m128i next)
+{
+    __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static uint32_t crc32Clmul(uint32_t crc, const uint8_t* data, uint32_t length)
+{
+    const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k128 = _mm_set_epi64x((int64_t) fold128[1], (int64_t) fold128[0]);
+    const __m128i k512 = _mm_set_epi64x((int64_t) fold512[1], (int64_t) fold512[0]);
+    __m128i x0, x1, x2, x3;
+    uint8_t last[16];
+
+    if (length < CRC32_CLMUL_MIN_LENGTH)
+        return crc32Table(crc, data, length);
+
+    x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data), swap);
+    x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 16)), swap);
+    x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 32)), swap);
+    x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 48)), swap);
+    x0 = _mm_xor_si128(x0, _mm_set_epi32((int32_t) crc, 0, 0, 0));
+    data += 64;
+    length -= 64;
+
+    while (length >= 64)
+    {
+        x0 = crc32Fold(x0, k512, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data), swap));
+        x1 = crc32Fold(x1, k512, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 16)), swap));
+        x2 = crc32Fold(x2, k512, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 32)), swap));
+        x3 = crc32Fold(x3, k512, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 48)), swap));
+        data += 64;
+        length -= 64;
+    }
+
+    x1 = crc32Fold(x0, k128, x1);
+    x2 = crc32Fold(x1, k128, x2);
+    x3 = crc32Fold(x2, k128, x3);
+    while (length >= 16)
+    {
+        x3 = crc32Fold(x3, k128, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data), swap));
+        data += 16;
+        length -= 16;
+    }
+
+    _mm_storeu_si128((__m128i*) last, _mm_shuffle_epi8(x3, swap));
+    crc = crc32Table(0, last, sizeof (last));
+    return crc32Table(crc, data, length);
+}
+
+static uint8_t crc32ClmulSupported(void)
+{
+    __builtin_cpu_init();
+    return (uint8_t) (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"));
+}
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crypto")))
+static inline uint8x16_t crc32Load(const uint8_t* data)
+{
+    uint8x16_t v = vrev64q_u8(vld1q_u8(data));
+    return vextq_u8(v, v, 8);
+}
+
+__attribute__((target("+crypto")))
+static inline uint8x16_t crc32Fold(uint8x16_t x, poly64x2_t k, uint8x16_t next)
+{
+    poly64x2_t xv = vreinterpretq_p64_u8(x);
+    uint8x16_t hi = vreinterpretq_u8_p128(vmull_high_p64(xv, k));
+    uint8x16_t lo = vreinterpretq_u8_p128(vmull_p64(vgetq_lane_p64(xv, 0), vgetq_lane_p64(k, 0)));
+    return veorq_u8(veorq_u8(hi, lo), next);
+}
+
+__attribute__((target("+crypto")))
+static uint32_t crc32Clmul(uint32_t crc, const uint8_t* data, uint32_t length)
+{
+    const poly64x2_t k128 = vreinterpretq_p64_u64(vcombine_u64(vcreate_u64(fold128[0]), vcreate_u64(fold128[1])));
+    const poly64x2_t k512 = vreinterpretq_p64_u64(vcombine_u64(vcreate_u64(fold512[0]), vcreate_u64(fold512[1])));
+    uint8x16_t x0, x1, x2, x3;
+    uint8_t last[16];
+
+    if (length < CRC32_CLMUL_MIN_LENGTH)
+        return crc32Table(crc, data, length);
+
+    x0 = crc32Load(data);
+    x1 = crc32Load(data + 16);
+    x2 = crc32Load(data + 32);
+    x3 = crc32Load(data + 48);
+    x0 = veorq_u8(x0, vreinterpretq_u8_u32(vsetq_lane_u32(crc, vdupq_n_u32(0), 3)));
+    data += 64;
+    length -= 64;
+
+    while (length >= 64)
+    {
+        x0 = crc32Fold(x0, k512, crc32Load(data));
+        x1 = crc32Fold(x1, k512, crc32Load(data + 16));
+        x2 = crc32Fold(x2, k512, crc32Load(data + 32));
+        x3 = crc32Fold(x3, k512, crc32Load(data + 48));
+        data += 64;
+        length -= 64;
+    }
+
+    x1 = crc32Fold(x0, k128, x1);
+    x2 = crc32Fold(x1, k128, x2);
+    x3 = crc32Fold(x2, k128, x3);
+    while (length >= 16)
+    {
+        x3 = crc32Fold(x3, k128, crc32Load(data));
+        data += 16;
+        length -= 16;
+    }
+
+    x3 = vrev64q_u8(x3);
+    vst1q_u8(last, vextq_u8(x3, x3, 8));
+    crc = crc32Table(0, last, sizeof (last));
+    return crc32Table(crc, data, length);
+}
+
+static uint8_t crc32ClmulSupported(void)
+{
+    return (uint8_t) ((getauxval(AT_HWCAP) & HWCAP_PMULL) != 0);
+}
+
+#endif
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja generise tabele i bira implementaciju. Poziva se tacno jednom.
+ *
+ *****************************************************************************/
+static void crc32InitOnce(void)
+{
+    uint32_t i;
+    uint32_t k;
+    uint32_t crc;
+    for (i = 0; i < 256; i++)
+    {
+        crc = i << 24;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ CRC32_MPEG2_POLY : (crc << 1);
+        }
+        crcTable[0][i] = crc;
+    }
+    for (k = 1; k < 8; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            crcTable[k][i] = (crcTable[k - 1][i] << 8) ^ crcTable[0][crcTable[k - 1][i] >> 24];
+        }
+    }
+
+    fold128[0] = crc32XPowModP(128);
+    fold128[1] = crc32XPowModP(128 + 64);
+    fold512[0] = crc32XPowModP(512);
+    fold512[1] = crc32XPowModP(512 + 64);
+
+    crcFunction = crc32Table;
+    crcImplementation = CRC32_IMPL_TABLE;
+#ifdef CRC32_HAVE_CLMUL
+    clmulSupported = crc32ClmulSupported();
+    if (clmulSupported)
+    {
+        crcFunction = crc32Clmul;
+        crcImplementation = CRC32_IMPL_CLMUL;
+    }
+#endif
+}
+
+uint32_t crc32Mpeg2Update(uint32_t crc, const uint8_t* data, uint32_t length)
+{
+    pthread_once(&crcOnce, crc32InitOnce);
+    return crcFunction(crc, data, length);
+}
+
+uint32_t crc32Mpeg2(const uint8_t* data, uint32_t length)
+{
+    return crc32Mpeg2Update(CRC32_MPEG2_INIT, data, length);
+}
+
+Crc32Implementation crc32GetImplementation(void)
+{
+    pthread_once(&crcOnce, crc32InitOnce);
+    return crcImplementation;
+}
+
+int32_t crc32SelectImplementation(Crc32Implementation implementation)
+{
+    pthread_once(&crcOnce, crc32InitOnce);
+    if (implementation == CRC32_IMPL_TABLE)
+    {
+        crcFunction = crc32Table;
+        crcImplementation = CRC32_IMPL_TABLE;
+        return 0;
+    }
+#ifdef CRC32_HAVE_CLMUL
+    if (implementation == CRC32_IMPL_CLMUL && clmulSupported)
+    {
+        crcFunction = crc32Clmul;
+        crcImplementation = CRC32_IMPL_CLMUL;
+        return 0;
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file crc32.h
+ * \brief
+ * Ovaj modul realizuje racunanje CRC_32 (MPEG-2) kojim su zasticene PSI/SI
+ * sekcije. Implementacija se bira u toku izvrsavanja: carry-less mnozenje
+ * (PCLMULQDQ na x86, PMULL na ARMv8) ako ga procesor podrzava, a u suprotnom
+ * tabelarni slicing-by-8 algoritam.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+#define CRC32_MPEG2_INIT 0xFFFFFFFF
+
+typedef enum _Crc32Implementation
+{
+    CRC32_IMPL_TABLE = 0, /* slicing-by-8, radi na svim procesorima */
+    CRC32_IMPL_CLMUL /* PCLMULQDQ (x86) ili PMULL (ARMv8) */
+} Crc32Implementation;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja racuna CRC_32 (MPEG-2) nad nizom bajtova, pocevsi od
+ * CRC32_MPEG2_INIT. Za ispravnu sekciju rezultat nad cijelom sekcijom,
+ * ukljucujuci CRC_32 polje, je 0.
+ *
+ * @param data - [in] niz bajtova
+ * @param length - [in] duzina niza
+ * @return vrijednost CRC_32
+ *****************************************************************************/
+uint32_t crc32Mpeg2(const uint8_t* data, uint32_t length);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja nastavlja racunanje CRC_32 (MPEG-2) nad sljedecim dijelom niza.
+ *
+ * @param crc - [in] dosadasnja vrijednost (CRC32_MPEG2_INIT na pocetku)
+ * @param data - [in] niz bajtova
+ * @param length - [in] duzina niza
+ * @return nova vrijednost CRC_32
+ *****************************************************************************/
+uint32_t crc32Mpeg2Update(uint32_t crc, const uint8_t* data, uint32_t length);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca implementaciju koja je trenutno u upotrebi.
+ *
+ * @return izabrana implementacija
+ *****************************************************************************/
+Crc32Implementation crc32GetImplementation(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja forsira odredjenu implementaciju (koristi se za mjerenja).
+ *
+ * @param implementation - [in] zeljena implementacija
+ * @return 0 ako je implementacija podrzana na ovom procesoru, -1 u suprotnom
+ *****************************************************************************/
+int32_t crc32SelectImplementation(Crc32Implementation implementation);
+
+#endif
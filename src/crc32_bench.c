@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file crc32_bench.c
+ * \brief
+ * Program za mjerenje propusnosti CRC_32 (MPEG-2) implementacija na
+ * tipicnim duzinama sekcija. Ispisuje se broj bajtova po nanosekundi
+ * (CLOCK_MONOTONIC), jer rdtsc broji konstantnu frekvenciju a ne taktove
+ * procesora.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "crc32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define BENCH_TOTAL_BYTES (256u * 1024u * 1024u)
+/* CRC_32 (MPEG-2) niza "123456789" */
+#define BENCH_CHECK_VALUE 0x0376E6E7u
+/* duzine i pomjeraji na kojima se implementacije porede sa tabelom */
+#define BENCH_VERIFY_LENGTHS 5000u
+#define BENCH_VERIFY_ALIGNMENTS 16u
+
+static uint64_t benchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/* checks the standard check value, then compares with CRC32_IMPL_TABLE for every length and alignment */
+static int32_t benchVerify(const char* name, Crc32Implementation implementation, const uint8_t* data)
+{
+    static const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    uint32_t length;
+    uint32_t offset;
+    uint32_t reference;
+    uint32_t crc;
+    crc32SelectImplementation(implementation);
+    crc = crc32Mpeg2(check, sizeof (check));
+    if (crc != BENCH_CHECK_VALUE)
+    {
+        printf("%s: ERROR %s check value %08x, expected %08x\n", __FUNCTION__, name, crc, BENCH_CHECK_VALUE);
+        return -1;
+    }
+    if (implementation == CRC32_IMPL_TABLE)
+    {
+        printf("%-6s check value %08x\n", name, crc);
+        return 0;
+    }
+    for (length = 0; length < BENCH_VERIFY_LENGTHS; length++)
+    {
+        for (offset = 0; offset < BENCH_VERIFY_ALIGNMENTS; offset++)
+        {
+            crc32SelectImplementation(CRC32_IMPL_TABLE);
+            reference = crc32Mpeg2(data + offset, length);
+            crc32SelectImplementation(implementation);
+            crc = crc32Mpeg2(data + offset, length);
+            if (crc != reference)
+            {
+                printf("%s: ERROR %s length %u offset %u: %08x, table %08x\n", __FUNCTION__, name,
+                       length, offset, crc, reference);
+                return -1;
+            }
+        }
+    }
+    printf("%-6s matches table for lengths 0-%u at %u alignments (check %08x)\n", name,
+           BENCH_VERIFY_LENGTHS - 1, BENCH_VERIFY_ALIGNMENTS, BENCH_CHECK_VALUE);
+    return 0;
+}
+
+static int32_t benchRun(const char* name, const uint8_t* data, uint32_t length, uint32_t reference)
+{
+    uint32_t iterations = BENCH_TOTAL_BYTES / length;
+    uint32_t i;
+    uint32_t crc = 0;
+    uint64_t start;
+    uint64_t elapsed;
+    start = benchNow();
+    for (i = 0; i < iterations; i++)
+    {
+        crc = crc32Mpeg2(data, length);
+    }
+    elapsed = benchNow() - start;
+    printf("%-6s %5u bytes: %6.2f bytes/ns (crc %08x)\n", name, length,
+           (double) iterations * length / (double) elapsed, crc);
+    if (crc != reference)
+    {
+        printf("%s: ERROR %s crc %08x, table %08x\n", __FUNCTION__, name, crc, reference);
+        return -1;
+    }
+    return 0;
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    static const uint32_t lengths[] = {188, 1024, 4096, 65536};
+    uint8_t* data;
+    uint32_t reference;
+    uint8_t clmul;
+    int32_t result = 0;
+    uint32_t i;
+    data = (uint8_t*) malloc(65536);
+    if (data == NULL)
+        return 1;
+    for (i = 0; i < 65536; i++)
+    {
+        data[i] = (uint8_t) (i * 131 + 7);
+    }
+    clmul = (crc32SelectImplementation(CRC32_IMPL_CLMUL) == 0);
+    if (benchVerify("table", CRC32_IMPL_TABLE, data) != 0 ||
+            (clmul && benchVerify("clmul", CRC32_IMPL_CLMUL, data) != 0))
+    {
+        free(data);
+        return 1;
+    }
+    for (i = 0; i < sizeof (lengths) / sizeof (lengths[0]); i++)
+    {
+        crc32SelectImplementation(CRC32_IMPL_TABLE);
+        reference = crc32Mpeg2(data, lengths[i]);
+        if (benchRun("table", data, lengths[i], reference) != 0)
+            result = 1;
+        if (clmul)
+        {
+            crc32SelectImplementation(CRC32_IMPL_CLMUL);
+            if (benchRun("clmul", data, lengths[i], reference) != 0)
+                result = 1;
+        }
+    }
+    free(data);
+    return result;
+}
@@ -21,6 +21,18 @@
 
 #include "tdp_api.h"
 #include "table_parser.h"
+#include "psi_cache.h"
+#include "now_next.h"
+#include "epg_index.h"
+#include "service_cache.h"
+#include "network_map.h"
+#include "pmt_acquisition.h"
+#include "pid_router.h"
+#include "clock_source.h"
+#include "zap_stats.h"
+#include "channel_db.h"
+#include "event_loop.h"
+#include "zap_machine.h"
 #include "remote.h"
 #include "config_parser.h"
 #include "device_control.h"
@@ -36,29 +48,88 @@
 
 static pthread_cond_t statusCondition = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t statusMutex = PTHREAD_MUTEX_INITIALIZER;
+/* the tuner may lock before deviceInit starts waiting */
+static uint8_t tunerLocked = 0;
 
 static pthread_cond_t patCondition = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t patMutex = PTHREAD_MUTEX_INITIALIZER;
+/* the callback stays registered, so the PAT may arrive before initPatParsing waits for it */
+static uint8_t patReady = 0;
 
-static pthread_cond_t pmtCondition = PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t pmtMutex = PTHREAD_MUTEX_INITIALIZER;
+/* all PMT filters of the PAT are armed together, sections are routed by program_number */
+static PmtAcquisition pmtAcquisition;
+
+/* the demux has a single section callback, consumers subscribe here by PID */
+static PidRouter pidRouter;
 
-static pthread_cond_t eitCondition = PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t eitMutex = PTHREAD_MUTEX_INITIALIZER;
 static uint8_t parsedTag = 0;
+/* repeated PAT/PMT/EIT sections are dropped here before parsing */
+static PsiCache psiCache;
 
 PatTable* patTable;
 PmtTable** pmtTable;
 DeviceHandle *globHandle;
-EitTable* eitTable = NULL;
-int32_t indicator = 0;
+
+/* SI tables collected in the background for the whole multiplex */
+typedef struct _SiFilter
+{
+    uint16_t pid;
+    uint8_t tableId;
+    uint8_t running;
+    uint32_t filterHandle;
+} SiFilter;
+
+static SiFilter siFilters[] = {
+    {0x10, NIT_ACTUAL_TABLE_ID, 0, 0},
+    {0x11, SDT_ACTUAL_TABLE_ID, 0, 0},
+    {0x12, EIT_PF_ACTUAL_TABLE_ID, 0, 0},
+    // schedule for the first four days of the actual TS
+    {0x12, EIT_SCHEDULE_FIRST_TABLE_ID, 0, 0}
+};
+static uint8_t siRunning = 0;
 int32_t currentStream = 0;
 
+/* first supported video and audio stream of a service */
+typedef struct _ServiceStreams
+{
+    uint16_t vpid;
+    uint8_t vtype;
+    uint16_t apid;
+    uint8_t atype;
+} ServiceStreams;
+
 uint16_t vpid = 0;
 uint8_t vtype = 0;
 uint8_t atype = 0;
 uint16_t apid = 0;
 uint32_t currentServiceNumber = 1;
+/* frequency of the multiplex stored in the channel database */
+static uint32_t channelDbFrequency = 0;
+
+/* PAT, PMT and SI are acquired by psiThread after deviceInit returns */
+/* pause between two failed PAT acquisitions */
+#define PSI_RETRY_DELAY_MS 500
+/* time the PMT filters get before the missing services are re-armed */
+#define PMT_ROUND_SECONDS 10
+static pthread_t psiThread;
+static uint8_t psiThreadStarted = 0;
+static pthread_mutex_t psiMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t psiStop = 0;
+static uint8_t pmtActive = 0;
+/* patTable and pmtTable are allocated and may be read by the remote callbacks */
+static uint8_t patPublished = 0;
+/* a service can be zapped to as soon as its own PMT is parsed */
+static uint8_t serviceReady[MAX_NUM_OF_PIDS];
+/* service started from the channel database, 0 once the user has zapped (event loop thread only) */
+static uint16_t bootProgram = 0;
+/* zaps within this window of each other only move the banner, the last one is tuned */
+static uint32_t zapSettleMs = ZAP_SETTLE_DEFAULT_MS;
+static EventLoopTimer zapSettleTimer = EVENT_LOOP_TIMER_INITIALIZER;
+/* service shown in the banner but not tuned yet, 0 if none (event loop thread only) */
+static uint32_t pendingServiceNumber = 0;
+/* the streams are switched on the zap thread, the event loop thread only requests it */
+static ZapMachine zapMachine;
+static uint8_t zapMachineStarted = 0;
 
 /****************************************************************************
  *
@@ -71,54 +142,76 @@ uint32_t currentServiceNumber = 1;
  *****************************************************************************/
 int32_t tunerStatusCallback(t_LockStatus status);
 
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja je registrovana kao jedina callback funkcija demultipleksera.
+ * Odredjuje PID sekcije i prosljedjuje je svim pretplatnicima tog PID-a.
+ *
+ * @param buffer - [in] buffer koji se prima sa streama i u kome se nalazi sekcija
+ * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
+ *****************************************************************************/
+int32_t demux_Section_Filter_Callback(uint8_t *buffer);
+
 /****************************************************************************
  *
  * @brief
  * Funkcija koja ce biti pozvana prilikom dohvatanja PAT sekcije.
  *
+ * @param pid - [in] PID sekcije
  * @param buffer - [in] buffer koji se prima sa streama i u kome se nalazi PAT sekcija
+ * @param length - [in] broj bajtova koji se smiju procitati iz buffer-a
+ * @param context - [in] nije u upotrebi
  * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
  *****************************************************************************/
-int32_t pat_Demux_Section_Filter_Callback(uint8_t *buffer);
+int32_t patSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context);
 
 /****************************************************************************
  *
  * @brief
  * Funkcija koja ce biti pozvana prilikom dohvatanja PMT sekcije.
  *
+ * @param pid - [in] PID sekcije
  * @param buffer - [in] buffer koji se prima sa streama i u kome se nalazi PMT sekcija
+ * @param length - [in] broj bajtova koji se smiju procitati iz buffer-a
+ * @param context - [in] nije u upotrebi
  * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
  *****************************************************************************/
-int32_t pmt_Demux_Section_Filter_Callback(uint8_t *buffer);
+int32_t pmtSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context);
 
 /****************************************************************************
  *
- * @brief  Funkcija koja ce inicijalizovati parsiranje PMT tabele
+ * @brief  Funkcija koja ce istovremeno dohvatiti PMT tabele svih programa
+ * iz PAT tabele. Dohvatanje ostaje pokrenuto i kada ne stignu sve tabele;
+ * zavrsava ga finishPmtParsing.
  *
  * @param handle - [out] vrijednsot handle strukture
- * @param pid - [in] pid tabele koja se zeli parsirati 
- * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
+ * @return NO_ERROR, ako su stigle sve PMT tabele, ERROR, u suprotnom
  *****************************************************************************/
-int32_t initPmtParsing(DeviceHandle* handle, uint16_t pid);
+int32_t initPmtParsing(DeviceHandle* handle);
 
 /****************************************************************************
  *
  * @brief
- * Funkcija koja ce biti pozvana prilikom dohvatanja EIT sekcije.
+ * Funkcija koja ce biti pozvana prilikom dohvatanja NIT, SDT ili EIT sekcije.
  *
- * @param buffer - [in] buffer koji se prima sa streama i u kome se nalazi EIT sekcija
+ * @param pid - [in] PID sekcije
+ * @param buffer - [in] buffer koji se prima sa streama i u kome se nalazi NIT, SDT ili EIT sekcija
+ * @param length - [in] broj bajtova koji se smiju procitati iz buffer-a
+ * @param context - [in] nije u upotrebi
  * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
  *****************************************************************************/
-int32_t eit_Demux_Section_Filter_Callback(uint8_t *buffer);
+int32_t siSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context);
 
 /****************************************************************************
  *
- * @brief  Funkcija koja ce inicijalizovati parsiranje EIT tabele
+ * @brief  Funkcija koja ce inicijalizovati parsiranje NIT, SDT i EIT tabela u
+ * pozadini
  *
  * @param handle - [out] vrijednsot handle strukture 
  * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
  *****************************************************************************/
-int32_t initEitParsing(DeviceHandle* handle);
+int32_t initSiParsing(DeviceHandle* handle);
 
 /****************************************************************************
  *
@@ -134,6 +227,7 @@ int32_t tunerStatusCallback(t_LockStatus status)
     if (status == STATUS_LOCKED)
     {
         pthread_mutex_lock(&statusMutex);
+        tunerLocked = 1;
         pthread_cond_signal(&statusCondition);
         pthread_mutex_unlock(&statusMutex);
         // printf("\n%s -----TUNER LOCKED-----\n", __FUNCTION__);
@@ -145,191 +239,582 @@ int32_t tunerStatusCallback(t_LockStatus status)
     return NO_ERROR;
 }
 
-int32_t pat_Demux_Section_Filter_Callback(uint8_t *buffer)
+int32_t demux_Section_Filter_Callback(uint8_t *buffer)
 {
+    uint16_t pid = TS_NULL_PID;
+    uint32_t length = SECTION_MAX_SIZE;
+    uint16_t program_number;
+    uint32_t i;
+    // the callback does not get the PID: PAT, NIT, SDT and EIT have fixed ones,
+    // a PMT is found through its program_number in the PAT
+    if (buffer[0] == PAT_TABLE_ID)
+    {
+        pid = 0x00;
+        length = PSI_SECTION_MAX_SIZE;
+    }
+    else if (buffer[0] == PMT_TABLE_ID && patTable != NULL)
+    {
+        program_number = (uint16_t) ((buffer[3] << 8) + buffer[4]);
+        for (i = 0; i < patTable->serviceInfoCount; i++)
+        {
+            if (patTable->patServiceInfoArray[i].program_number == program_number)
+            {
+                pid = patTable->patServiceInfoArray[i].pid;
+                break;
+            }
+        }
+        length = PSI_SECTION_MAX_SIZE;
+    }
+    else if (buffer[0] == NIT_ACTUAL_TABLE_ID)
+    {
+        pid = 0x10;
+    }
+    else if (buffer[0] == SDT_ACTUAL_TABLE_ID)
+    {
+        pid = 0x11;
+    }
+    else if (buffer[0] >= EIT_PF_ACTUAL_TABLE_ID && buffer[0] <= EIT_SCHEDULE_LAST_TABLE_ID)
+    {
+        pid = 0x12;
+    }
+    pidRouterDispatch(&pidRouter, pid, buffer, length);
+    return NO_ERROR;
+}
 
+int32_t patSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context)
+{
+    SectionView view;
     //   printf("%s running\n", __FUNCTION__);
-    parsePatTable(buffer, patTable);
+    if (psiCacheCheck(&psiCache, pid, buffer, length) >= PSI_CACHE_UNCHANGED)
+    {
+        return NO_ERROR;
+    }
+    // corrupted or truncated sections are dropped, the next repetition will be used
+    if (sectionViewInit(&view, buffer, length) != SECTION_OK || view.table_id != PAT_TABLE_ID)
+    {
+        return NO_ERROR;
+    }
+    psiCacheUpdate(&psiCache, pid, &view);
     //    printf("%s patTable parsed\n", __FUNCTION__);
-    if (patTable->patHeader->table_id == 0x00)
+    if (parsePatSection(&view, patTable) == 0)
     {
         pthread_mutex_lock(&patMutex);
+        patReady = 1;
         pthread_cond_signal(&patCondition);
         pthread_mutex_unlock(&patMutex);
     }
     return NO_ERROR;
 }
 
-int32_t pmt_Demux_Section_Filter_Callback(uint8_t *buffer)
+int32_t pmtSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context)
 {
-    parsePmt(buffer, pmtTable[indicator]);
-    if (pmtTable[indicator]->pmtHeader->table_id == 0x02)
+    SectionView view;
+    int32_t index;
+    if (psiCacheCheck(&psiCache, pid, buffer, length) >= PSI_CACHE_UNCHANGED)
     {
-        pthread_mutex_lock(&pmtMutex);
-        pthread_cond_signal(&pmtCondition);
-        pthread_mutex_unlock(&pmtMutex);
+        return NO_ERROR;
+    }
+    if (sectionViewInit(&view, buffer, length) != SECTION_OK)
+    {
+        return NO_ERROR;
+    }
+    // repetitions of PMTs that are already parsed are dropped here
+    index = pmtAcquisitionOnSection(&pmtAcquisition, &view);
+    if (index >= 0)
+    {
+        psiCacheUpdate(&psiCache, pid, &view);
+        pthread_mutex_lock(&psiMutex);
+        if (index < MAX_NUM_OF_PIDS)
+            serviceReady[index] = 1;
+        pthread_mutex_unlock(&psiMutex);
     }
     return NO_ERROR;
 }
 
-int32_t initPmtParsing(DeviceHandle* handle, uint16_t pid)
+/****************************************************************************
+ *
+ * @brief  Funkcija koja provjerava da li je PMT tabela programa primljena
+ *
+ * @param service_number - [in] redni broj programa
+ * @return 1 ako se na program moze preci, 0 ako ne moze
+ *****************************************************************************/
+static uint8_t isServiceReady(uint32_t service_number)
+{
+    uint8_t ready;
+    pthread_mutex_lock(&psiMutex);
+    ready = (patPublished && service_number > 0 && service_number < patTable->serviceInfoCount &&
+            service_number < MAX_NUM_OF_PIDS && serviceReady[service_number]);
+    pthread_mutex_unlock(&psiMutex);
+    return ready;
+}
+
+/****************************************************************************
+ *
+ * @brief  Funkcije kojima modul za dohvatanje PMT tabela postavlja i
+ * oslobadja filtere demultipleksera
+ *
+ *****************************************************************************/
+static int32_t pmtSetFilter(void* context, uint16_t pid, uint8_t tableId, uint32_t* filterHandle)
 {
-    static struct timespec lockStatusWaitTime;
-    static struct timeval now;
-    //  printf("%s: started\n", __FUNCTION__);
-    if (pmtTable == NULL)
+    DeviceHandle* handle = (DeviceHandle*) context;
+    psiCacheInvalidatePid(&psiCache, pid);
+    return Demux_Set_Filter(handle->playerHandle, pid, tableId, filterHandle);
+}
+
+static void pmtFreeFilter(void* context, uint32_t filterHandle)
+{
+    DeviceHandle* handle = (DeviceHandle*) context;
+    Demux_Free_Filter(handle->playerHandle, filterHandle);
+}
+
+int32_t initPmtParsing(DeviceHandle* handle)
+{
+    PmtAcquisitionOps ops;
+    uint32_t i;
+    ops.setFilter = pmtSetFilter;
+    ops.freeFilter = pmtFreeFilter;
+    ops.context = handle;
+    for (i = 0; i < patTable->serviceInfoCount; i++)
     {
-        pmtTable = (PmtTable**) malloc(patTable->serviceInfoCount * sizeof (PmtTable*));
-        //   printf("%s : pmt allocated\n", __FUNCTION__);
+        if (patTable->patServiceInfoArray[i].program_number != 0 &&
+                pidRouterSubscribe(&pidRouter, patTable->patServiceInfoArray[i].pid, pmtSectionHandler, NULL))
+        {
+            printf("\n%s:ERROR PID router is full!\n", __FUNCTION__);
+        }
     }
-    if (pmtTable == NULL)
-        return ERROR;
-    // printf("PID: %d\n", patTable->patServiceInfoArray[1].pid);
-    if (pmtTable[indicator] == NULL)
+    // without a free filter now, finishPmtParsing arms the services later
+    pmtAcquisitionStart(&pmtAcquisition, &ops, patTable, pmtTable, PMT_ACQUISITION_MAX_FILTERS);
+    // deviceDeInit cancels the wait only while the acquisition is active
+    pthread_mutex_lock(&psiMutex);
+    pmtActive = !psiStop;
+    pthread_mutex_unlock(&psiMutex);
+    // one deadline for the whole multiplex instead of 10 s per service
+    if (!pmtActive || pmtAcquisitionWait(&pmtAcquisition, PMT_ROUND_SECONDS) != 0)
     {
-        printf("%s : ERROR pmtTable[%d] is null", __FUNCTION__, indicator);
         return ERROR;
     }
-    gettimeofday(&now, NULL);
-    lockStatusWaitTime.tv_sec = now.tv_sec + 10;
-    if (Demux_Set_Filter(handle->playerHandle, pid, 0x02, &(handle->filterHandle)))
+    return NO_ERROR;
+}
+
+/****************************************************************************
+ *
+ * @brief  Funkcija koja ponovo postavlja filtere za programe cije PMT tabele
+ * nisu stigle, sve dok ne stignu ili dok deviceDeInit ne zaustavi nit, a
+ * zatim zavrsava dohvatanje PMT tabela.
+ *
+ * @param handle - [in] vrijednost handle strukture
+ *****************************************************************************/
+static void finishPmtParsing(DeviceHandle* handle)
+{
+    uint32_t missing;
+    uint32_t i;
+    while (!psiStop)
     {
-        printf("\n%s:ERROR Set filter failure!\n", __FUNCTION__);
-        return ERROR;
+        missing = pmtAcquisitionRetry(&pmtAcquisition);
+        if (missing == 0 || pmtAcquisitionWait(&pmtAcquisition, PMT_ROUND_SECONDS) == 0)
+            break;
     }
-    // printf("%s : pmt set filter\n", __FUNCTION__);
+    pthread_mutex_lock(&psiMutex);
+    pmtActive = 0;
+    pthread_mutex_unlock(&psiMutex);
+    // unsubscribing waits for a section already being handled, so nothing
+    // can reach pmtAcquisitionOnSection once the acquisition is stopped
+    for (i = 0; i < patTable->serviceInfoCount; i++)
+    {
+        if (patTable->patServiceInfoArray[i].program_number != 0)
+            pidRouterUnsubscribe(&pidRouter, patTable->patServiceInfoArray[i].pid, pmtSectionHandler, NULL);
+    }
+    pmtAcquisitionStop(&pmtAcquisition);
+}
 
-    if (Demux_Register_Section_Filter_Callback(pmt_Demux_Section_Filter_Callback))
+int32_t siSectionHandler(uint16_t pid, const uint8_t* buffer, uint32_t length, void* context)
+{
+    SectionView view;
+    EitTable eitTable;
+    SdtTable sdtTable;
+    NitTable nitTable;
+    if (psiCacheCheck(&psiCache, pid, buffer, length) >= PSI_CACHE_UNCHANGED)
     {
-        printf("\n%s:ERROR Register Section filter failure!\n", __FUNCTION__);
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-        return ERROR;
+        return NO_ERROR;
+    }
+    if (sectionViewInit(&view, buffer, length) != SECTION_OK)
+    {
+        return NO_ERROR;
     }
-    //  printf("%s : pmt register section filter\n", __FUNCTION__);
+    psiCacheUpdate(&psiCache, pid, &view);
+    if (view.table_id == NIT_ACTUAL_TABLE_ID)
+    {
+        if (parseNitSection(&view, &nitTable) == 0)
+            networkMapUpdate(&nitTable);
+    }
+    else if (view.table_id == SDT_ACTUAL_TABLE_ID)
+    {
+        if (parseSdtSection(&view, &sdtTable) == 0)
+            serviceCacheUpdate(&sdtTable);
+    }
+    else if (view.table_id >= EIT_SCHEDULE_FIRST_TABLE_ID)
+    {
+        epgIndexAddSection(&view);
+    }
+    else if (parseEitSection(&view, &eitTable) == 0)
+    {
+        nowNextUpdate(&eitTable);
+    }
+    return NO_ERROR;
+}
 
-    pthread_mutex_lock(&pmtMutex);
-    if (ETIMEDOUT == pthread_cond_timedwait(&pmtCondition, &pmtMutex, &lockStatusWaitTime))
+int32_t initSiParsing(DeviceHandle* handle)
+{
+    uint32_t i;
+    // SI filters stay open, the caches are filled in the background
+    if (siRunning)
+        return NO_ERROR;
+    for (i = 0; i < sizeof (siFilters) / sizeof (siFilters[0]); i++)
     {
-        printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-        return ERROR;
+        psiCacheInvalidatePid(&psiCache, siFilters[i].pid);
+        if (pidRouterSubscribe(&pidRouter, siFilters[i].pid, siSectionHandler, NULL))
+        {
+            printf("\n%s:ERROR PID router is full!\n", __FUNCTION__);
+            continue;
+        }
+        // a table without a free filter slot is skipped, the others keep working
+        if (Demux_Set_Filter(handle->playerHandle, siFilters[i].pid, siFilters[i].tableId, &(siFilters[i].filterHandle)))
+        {
+            printf("\n%s:ERROR Set filter failure for table %x!\n", __FUNCTION__, siFilters[i].tableId);
+            continue;
+        }
+        siFilters[i].running = 1;
     }
-    pthread_mutex_unlock(&pmtMutex);
-    // printf("%s : pmt parsed\n", __FUNCTION__);
-    //  dumpPmtTable(pmtTable[indicator]);
-    Demux_Unregister_Section_Filter_Callback(pmt_Demux_Section_Filter_Callback);
-    // printf("%s : pmt section filter unregistered\n", __FUNCTION__);
-    Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-    // printf("%s : filter free\n", __FUNCTION__);
-    // printf("%s ended", __FUNCTION__);
+    siRunning = 1;
     return NO_ERROR;
 }
 
-int32_t eit_Demux_Section_Filter_Callback(uint8_t *buffer)
+/****************************************************************************
+ *
+ * @brief  Funkcija koja zaustavlja prikupljanje NIT, SDT i EIT tabela u pozadini
+ *
+ * @param handle - [in] vrijednost handle strukture
+ *****************************************************************************/
+static void stopSiParsing(DeviceHandle* handle)
 {
-    parseEitTable(buffer, eitTable);
-    pthread_mutex_lock(&eitMutex);
-    pthread_cond_signal(&eitCondition);
-    pthread_mutex_unlock(&eitMutex);
+    uint32_t i;
+    if (!siRunning)
+        return;
+    for (i = 0; i < sizeof (siFilters) / sizeof (siFilters[0]); i++)
+    {
+        if (siFilters[i].running)
+            Demux_Free_Filter(handle->playerHandle, siFilters[i].filterHandle);
+        siFilters[i].running = 0;
+        pidRouterUnsubscribe(&pidRouter, siFilters[i].pid, siSectionHandler, NULL);
+    }
+    siRunning = 0;
 }
 
-int32_t initEitParsing(DeviceHandle* handle)
+/****************************************************************************
+ *
+ * @brief  Funkcija koja od streamova programa bira prvi podrzani video i
+ * audio stream
+ *
+ * @param streams - [in/out] izabrani streamovi
+ * @param type - [in] stream_type iz PMT tabele
+ * @param codec - [in] StreamCodec iz deskriptora
+ * @param pid - [in] elementary PID
+ *****************************************************************************/
+static void selectStream(ServiceStreams* streams, uint8_t type, uint8_t codec, uint16_t pid)
 {
-    static struct timespec lockStatusWaitTime;
-    static struct timeval now;
-    if (eitTable == NULL)
-        free(eitTable);
-    eitTable = (EitTable*) malloc(sizeof (EitTable));
-    gettimeofday(&now, NULL);
-    lockStatusWaitTime.tv_sec = now.tv_sec + 10;
-    if (Demux_Set_Filter(handle->playerHandle, 0x12, 0x4E, &(handle->filterHandle)))
+    if (type == 0x01 || type == 0x02)
     {
-        printf("\n%s:ERROR Set filter failure!\n", __FUNCTION__);
-        return ERROR;
+        streams->vpid = pid;
+        streams->vtype = (type == 0x02) ? VIDEO_TYPE_MPEG2 : VIDEO_TYPE_MPEG1;
+    }
+    if (type == 0x03 || type == 0x04)
+    {
+        streams->apid = pid;
+        streams->atype = (type == 0x03) ? AUDIO_TYPE_DOLBY_AC3 : AUDIO_TYPE_MP3;
+    }
+    // AC-3 carried as private PES is only recognized by its descriptor
+    if (type == 0x06 && streams->apid == 0 && codec == STREAM_CODEC_AC3)
+    {
+        streams->apid = pid;
+        streams->atype = AUDIO_TYPE_DOLBY_AC3;
     }
-    //printf("%s : eit set filter\n", __FUNCTION__);
+}
 
-    if (Demux_Register_Section_Filter_Callback(eit_Demux_Section_Filter_Callback))
+/****************************************************************************
+ *
+ * @brief  Funkcija koja bira streamove programa iz njegove PMT tabele
+ *
+ * @param service_number - [in] redni broj programa
+ * @param streams - [out] izabrani streamovi, 0 ako ih nema
+ *****************************************************************************/
+static void serviceStreams(uint32_t service_number, ServiceStreams* streams)
+{
+    uint8_t i;
+    memset(streams, 0, sizeof (ServiceStreams));
+    for (i = 0; i < pmtTable[service_number]->streamCount; i++)
     {
-        printf("\n%s:ERROR Register Section filter failure!\n", __FUNCTION__);
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-        return ERROR;
+        selectStream(streams, pmtTable[service_number]->pmtServiceInfoArray[i].stream_type,
+                     pmtTable[service_number]->pmtServiceInfoArray[i].codec,
+                     pmtTable[service_number]->pmtServiceInfoArray[i].el_pid);
     }
-    // printf("%s : eit register section filter\n", __FUNCTION__);
+}
 
-    pthread_mutex_lock(&eitMutex);
-    if (ETIMEDOUT == pthread_cond_timedwait(&eitCondition, &eitMutex, &lockStatusWaitTime))
+/****************************************************************************
+ *
+ * @brief  Funkcija koja iscrtava informacije o servisu, zajedno sa nazivom
+ * servisa iz SDT i nazivom trenutnog dogadjaja iz EIT tabele, ako su poznati
+ *
+ * @param service_number - [in] redni broj programa
+ *****************************************************************************/
+static void drawServiceInfo(uint32_t service_number)
+{
+    NowNextEvent present;
+    ServiceInfo service;
+    ServiceStreams streams;
+    const char* title = NULL;
+    const char* name = NULL;
+    uint16_t program_number = pmtTable[service_number]->pmtHeader->program_number;
+    if (nowNextGet(program_number, &present, NULL) == 0 && present.valid)
     {
-        printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
+        title = present.name;
+    }
+    if (serviceCacheGet(program_number, &service) == 0)
+    {
+        name = service.name;
+    }
+    // the service may only be shown in the banner while another one is still playing
+    serviceStreams(service_number, &streams);
+    drawTextInfo(service_number, name, streams.vpid, streams.apid, pmtTable[service_number]->teletekst, title);
+}
+
+/****************************************************************************
+ *
+ * @brief  Funkcije kojima masina stanja za promjenu programa uklanja i
+ * kreira streamove plejera
+ *
+ *****************************************************************************/
+static int32_t zapRemoveStream(void* context, ZapStream stream)
+{
+    DeviceHandle* handle = (DeviceHandle*) context;
+    uint32_t* streamHandle = (stream == ZAP_STREAM_VIDEO) ? &(handle->vStreamHandle) : &(handle->aStreamHandle);
+    if (Player_Stream_Remove(handle->playerHandle, handle->sourceHandle, *streamHandle))
+        return ERROR;
+    // 0 marks a stream that does not exist, deviceDeInit skips it
+    *streamHandle = 0;
+    return NO_ERROR;
+}
+
+static int32_t zapCreateStream(void* context, ZapStream stream, uint16_t pid, uint8_t type)
+{
+    DeviceHandle* handle = (DeviceHandle*) context;
+    uint32_t* streamHandle = (stream == ZAP_STREAM_VIDEO) ? &(handle->vStreamHandle) : &(handle->aStreamHandle);
+    if (Player_Stream_Create(handle->playerHandle, handle->sourceHandle, pid, type, streamHandle))
+    {
+        *streamHandle = 0;
         return ERROR;
     }
-    pthread_mutex_unlock(&eitMutex);
-    // printf("%s : eit parsed\n", __FUNCTION__);
-    Demux_Unregister_Section_Filter_Callback(eit_Demux_Section_Filter_Callback);
-    //printf("%s : eit section filter unregistered\n", __FUNCTION__);
-    Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-    // printf("%s : filter free\n", __FUNCTION__);
-    // printf("%s ended", __FUNCTION__);
     return NO_ERROR;
 }
 
-int32_t initPatParsing(DeviceHandle *handle)
+/****************************************************************************
+ *
+ * @brief  Funkcija koja bira program i trazi od niti za promjenu programa da
+ * kreira njegove streamove. Vraca se odmah, bez cekanja plejera.
+ *
+ * @param service_number - [in] redni broj programa (PMT je primljen)
+ *****************************************************************************/
+static void requestService(uint32_t service_number)
 {
-    static struct timespec lockStatusWaitTime;
-    static struct timeval now;
-    // printf("%s: started\n", __FUNCTION__);
-    //free memory if patTable is allocated
-    if (patTable != NULL)
+    ServiceStreams streams;
+    ZapTarget target;
+    serviceStreams(service_number, &streams);
+    vpid = streams.vpid;
+    vtype = streams.vtype;
+    apid = streams.apid;
+    atype = streams.atype;
+    currentServiceNumber = service_number;
+    target.service_number = service_number;
+    target.pid[ZAP_STREAM_VIDEO] = vpid;
+    target.type[ZAP_STREAM_VIDEO] = vtype;
+    target.pid[ZAP_STREAM_AUDIO] = apid;
+    target.type[ZAP_STREAM_AUDIO] = atype;
+    if (vpid == 0)
     {
-        if (patTable->patHeader != NULL)
-            free(patTable->patHeader);
-        free(patTable);
+        printf("This service doesent contain video\n");
     }
-    // allocate memory for PAT
-    patTable = (PatTable*) malloc(sizeof (PatTable));
-    patTable->patHeader = (PatHeader*) malloc(sizeof (PatHeader));
-    // printf("%s: PAT allocated\n", __FUNCTION__);
+    zapMachineRequest(&zapMachine, &target);
+}
+
+/****************************************************************************
+ *
+ * @brief  Funkcija koja nakon prijema PMT tabela provjerava program koji je
+ * pokrenut iz baze programa i ponovo kreira streamove ciji su se PID-ovi
+ * promijenili
+ *
+ * @param program_number - [in] program_number pokrenutog programa
+ *****************************************************************************/
+static void revalidateService(uint16_t program_number)
+{
+    ServiceStreams streams;
+    uint32_t i;
+    // the service may have moved in the PAT, it is found by program_number
+    for (i = 1; i < patTable->serviceInfoCount; i++)
+    {
+        if (patTable->patServiceInfoArray[i].program_number == program_number)
+            break;
+    }
+    currentServiceNumber = (i < patTable->serviceInfoCount) ? i : 1;
+    // without its PMT the cached PIDs are the best guess
+    if (!isServiceReady(currentServiceNumber))
+        return;
+    serviceStreams(currentServiceNumber, &streams);
+    if (streams.vpid != vpid)
+    {
+        printf("%s: video PID changed %u -> %u\n", __FUNCTION__, vpid, streams.vpid);
+    }
+    if (streams.apid != apid)
+    {
+        printf("%s: audio PID changed %u -> %u\n", __FUNCTION__, apid, streams.apid);
+    }
+    // streams whose PID did not change are left alone by the zap thread
+    requestService(currentServiceNumber);
+}
+
+int32_t initPatParsing(DeviceHandle *handle)
+{
+    uint64_t deadline;
+    // printf("%s: started\n", __FUNCTION__);
     // set Demux filter for pat table
     // PAT pid=0x00,table_id=0
+    psiCacheInvalidatePid(&psiCache, 0x00);
+    patReady = 0;
+    if (pidRouterSubscribe(&pidRouter, 0x00, patSectionHandler, NULL))
+    {
+        return ERROR;
+    }
     if (Demux_Set_Filter(handle->playerHandle, 0x00, 0, &(handle->filterHandle)) == ERROR)
     {
         printf("%s: Demux_Set_Filter failed\n", __FUNCTION__);
+        pidRouterUnsubscribe(&pidRouter, 0x00, patSectionHandler, NULL);
         return ERROR;
     }
 
     //printf("%s: Demux_Set_Filter\n", __FUNCTION__);
-    gettimeofday(&now, NULL);
-    lockStatusWaitTime.tv_sec = now.tv_sec + 10;
-    if (Demux_Register_Section_Filter_Callback(pat_Demux_Section_Filter_Callback))
-    {
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-        return ERROR;
-    }
-    // printf("%s: registered callback\n", __FUNCTION__);
+    deadline = clockNow() + 10 * CLOCK_NS_PER_SEC;
     pthread_mutex_lock(&patMutex);
     //timed waiting for while patTable is parsing
-    if (ETIMEDOUT == pthread_cond_timedwait(&patCondition, &patMutex, &lockStatusWaitTime))
+    while (!patReady)
     {
-        printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
-        Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
-        return ERROR;
+        if (psiStop || ETIMEDOUT == clockWait(&patCondition, &patMutex, deadline))
+        {
+            if (!psiStop)
+                printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
+            pthread_mutex_unlock(&patMutex);
+            pidRouterUnsubscribe(&pidRouter, 0x00, patSectionHandler, NULL);
+            Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
+            return ERROR;
+        }
     }
     pthread_mutex_unlock(&patMutex);
     //printf("%s: pat parsed\n", __FUNCTION__);
-    Demux_Unregister_Section_Filter_Callback(pat_Demux_Section_Filter_Callback);
-    // printf("%s: unregistered callback\n", __FUNCTION__);
+    pidRouterUnsubscribe(&pidRouter, 0x00, patSectionHandler, NULL);
     Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
     // printf("%s: Demux_Free_Filter\n", __FUNCTION__);
     //  dumpPatTable(patTable);
     return NO_ERROR;
 }
 
+/* runs on the event loop thread, posted by psiAcquisitionThread */
+static void revalidateBootService(void* arg)
+{
+    if (bootProgram != 0)
+    {
+        revalidateService(bootProgram);
+        bootProgram = 0;
+        channelDbSetLastService(currentServiceNumber);
+    }
+}
+
+/****************************************************************************
+ *
+ * @brief  Nit koja nakon zakljucavanja tjunera dohvata PAT, PMT i SI tabele.
+ * Programi postaju dostupni pojedinacno, kako stizu njihove PMT tabele.
+ *
+ * @param arg - [in] vrijednost handle strukture
+ *****************************************************************************/
+static void* psiAcquisitionThread(void* arg)
+{
+    DeviceHandle* handle = (DeviceHandle*) arg;
+    uint64_t deadline;
+    uint32_t i;
+    //free memory if patTable is allocated
+    if (patTable != NULL)
+    {
+        if (patTable->patHeader != NULL)
+            free(patTable->patHeader);
+        free(patTable);
+    }
+    // allocate memory for PAT, once for all retries
+    patTable = (PatTable*) malloc(sizeof (PatTable));
+    patTable->patHeader = (PatHeader*) malloc(sizeof (PatHeader));
+    // the PAT is retried until it arrives, the cached service keeps playing meanwhile
+    while (initPatParsing(handle) != NO_ERROR)
+    {
+        // a filter that cannot be set fails at once, so retries are spaced out;
+        // deviceDeInit sets psiStop before it broadcasts patCondition under patMutex
+        deadline = clockNow() + PSI_RETRY_DELAY_MS * CLOCK_NS_PER_MS;
+        pthread_mutex_lock(&patMutex);
+        while (!psiStop && ETIMEDOUT != clockWait(&patCondition, &patMutex, deadline));
+        pthread_mutex_unlock(&patMutex);
+        if (psiStop)
+            return NULL;
+    }
+    pmtTable = (PmtTable**) malloc(patTable->serviceInfoCount * sizeof (PmtTable*));
+    for (i = 0; i < patTable->serviceInfoCount; i++)
+    {
+        pmtTable[i] = (PmtTable*) malloc(sizeof (PmtTable));
+        pmtTable[i]->pmtHeader = (PmtHeader*) malloc(sizeof (PmtHeader));
+        pmtTable[i]->streamCount = 0;
+        pmtTable[i]->teletekst = 0;
+    }
+    pthread_mutex_lock(&psiMutex);
+    memset(serviceReady, 0, sizeof (serviceReady));
+    patPublished = 1;
+    pthread_mutex_unlock(&psiMutex);
+    if (initPmtParsing(handle) != NO_ERROR)
+    {
+        printf("%s: not all PMT tables received, the rest are retried in the background\n", __FUNCTION__);
+    }
+    if (psiStop)
+    {
+        finishPmtParsing(handle);
+        return NULL;
+    }
+    // the streams are recreated on the event loop thread, where the zaps run
+    eventLoopPost(revalidateBootService, NULL);
+    initSiParsing(handle);
+    parsedTag = 1;
+    // services whose PMT is still missing become ready as soon as it arrives
+    finishPmtParsing(handle);
+    // pmtTable is written by the acquisition, which is stopped now
+    if (!psiStop && channelDbSave(CHANNEL_DB_PATH, channelDbFrequency, patTable, pmtTable, currentServiceNumber) > 0)
+    {
+        printf("%s: channel database updated\n", __FUNCTION__);
+    }
+    return NULL;
+}
+
 int deviceInit(config_parameters *parms, DeviceHandle *handle)
 {
-    static struct timespec lockStatusWaitTime;
-    static struct timeval now;
+    uint64_t deadline;
     int i;
+    const ChannelDbService* cached = NULL;
+    ServiceStreams streams;
+    ZapMachineOps zapOps;
+    ZapTarget playing;
+    uint16_t cachedProgram = 0;
+    const char* cachedName = NULL;
+    uint8_t cachedTeletekst = 1;
     uint32_t freqHz = parms->frequency*MHZ;
     /*Initialize tuner device*/
     if (Tuner_Init())
@@ -340,8 +825,8 @@ int deviceInit(config_parameters *parms, DeviceHandle *handle)
 
     // printf("%s: after Tuner_Init\n", __FUNCTION__);
     /* Register tuner status callback */
-    gettimeofday(&now, NULL);
-    lockStatusWaitTime.tv_sec = now.tv_sec + 10;
+    deadline = clockNow() + 10 * CLOCK_NS_PER_SEC;
+    tunerLocked = 0;
     if (Tuner_Register_Status_Callback(tunerStatusCallback))
     {
         printf("\n%s : ERROR Tuner_Register_Status_Callback() fail\n", __FUNCTION__);
@@ -360,11 +845,15 @@ int deviceInit(config_parameters *parms, DeviceHandle *handle)
     }
     /* Wait for tuner to lock*/
     pthread_mutex_lock(&statusMutex);
-    if (ETIMEDOUT == pthread_cond_timedwait(&statusCondition, &statusMutex, &lockStatusWaitTime))
+    while (!tunerLocked)
     {
-        printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
-        Tuner_Deinit();
-        return -1;
+        if (ETIMEDOUT == clockWait(&statusCondition, &statusMutex, deadline))
+        {
+            printf("\n%s:ERROR Lock timeout exceeded!\n", __FUNCTION__);
+            pthread_mutex_unlock(&statusMutex);
+            Tuner_Deinit();
+            return -1;
+        }
     }
     pthread_mutex_unlock(&statusMutex);
     //  printf("%s: Tuner locked\n", __FUNCTION__);
@@ -385,7 +874,35 @@ int deviceInit(config_parameters *parms, DeviceHandle *handle)
     }
     //printf("%s: Player_Source_Open\n", __FUNCTION__);
 
-    if (Player_Stream_Create(handle->playerHandle, handle->sourceHandle, parms->vPid, parms->vType, &(handle->vStreamHandle)))
+    vpid = parms->vPid;
+    vtype = parms->vType;
+    apid = parms->aPid;
+    atype = parms->aType;
+    // the last watched service starts from cached PIDs, PAT and PMT are checked afterwards
+    if (channelDbOpen(CHANNEL_DB_PATH) == 0 && channelDbHeader()->frequency == parms->frequency)
+    {
+        cached = channelDbService(channelDbHeader()->lastService);
+    }
+    if (cached != NULL && cached->streamCount > 0)
+    {
+        memset(&streams, 0, sizeof (streams));
+        for (i = 0; i < cached->streamCount; i++)
+        {
+            selectStream(&streams, cached->streams[i].stream_type, cached->streams[i].codec, cached->streams[i].pid);
+        }
+        vpid = streams.vpid;
+        vtype = streams.vtype;
+        apid = streams.apid;
+        atype = streams.atype;
+        currentServiceNumber = channelDbHeader()->lastService;
+        cachedProgram = cached->program_number;
+        cachedName = (cached->name[0] != '\0') ? cached->name : NULL;
+        cachedTeletekst = cached->teletekst;
+        printf("%s: service %u started from the channel database\n", __FUNCTION__, currentServiceNumber);
+    }
+    handle->vStreamHandle = 0;
+    handle->aStreamHandle = 0;
+    if (vpid != 0 && Player_Stream_Create(handle->playerHandle, handle->sourceHandle, vpid, vtype, &(handle->vStreamHandle)))
     {
         printf("%s Player_Source_Open failed", __FUNCTION__);
         Player_Source_Close(handle->playerHandle, handle->sourceHandle);
@@ -393,7 +910,7 @@ int deviceInit(config_parameters *parms, DeviceHandle *handle)
         Tuner_Deinit();
         return ERROR;
     }
-    if (Player_Stream_Create(handle->playerHandle, handle->sourceHandle, parms->aPid, parms->aType, &(handle->aStreamHandle)))
+    if (apid != 0 && Player_Stream_Create(handle->playerHandle, handle->sourceHandle, apid, atype, &(handle->aStreamHandle)))
     {
         printf("%s Player_Source_Open failed", __FUNCTION__);
         Player_Source_Close(handle->playerHandle, handle->sourceHandle);
@@ -407,142 +924,160 @@ int deviceInit(config_parameters *parms, DeviceHandle *handle)
     }
     //   printf("Audio %d %d \n", parms->aPid, parms->aType);
     //  printf("Video %d %d \n", parms->vPid, parms->vType);
-    apid = parms->aPid;
-    vpid = parms->vPid;
     //printf("%s: Player_Stream_Create\n", __FUNCTION__);
-    drawTextInfo(1, vpid, apid, 1);
-    drawTextInfo(1, vpid, apid, 1);
-    if (initPatParsing(handle) != NO_ERROR)
+    drawTextInfo(currentServiceNumber, cachedName, vpid, apid, cachedTeletekst, NULL);
+    drawTextInfo(currentServiceNumber, cachedName, vpid, apid, cachedTeletekst, NULL);
+    // one callback for the whole session, tables are told apart by the PID router
+    pidRouterInit(&pidRouter);
+    if (Demux_Register_Section_Filter_Callback(demux_Section_Filter_Callback))
     {
+        printf("\n%s:ERROR Register Section filter failure!\n", __FUNCTION__);
         return ERROR;
     }
-
-    pmtTable = (PmtTable**) malloc(patTable->serviceInfoCount * sizeof (PmtTable*));
-    for (i = 1; i < patTable->serviceInfoCount; i++)
+    channelDbFrequency = parms->frequency;
+    nowNextReset();
+    epgIndexReset();
+    serviceCacheReset();
+    networkMapReset();
+    globHandle = handle;
+    pthread_mutex_lock(&psiMutex);
+    psiStop = 0;
+    patPublished = 0;
+    pthread_mutex_unlock(&psiMutex);
+    playing.service_number = currentServiceNumber;
+    playing.pid[ZAP_STREAM_VIDEO] = vpid;
+    playing.type[ZAP_STREAM_VIDEO] = vtype;
+    playing.pid[ZAP_STREAM_AUDIO] = apid;
+    playing.type[ZAP_STREAM_AUDIO] = atype;
+    zapOps.removeStream = zapRemoveStream;
+    zapOps.createStream = zapCreateStream;
+    zapOps.context = handle;
+    if (zapMachineInit(&zapMachine, &zapOps, &playing) != 0)
     {
-        indicator = i;
-        pmtTable[i] = (PmtTable*) malloc(sizeof (PmtTable));
-        pmtTable[i]->pmtHeader = (PmtHeader*) malloc(sizeof (PmtHeader));
-        //  printf("pmt table %d\n", i);
-        if (initPmtParsing(handle, patTable->patServiceInfoArray[i].pid) != NO_ERROR)
-        {
-            deviceDeInit(handle);
-            return ERROR;
-        }
+        deviceDeInit(handle);
+        return ERROR;
     }
-    //initEitParsing(handle);
-    globHandle = handle;
-    parsedTag = 1;
+    zapMachineStarted = 1;
+    bootProgram = cachedProgram;
+    zapSettleMs = parms->zapSettleMs;
+    pendingServiceNumber = 0;
+    // the zapper is usable right after the tuner lock, PSI arrives in the background
+    if (pthread_create(&psiThread, NULL, psiAcquisitionThread, handle) != 0)
+    {
+        printf("\n%s:ERROR PSI thread not created!\n", __FUNCTION__);
+        deviceDeInit(handle);
+        return ERROR;
+    }
+    psiThreadStarted = 1;
     return NO_ERROR;
 }
 
 void deviceDeInit(DeviceHandle *handle)
 {
-    int i = 0;
+    // a zap still inside its settle window is dropped
+    eventLoopTimerDelete(&zapSettleTimer);
+    pendingServiceNumber = 0;
+    // the player is used by the zap thread until it stops
+    if (zapMachineStarted)
+    {
+        zapMachineDeinit(&zapMachine);
+        zapMachineStarted = 0;
+        printf("%s: %u zaps retargeted before they finished\n", __FUNCTION__, zapMachine.retargets);
+    }
+    if (psiThreadStarted)
+    {
+        pthread_mutex_lock(&psiMutex);
+        psiStop = 1;
+        if (pmtActive)
+            pmtAcquisitionCancel(&pmtAcquisition);
+        pthread_mutex_unlock(&psiMutex);
+        pthread_mutex_lock(&patMutex);
+        pthread_cond_broadcast(&patCondition);
+        pthread_mutex_unlock(&patMutex);
+        pthread_join(psiThread, NULL);
+        psiThreadStarted = 0;
+    }
+    // service names from the SDT are known only now
+    if (parsedTag)
+    {
+        channelDbSave(CHANNEL_DB_PATH, channelDbFrequency, patTable, pmtTable, currentServiceNumber);
+    }
+    channelDbClose();
     parsedTag = 0;
-    Player_Stream_Remove(handle->playerHandle, handle->sourceHandle, handle->aStreamHandle);
-    Player_Stream_Remove(handle->playerHandle, handle->sourceHandle, handle->vStreamHandle);
+    stopSiParsing(handle);
+    Demux_Unregister_Section_Filter_Callback(demux_Section_Filter_Callback);
+    pidRouterDestroy(&pidRouter);
+    // a service without video or audio leaves its handle at 0
+    if (handle->aStreamHandle != 0)
+        Player_Stream_Remove(handle->playerHandle, handle->sourceHandle, handle->aStreamHandle);
+    if (handle->vStreamHandle != 0)
+        Player_Stream_Remove(handle->playerHandle, handle->sourceHandle, handle->vStreamHandle);
+    handle->aStreamHandle = 0;
+    handle->vStreamHandle = 0;
     //Demux_Free_Filter(handle->playerHandle, handle->filterHandle);
     Player_Source_Close(handle->playerHandle, handle->sourceHandle);
     Player_Deinit(handle->playerHandle);
     Tuner_Deinit();
+    zapStatsReport(stdout);
 }
 
-int32_t remoteServiceCallback(uint32_t service_number)
+/* runs on the event loop thread once no zap arrived for zapSettleMs */
+static void zapSettleExpired(void* arg)
 {
+    uint32_t service_number = pendingServiceNumber;
+    pendingServiceNumber = 0;
+    if (service_number == 0 || service_number == currentServiceNumber)
+        return;
+    // a zap still in progress on the zap thread is retargeted to this one
+    requestService(service_number);
+    // the service started from the channel database is no longer playing
+    bootProgram = 0;
+    channelDbSetLastService(currentServiceNumber);
+}
 
-    int16_t type = 0;
-    int16_t i = 0;
-    uint8_t number;
-    if (service_number == currentServiceNumber)
-    {
-        if (service_number > 0 && service_number < patTable->serviceInfoCount)
-        {
-            drawTextInfo(currentServiceNumber, vpid, apid, pmtTable[currentServiceNumber]->teletekst);
-            printf("\n%s pressed button of current service number %d\n", __FUNCTION__, service_number);
-            return ERROR;
-        }
-        else
-        {
-            return ERROR;
-        }
-    }
-    vpid = 0;
-    vtype = 0;
-    atype = 0;
-    apid = 0;
-    currentServiceNumber = service_number;
-    if (parsedTag == 0)
+/****************************************************************************
+ *
+ * @brief  Funkcija koja prelazi na program. Informacije o programu se
+ * iscrtavaju odmah, a streamovi se mijenjaju tek kada zapSettleMs prodje
+ * bez nove promjene programa, tako da se pri brzom listanju tasterima P+/P-
+ * preskoceni programi nikada ne pokrecu.
+ *
+ * @param service_number - [in] redni broj programa
+ * @return NO_ERROR ako je program izabran, ERROR ako nije
+ *****************************************************************************/
+int32_t remoteServiceCallback(uint32_t service_number)
+{
+    uint64_t dispatched = clockNow();
+    uint64_t keyTime = zapStatsTakeKeyEvent();
+    if (keyTime != 0 && dispatched >= keyTime)
+        zapStatsRecord(ZAP_PHASE_KEY_DISPATCH, dispatched - keyTime);
+    else
+        keyTime = dispatched;
+    if (!isServiceReady(service_number))
     {
-        printf("%s:Pmt sections are not ready yet!!!", __FUNCTION__);
+        printf("%s: Pmt section of service %u is not ready yet!!!\n", __FUNCTION__, service_number);
         return ERROR;
     }
-
-    if (service_number > 0 && service_number < patTable->serviceInfoCount)
+    if (service_number == currentServiceNumber)
     {
-        number = pmtTable[service_number]->streamCount;
-        for (i = 0; i < number; i++)
+        drawServiceInfo(currentServiceNumber);
+        if (pendingServiceNumber == 0)
         {
-            type = pmtTable[service_number]->pmtServiceInfoArray[i].stream_type;
-            //printf("type: %d,", type);
-            if (type == 0x01 || type == 0x02)
-            {
-                vpid = pmtTable[service_number]->pmtServiceInfoArray[i].el_pid;
-                vtype = (type == 0x02) ? VIDEO_TYPE_MPEG2 : VIDEO_TYPE_MPEG1;
-            }
-            if (type == 0x03 || type == 0x04)
-            {
-                apid = pmtTable[service_number]->pmtServiceInfoArray[i].el_pid;
-                atype = (type == 0x03) ? AUDIO_TYPE_DOLBY_AC3 : AUDIO_TYPE_MP3;
-            }
-        }
-
-        if (Player_Stream_Remove(globHandle->playerHandle, globHandle->sourceHandle, globHandle->vStreamHandle))
-        {
-            printf("Stream not removed\n");
-        }
-
-
-        if (vtype != 0 && vpid != 0)
-        {
-            if (Player_Stream_Create(globHandle->playerHandle, globHandle->sourceHandle, vpid, vtype, &(globHandle->vStreamHandle)))
-            {
-                printf("Player stream not created\n");
-            }
-        }
-        else
-        {
-            printf("This service doesent contain video\n");
-        }
-
-        if (Player_Stream_Remove(globHandle->playerHandle, globHandle->sourceHandle, globHandle->aStreamHandle))
-        {
-            printf("Audio tream not removed\n");
-        }
-
-        if (atype != 0 && apid != 0)
-        {
-            //  printf("Astreamhandle: %d\n", globHandle->aStreamHandle);
-            if (Player_Stream_Create(globHandle->playerHandle, globHandle->sourceHandle, apid, atype, &(globHandle->aStreamHandle)))
-            {
-                printf("\n:::::::::::::::--------------------Audio stream not created::::::::::::::::::::::\n");
-            }
-            else
-            {
-                printf("Audio stream created");
-            }
+            printf("\n%s pressed button of current service number %d\n", __FUNCTION__, service_number);
+            return ERROR;
         }
-       // initEitParsing(globHandle);
-        //  printf("%s: %d %s teletekst", __FUNCTION__, currentServiceNumber, (pmtTable[currentServiceNumber]->teletekst) ? "ima" : "nema");
-        drawTextInfo(currentServiceNumber, vpid, apid, pmtTable[currentServiceNumber]->teletekst);
-
-        // printf("\nVideo stream: %d audio stream: %d\n", globHandle->vStreamHandle, globHandle->aStreamHandle);
-    }
-    else
-    {
-        printf("No!\n");
-        return ERROR;
+        // back on the playing service before the window closed, nothing to tune
+        eventLoopTimerStop(&zapSettleTimer);
+        pendingServiceNumber = 0;
+        return NO_ERROR;
     }
+    // the banner is drawn by the render thread, which records the total
+    zapStatsOsdPending(keyTime);
+    drawServiceInfo(service_number);
+    pendingServiceNumber = service_number;
+    // a newer zap replaces the pending one and restarts the window
+    if (zapSettleMs == 0 || eventLoopTimerStart(&zapSettleTimer, zapSettleMs, zapSettleExpired, NULL) != 0)
+        zapSettleExpired(NULL);
     return NO_ERROR;
 }
 
@@ -586,6 +1121,7 @@ int32_t remoteVolumeCallback(uint32_t service)
             swap = 0;
         }
     }
+    return NO_ERROR;
 }
 
 uint8_t getParsedTag()
@@ -593,8 +1129,37 @@ uint8_t getParsedTag()
     return parsedTag;
 }
 
+int32_t remoteServiceSkipCallback(uint32_t service_number)
+{
+    ServiceInfo service;
+    int32_t skip;
+    if (!isServiceReady(service_number))
+    {
+        // services of the PAT whose PMT has not arrived yet are skipped
+        pthread_mutex_lock(&psiMutex);
+        skip = patPublished && service_number > 0 && service_number < patTable->serviceInfoCount;
+        pthread_mutex_unlock(&psiMutex);
+        return skip;
+    }
+    // services not (yet) described by the SDT are never skipped
+    if (serviceCacheGet(patTable->patServiceInfoArray[service_number].program_number, &service) != 0)
+        return 0;
+    return (service.service_type != 0 && !serviceTypeIsTv(service.service_type));
+}
+
 int32_t remoteInfoCallback(uint32_t code)
 {
     //   printf("%s: %d %s teletekst", __FUNCTION__, currentServiceNumber, (pmtTable[currentServiceNumber]->teletekst) ? "ima" : "nema");
-    drawTextInfo(currentServiceNumber, vpid, apid, pmtTable[currentServiceNumber]->teletekst);
+    if (pendingServiceNumber != 0)
+        drawServiceInfo(pendingServiceNumber);
+    else if (isServiceReady(currentServiceNumber))
+        drawServiceInfo(currentServiceNumber);
+    else
+        drawTextInfo(currentServiceNumber, NULL, vpid, apid, 0, NULL);
+    return NO_ERROR;
+}
+
+uint32_t deviceGetServiceNumber(void)
+{
+    return currentServiceNumber;
 }
@@ -57,6 +57,9 @@ void deviceDeInit(DeviceHandle *handle);
  *
  * @brief
  * Funkcija koja ce biti pozvana kao callback funkcija pri promjeni programa.
+ * Informacije o programu se iscrtavaju odmah, a streamovi se mijenjaju kada
+ * istekne vrijeme zapSettle iz konfiguracije bez nove promjene programa.
+ * Streamove mijenja posebna nit, pa funkcija nikada ne ceka plejer.
  *
  * @param service_number - [in] redni broj programa (pocevsi od 1)
  * @return NO_ERROR, ako nema greske, ERROR, u slucaju greske
@@ -73,6 +76,17 @@ int32_t remoteServiceCallback(uint32_t service_number);
  *****************************************************************************/
 int32_t remoteVolumeCallback(uint32_t service);
 
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ce biti pozvana pri promjeni programa tasterima P+/P- da bi
+ * se preskocili radio i data servisi (prema tipu servisa iz SDT tabele).
+ *
+ * @param service_number - [in] redni broj programa (pocevsi od 1)
+ * @return 1, ako program treba preskociti, 0 u suprotnom
+ *****************************************************************************/
+int32_t remoteServiceSkipCallback(uint32_t service_number);
+
 /****************************************************************************
  *
  * @brief
@@ -83,5 +97,15 @@ int32_t remoteVolumeCallback(uint32_t service);
  *****************************************************************************/
 int32_t remoteInfoCallback(uint32_t code);
 
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca redni broj programa koji se reprodukuje (nakon
+ * deviceInit to je posljednji gledani program iz baze programa).
+ *
+ * @return redni broj programa
+ *****************************************************************************/
+uint32_t deviceGetServiceNumber(void);
+
 #endif	/* DEVICE_CONTROL_H */
 
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV zapper
+ * -----------------------------------------------------
+ *
+ * \file dfb_check.h
+ * \brief
+ * Makro za provjeru rezultata directFB poziva. Odvojen je od drawing.h,
+ * tako da moduli koji samo iscrtavaju informacije ne zavise od directFB.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef dfb_check_h
+#define dfb_check_h
+
+#include <stdio.h>
+#include <directfb.h>
+
+/* helper macro for error checking */
+#define DFBCHECK(x...)                                      \
+{                                                           \
+DFBResult err = x;                                          \
+                                                            \
+if (err != DFB_OK)                                          \
+  {                                                         \
+    fprintf( stderr, "%s <%d>:\n\t", __FILE__, __LINE__ );  \
+    DirectFBErrorFatal( #x, err );                          \
+  }                                                         \
+}
+
+#endif
@@ -19,12 +19,21 @@
  *
  *****************************************************************************/
 #include "drawing.h"
+#include "dfb_check.h"
+#include "event_loop.h"
+#include "zap_stats.h"
+#include "font_cache.h"
+#include "osd_compositor.h"
+#include "render_queue.h"
 #include <stdint.h>
 #include <directfb.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
 #include <time.h>
 #include <stdint.h>
 #include <directfb.h>
@@ -35,19 +44,290 @@ static int screenWidth = 0;
 static int screenHeight = 0;
 static DFBSurfaceDescription surfaceDesc;
 static int initialized = 0;
-timer_t timerId;
-struct itimerspec timerSpec;
-struct itimerspec timerSpecOld;
-int32_t timerFlags = 0;
+/* OSD hiding timer, expires on the event loop thread and queues RENDER_HIDE_OSD */
+static EventLoopTimer osdTimer = EVENT_LOOP_TIMER_INITIALIZER;
 
-IDirectFBFont *fontInterface48 = NULL;
-DFBFontDescription fontDesc48;
-IDirectFBFont *fontInterface20 = NULL;
-DFBFontDescription fontDesc20;
+/* font sizes of the info banner, loaded once in initDirectFB */
+static const int32_t osdFontHeights[] = {48, 20};
+#define OSD_TEXT_COLOR 0xFFFFFFFF
+
+/* volume_0.png ... volume_10.png decoded once into one video memory surface */
+#define VOLUME_LEVELS 11
+#define VOLUME_ATLAS_COLUMNS 4
+static IDirectFBSurface *volumeAtlas = NULL;
+static DFBRectangle volumeSprites[VOLUME_LEVELS];
+static int32_t volumeLevel = 0;
+
+/* the render thread owns every DirectFB object, the other threads only queue commands */
+static RenderQueue renderQueue;
+static pthread_t renderThread;
+static sem_t renderStarted;
+static uint8_t renderRunning = 0;
+/* contents of the info banner, redrawn by the compositor whenever its region is dirty */
+static RenderBanner banner;
 uint8_t black = 0;
 
 int16_t settedTimer = 0;
 
+/* everything drawn for a dirty rectangle stays inside it */
+static void setClip(const OsdRect* clip)
+{
+    DFBRegion region;
+    region.x1 = clip->x;
+    region.y1 = clip->y;
+    region.x2 = clip->x + clip->w - 1;
+    region.y2 = clip->y + clip->h - 1;
+    DFBCHECK(primary->SetClip(primary, &region));
+}
+
+static void drawBackdrop(const OsdRect* clip, uint8_t opaque)
+{
+    setClip(clip);
+    if (opaque)
+    {
+        DFBCHECK(primary->SetColor(primary, 0x00, 0x00, 0xff, 0xff));
+    }
+    else
+    {
+        DFBCHECK(primary->SetColor(primary, 0x00, 0x00, 0x00, 0x00));
+    }
+    primary->FillRectangle(primary, clip->x, clip->y, clip->w, clip->h);
+}
+
+/* only the dirty rectangles are copied from the back to the front buffer */
+static void presentRects(const OsdRect* rects, uint32_t count)
+{
+    DFBRegion region;
+    uint32_t i;
+    DFBCHECK(primary->SetClip(primary, NULL));
+    for (i = 0; i < count; i++)
+    {
+        region.x1 = rects[i].x;
+        region.y1 = rects[i].y;
+        region.x2 = rects[i].x + rects[i].w - 1;
+        region.y2 = rects[i].y + rects[i].h - 1;
+        // DSFLIP_BLIT keeps the back buffer equal to the screen, even for a full screen region
+        primary->Flip(primary, &region, DSFLIP_BLIT);
+    }
+}
+
+/****************************************************************************
+ *
+ * @brief Fukcija koja dekodira slike jacine zvuka u jednu povrsinu (atlas),
+ * rasporedjene u redove od VOLUME_ATLAS_COLUMNS slika
+ *
+ *****************************************************************************/
+static void loadVolumeAtlas()
+{
+    IDirectFBImageProvider *provider;
+    DFBSurfaceDescription spriteDesc;
+    DFBSurfaceDescription atlasDesc;
+    char buffer[50];
+    int32_t i;
+    sprintf(buffer, "volume_%d.png", 0);
+    if (dfbInterface->CreateImageProvider(dfbInterface, buffer, &provider) != DFB_OK)
+    {
+        printf("%s: ERROR cannot open %s\n", __FUNCTION__, buffer);
+        return;
+    }
+    // all levels have the size and pixel format of the first image
+    provider->GetSurfaceDescription(provider, &spriteDesc);
+    provider->Release(provider);
+    atlasDesc.flags = DSDESC_CAPS | DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT;
+    atlasDesc.caps = DSCAPS_VIDEOONLY;
+    atlasDesc.width = VOLUME_ATLAS_COLUMNS * spriteDesc.width;
+    atlasDesc.height = ((VOLUME_LEVELS + VOLUME_ATLAS_COLUMNS - 1) / VOLUME_ATLAS_COLUMNS) * spriteDesc.height;
+    atlasDesc.pixelformat = spriteDesc.pixelformat;
+    if (dfbInterface->CreateSurface(dfbInterface, &atlasDesc, &volumeAtlas) != DFB_OK)
+    {
+        printf("%s: ERROR volume atlas not created\n", __FUNCTION__);
+        volumeAtlas = NULL;
+        return;
+    }
+    for (i = 0; i < VOLUME_LEVELS; i++)
+    {
+        volumeSprites[i].x = (i % VOLUME_ATLAS_COLUMNS) * spriteDesc.width;
+        volumeSprites[i].y = (i / VOLUME_ATLAS_COLUMNS) * spriteDesc.height;
+        volumeSprites[i].w = spriteDesc.width;
+        volumeSprites[i].h = spriteDesc.height;
+        sprintf(buffer, "volume_%d.png", i);
+        /* render the image straight into its cell of the atlas */
+        DFBCHECK(dfbInterface->CreateImageProvider(dfbInterface, buffer, &provider));
+        DFBCHECK(provider->RenderTo(provider, volumeAtlas, &volumeSprites[i]));
+        provider->Release(provider);
+    }
+}
+
+static void drawBanner(const OsdRect* clip, void* arg)
+{
+    char buffer[RENDER_TEXT_SIZE + 16];
+    int x;
+    int y;
+    char teletekst[] = "TXT";
+    setClip(clip);
+    x = 1 * screenWidth / 4;
+    y = 5 * screenHeight / 8;
+    DFBCHECK(primary->SetColor(primary, 0x00, 0xFF, 0x00, 0xff));
+    primary->FillRectangle(primary, x, y, 2 * screenWidth / 4, 2 * screenHeight / 8);
+    if (banner.name[0] != '\0')
+        snprintf(buffer, sizeof (buffer), "%d %s", banner.service_number, banner.name);
+    else
+        sprintf(buffer, "Channel %d", banner.service_number);
+    /* recurring strings are blitted from surfaces rendered on first use */
+    x = x + 58;
+    y = y + 58;
+    fontCacheDrawText(primary, 48, buffer, x, y, OSD_TEXT_COLOR);
+    if (banner.teletekst)
+    {
+        fontCacheDrawText(primary, 48, teletekst, 2 * screenWidth / 4 + x - 150, y, OSD_TEXT_COLOR);
+    }
+
+    sprintf(buffer, "Video PID %d", banner.vpid);
+    y = y + 58;
+    fontCacheDrawText(primary, 20, buffer, x, y, OSD_TEXT_COLOR);
+    sprintf(buffer, "Audio PID %d", banner.apid);
+    y = y + 20;
+    fontCacheDrawText(primary, 20, buffer, x, y, OSD_TEXT_COLOR);
+    if (banner.title[0] != '\0')
+    {
+        // titles change with the schedule, stale ones fall out of the cache
+        y = y + 24;
+        fontCacheDrawText(primary, 20, banner.title, x, y, OSD_TEXT_COLOR);
+    }
+}
+
+static void drawVolumeSprite(const OsdRect* clip, void* arg)
+{
+    setClip(clip);
+    /* copy the level's cell of the atlas, the banner text may have left blending on */
+    DFBCHECK(primary->SetBlittingFlags(primary, DSBLIT_NOFX));
+    DFBCHECK(primary->Blit(primary, volumeAtlas, &volumeSprites[volumeLevel], 50, 50));
+}
+
+static void applyBanner(const RenderBanner* info)
+{
+    OsdRect rect;
+    banner = *info;
+    black = (banner.vpid == 0);
+    osdSetBackdrop(black);
+    // the banner replaces the volume indicator, as a full screen clear used to
+    osdHideWidget(OSD_WIDGET_VOLUME);
+    rect.x = 1 * screenWidth / 4;
+    rect.y = 5 * screenHeight / 8;
+    rect.w = 2 * screenWidth / 4;
+    rect.h = 2 * screenHeight / 8;
+    osdShowWidget(OSD_WIDGET_BANNER, &rect, drawBanner, NULL);
+}
+
+static void applyVolume(int32_t volume)
+{
+    OsdRect rect;
+    if (volumeAtlas == NULL)
+        return;
+    volumeLevel = volume;
+    osdHideWidget(OSD_WIDGET_BANNER);
+    rect.x = 50;
+    rect.y = 50;
+    rect.w = volumeSprites[volume].w;
+    rect.h = volumeSprites[volume].h;
+    osdShowWidget(OSD_WIDGET_VOLUME, &rect, drawVolumeSprite, NULL);
+}
+
+static void renderInit()
+{
+    /* fetch the DirectFB interface */
+    DFBCHECK(DirectFBCreate(&dfbInterface));
+    /* tell the DirectFB to take the full screen for this application */
+    DFBCHECK(dfbInterface->SetCooperativeLevel(dfbInterface, DFSCL_FULLSCREEN));
+    /* create primary surface with double buffering enabled */
+    surfaceDesc.flags = DSDESC_CAPS;
+    surfaceDesc.caps = DSCAPS_PRIMARY | DSCAPS_FLIPPING;
+    DFBCHECK(dfbInterface->CreateSurface(dfbInterface, &surfaceDesc, &primary));
+    /* fetch the screen size */
+    DFBCHECK(primary->GetSize(primary, &screenWidth, &screenHeight));
+    /* clear both buffers once, afterwards only dirty rectangles are redrawn */
+    osdCompositorInit(screenWidth, screenHeight, drawBackdrop, presentRects);
+    osdCompose();
+    /* load and rasterize the banner fonts once instead of on every draw */
+    if (fontCacheInit(dfbInterface, osdFontHeights, sizeof (osdFontHeights) / sizeof (osdFontHeights[0])) != 0)
+    {
+        printf("%s: ERROR banner fonts not loaded\n", __FUNCTION__);
+    }
+    loadVolumeAtlas();
+}
+
+static void renderDeinit()
+{
+    if (volumeAtlas != NULL)
+    {
+        volumeAtlas->Release(volumeAtlas);
+        volumeAtlas = NULL;
+    }
+    fontCacheDeinit();
+    primary->Release(primary);
+    dfbInterface->Release(dfbInterface);
+}
+
+static void* renderThreadFunction(void* arg)
+{
+    RenderCommand command;
+    uint8_t bannerChanged;
+    uint8_t quit = 0;
+    uint64_t start;
+    uint64_t now;
+    renderInit();
+    sem_post(&renderStarted);
+    while (!quit)
+    {
+        renderQueueWait(&renderQueue);
+        bannerChanged = 0;
+        // everything queued since the last frame is applied first, superseded updates never reach the screen
+        while (renderQueuePop(&renderQueue, &command))
+        {
+            switch (command.type)
+            {
+            case RENDER_BANNER:
+                applyBanner(&(command.data.banner));
+                bannerChanged = 1;
+                break;
+            case RENDER_VOLUME:
+                applyVolume(command.data.volume);
+                break;
+            case RENDER_BACKDROP:
+                black = command.data.opaque;
+                osdSetBackdrop(black);
+                break;
+            case RENDER_HIDE_OSD:
+                osdHideWidget(OSD_WIDGET_BANNER);
+                osdHideWidget(OSD_WIDGET_VOLUME);
+                break;
+            case RENDER_QUIT:
+                quit = 1;
+                break;
+            }
+        }
+        start = clockNow();
+        osdCompose();
+        if (bannerChanged)
+        {
+            now = clockNow();
+            zapStatsRecord(ZAP_PHASE_OSD_FLIP, now - start);
+            zapStatsOsdPresented(now);
+        }
+    }
+    renderDeinit();
+    return NULL;
+}
+
+static void renderPush(const RenderCommand* command)
+{
+    // input handling never waits for the render thread
+    if (renderQueuePush(&renderQueue, command) != 0)
+    {
+        printf("%s: ERROR render queue full, command %d dropped\n", __FUNCTION__, command->type);
+    }
+}
+
 /****************************************************************************
  *
  * @brief Fukcija koja se koristi za popunjavanje ekrana transparentnom bojom, 
@@ -56,18 +336,10 @@ int16_t settedTimer = 0;
  *****************************************************************************/
 void fillTransparent()
 {
-    // printf("fill black\n");
-    DFBCHECK(primary->SetColor(/*surface to draw on*/ primary,
-                               /*red*/ 0x00,
-                               /*green*/ 0x00,
-                               /*blue*/ 0x00,
-                               /*alpha*/ 0x00));
-    primary->FillRectangle(/*surface to draw on*/ primary,
-                           /*upper left x coordinate*/ 0,
-                           /*upper left y coordinate*/ 0,
-                           /*rectangle width*/ screenWidth,
-                           /*rectangle height*/ screenHeight);
-
+    RenderCommand command;
+    command.type = RENDER_BACKDROP;
+    command.data.opaque = 0;
+    renderPush(&command);
 }
 
 /****************************************************************************
@@ -78,30 +350,10 @@ void fillTransparent()
  *****************************************************************************/
 void fillBlack()
 {
-    DFBCHECK(primary->SetColor(/*surface to draw on*/ primary,
-                               /*red*/ 0x00,
-                               /*green*/ 0x00,
-                               /*blue*/ 0xff,
-                               /*alpha*/ 0xff));
-    primary->FillRectangle(/*surface to draw on*/ primary,
-                           /*upper left x coordinate*/ 0,
-                           /*upper left y coordinate*/ 0,
-                           /*rectangle width*/ screenWidth,
-                           /*rectangle height*/ screenHeight);
-    primary->Flip(primary,
-                  /*region to be updated, NULL for the whole surface*/NULL,
-                  /*flip flags*/0);
-    DFBCHECK(primary->SetColor(/*surface to draw on*/ primary,
-                               /*red*/ 0x00,
-                               /*green*/ 0x00,
-                               /*blue*/ 0xff,
-                               /*alpha*/ 0xff));
-    primary->FillRectangle(/*surface to draw on*/ primary,
-                           /*upper left x coordinate*/ 0,
-                           /*upper left y coordinate*/ 0,
-                           /*rectangle width*/ screenWidth,
-                           /*rectangle height*/ screenHeight);
-
+    RenderCommand command;
+    command.type = RENDER_BACKDROP;
+    command.data.opaque = 1;
+    renderPush(&command);
 }
 
 /****************************************************************************
@@ -111,45 +363,42 @@ void fillBlack()
  *****************************************************************************/
 void initDirectFB()
 {
-    /* fetch the DirectFB interface */
-    DFBCHECK(DirectFBCreate(&dfbInterface));
-    /* tell the DirectFB to take the full screen for this application */
-    DFBCHECK(dfbInterface->SetCooperativeLevel(dfbInterface, DFSCL_FULLSCREEN));
-    /* create primary surface with double buffering enabled */
-    surfaceDesc.flags = DSDESC_CAPS;
-    surfaceDesc.caps = DSCAPS_PRIMARY | DSCAPS_FLIPPING;
-    DFBCHECK(dfbInterface->CreateSurface(dfbInterface, &surfaceDesc, &primary));
-    /* fetch the screen size */
-    DFBCHECK(primary->GetSize(primary, &screenWidth, &screenHeight));
-    /* DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc20, &fontInterface20));
-     DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc48, &fontInterface48));
-     fontInterface20->Release(fontInterface20);
-     fontInterface48->Release(fontInterface48);*/
+    if (renderQueueInit(&renderQueue) != 0 || sem_init(&renderStarted, 0, 0) != 0 ||
+            pthread_create(&renderThread, NULL, renderThreadFunction, NULL) != 0)
+    {
+        printf("%s: ERROR render thread not created\n", __FUNCTION__);
+        return;
+    }
+    /* the screen size and the OSD resources are ready once the thread has started */
+    sem_wait(&renderStarted);
+    renderRunning = 1;
     //  fillBlack();
 }
 
 void deinitDirectFB()
 {
-    primary->Release(primary);
-    dfbInterface->Release(dfbInterface);
-    timer_delete(timerId);
+    RenderCommand command;
+    eventLoopTimerDelete(&osdTimer);
+    if (!renderRunning)
+        return;
+    command.type = RENDER_QUIT;
+    // the quit command must not be dropped, the thread drains the queue quickly
+    while (renderQueuePush(&renderQueue, &command) != 0)
+    {
+        sched_yield();
+    }
+    pthread_join(renderThread, NULL);
+    renderQueueDestroy(&renderQueue);
+    sem_destroy(&renderStarted);
+    renderRunning = 0;
 }
 
-void timerFunction()
+void timerFunction(void* arg)
 {
+    RenderCommand command;
     //   printf("%s started\n", __FUNCTION__);
-    if (black == 0)
-    {
-        fillTransparent();
-    }
-    else
-    {
-        fillBlack();
-    }
-    primary->Flip(primary, NULL, 0);
-    fillTransparent();
-    memset(&timerSpec, 0, sizeof (timerSpec));
-    timer_settime(timerId, 0, &timerSpec, &timerSpecOld);
+    command.type = RENDER_HIDE_OSD;
+    renderPush(&command);
     settedTimer = 0;
     //   printf("%s ended\n", __FUNCTION__);
 
@@ -157,19 +406,9 @@ void timerFunction()
 
 void setTimer(int32_t interval)
 {
-    struct sigevent signalEvent;
-    memset(&timerSpec, 0, sizeof (timerSpec));
-    signalEvent.sigev_notify = SIGEV_THREAD;
-    signalEvent.sigev_notify_function = &timerFunction;
-    signalEvent.sigev_value.sival_ptr = NULL;
-    signalEvent.sigev_notify_attributes = NULL;
-    timerSpec.it_value.tv_sec = interval; //3 seconds timeout
-    timerSpec.it_value.tv_nsec = 0;
-    if (settedTimer)
-        timer_delete(timerId);
     settedTimer = 1;
-    timer_create(CLOCK_REALTIME, &signalEvent, &timerId);
-    timer_settime(timerId, timerFlags, &timerSpec, &timerSpecOld);
+    // restarting the timer replaces the previous deadline
+    eventLoopTimerStart(&osdTimer, (uint32_t) interval * 1000, timerFunction, NULL);
 }
 
 /****************************************************************************
@@ -178,64 +417,23 @@ void setTimer(int32_t interval)
  * Fukcija koja se kroisti za iscrtavanje informacija o trenutnom programu
  *
  * @param service_number - [in] btoj trenutnog programa
+ * @param name - [in] naziv servisa iz SDT tabele (NULL ako nije poznat)
  * @param vpid - [in] PID video streama
  * @param apid - [in] PID audio streama
  * @param teletekst - [in] vrijednost da li program sadrzi teletekst ili ne (0 = ne,>0 da)
+ * @param title - [in] naziv trenutnog dogadjaja iz EIT tabele (NULL ako nije poznat)
  *****************************************************************************/
-void drawTextInfo(int32_t service_number, uint16_t vpid, uint16_t apid, uint8_t tel)
+void drawTextInfo(int32_t service_number, const char* name, uint16_t vpid, uint16_t apid, uint8_t tel, const char* title)
 {
-    char buffer[50];
-    int x;
-    int y;
-    char teletekst[] = "TXT";
-    /* rectangle drawing */
-    if (vpid)
-    {
-        fillTransparent();
-        black = 0;
-    }
-    else
-    {
-        fillBlack();
-        black = 1;
-    }
-    x = 1 * screenWidth / 4;
-    y = 5 * screenHeight / 8;
-    DFBCHECK(primary->SetColor(primary, 0x00, 0xFF, 0x00, 0xff));
-    primary->FillRectangle(primary, x, y, 2 * screenWidth / 4, 2 * screenHeight / 8);
-    /* create the font and set the created font for primary surface text drawing */
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc48, &fontInterface48));
-    DFBCHECK(primary->SetFont(primary, fontInterface48));
-    sprintf(buffer, "Channel %d", service_number);
-    fontDesc48.flags = DFDESC_HEIGHT;
-    fontDesc48.height = 48;
-    /* draw the text */
-    DFBCHECK(primary->SetColor(primary, 0xFF, 0xFF, 0xFF, 0x00));
-    x = x + 58;
-    y = y + 58;
-    DFBCHECK(primary->DrawString(primary, buffer, -1, x, y, DSTF_LEFT));
-    if (tel)
-    {
-        DFBCHECK(primary->DrawString(primary, teletekst, -1, 2 * screenWidth / 4 + x - 150, y, DSTF_LEFT));
-        fontInterface48->Release(fontInterface48);
-    }
-
-    DFBCHECK(dfbInterface->CreateFont(dfbInterface, "/home/galois/fonts/DejaVuSans.ttf", &fontDesc20, &fontInterface20));
-    DFBCHECK(primary->SetFont(primary, fontInterface20));
-
-    fontDesc20.flags = DFDESC_HEIGHT;
-    fontDesc20.height = 20;
-    /* draw the text */
-    sprintf(buffer, "Video PID %d", vpid);
-    DFBCHECK(primary->SetColor(primary, 0xFF, 0xFF, 0xFF, 0x00));
-    y = y + 58;
-    DFBCHECK(primary->DrawString(primary, buffer, -1, x, y, DSTF_LEFT));
-    sprintf(buffer, "Audio PID %d", apid);
-    DFBCHECK(primary->SetColor(primary, 0xFF, 0xFF, 0xFF, 0x00));
-    y = y + 20;
-    DFBCHECK(primary->DrawString(primary, buffer, -1, x, y, DSTF_LEFT));
-    fontInterface20->Release(fontInterface20);
-    primary->Flip(primary, NULL, 0);
+    RenderCommand command;
+    command.type = RENDER_BANNER;
+    command.data.banner.service_number = service_number;
+    snprintf(command.data.banner.name, sizeof (command.data.banner.name), "%s", (name != NULL) ? name : "");
+    command.data.banner.vpid = vpid;
+    command.data.banner.apid = apid;
+    command.data.banner.teletekst = tel;
+    snprintf(command.data.banner.title, sizeof (command.data.banner.title), "%s", (title != NULL) ? title : "");
+    renderPush(&command);
     setTimer(3);
 }
 
@@ -244,46 +442,18 @@ void drawTextInfo(int32_t service_number, uint16_t vpid, uint16_t apid, uint8_t
  * @brief
  * Funkcija koja se koristi za iscrtavanje informacije o jacini zvuka
  *
- * @param volume -[in] vrijednost renutne jacine zvuka (od 0 do 9)
+ * @param volume -[in] vrijednost renutne jacine zvuka (od 0 do 10)
  *****************************************************************************/
 void drawVolume(int32_t volume)
 {
-    IDirectFBImageProvider *provider;
-    IDirectFBSurface *surface = NULL;
-    int32_t surfaceHeight, surfaceWidth;
-    char buffer[50];
-    sprintf(buffer, "volume_%d.png", volume);
-    if (black == 0)
+    RenderCommand command;
+    if (volume < 0 || volume >= VOLUME_LEVELS)
     {
-        fillTransparent();
+        printf("%s: ERROR no image for volume %d\n", __FUNCTION__, volume);
+        return;
     }
-    else
-    {
-        fillBlack();
-    }
-    // printf("%s : buffer %s\n", __FUNCTION__, buffer);
-    /* create the image provider for the specified file */
-    DFBCHECK(dfbInterface->CreateImageProvider(dfbInterface, buffer, &provider));
-    /* get surface descriptor for the surface where the image will be rendered */
-    DFBCHECK(provider->GetSurfaceDescription(provider, &surfaceDesc));
-    /* create the surface for the image */
-    DFBCHECK(dfbInterface->CreateSurface(dfbInterface, &surfaceDesc, &surface));
-    /* render the image to the surface */
-    DFBCHECK(provider->RenderTo(provider, surface, NULL));
-
-    /* cleanup the provider after rendering the image to the surface */
-    provider->Release(provider);
-
-    /* fetch the logo size and add (blit) it to the screen */
-    DFBCHECK(surface->GetSize(surface, &surfaceWidth, &surfaceHeight));
-    DFBCHECK(primary->Blit(primary, surface, NULL, 50, 50));
-    primary->Flip(primary, NULL, 0);
+    command.type = RENDER_VOLUME;
+    command.data.volume = volume;
+    renderPush(&command);
     setTimer(3);
 }
-
-
-
-
-
-
-
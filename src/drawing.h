@@ -24,21 +24,6 @@
 
 
 #include <stdint.h>
-#include <directfb.h>
-
-
-
-/* helper macro for error checking */
-#define DFBCHECK(x...)                                      \
-{                                                           \
-DFBResult err = x;                                          \
-                                                            \
-if (err != DFB_OK)                                          \
-  {                                                         \
-    fprintf( stderr, "%s <%d>:\n\t", __FILE__, __LINE__ );  \
-    DirectFBErrorFatal( #x, err );                          \
-  }                                                         \
-}
 
 /****************************************************************************
  *
@@ -47,16 +32,19 @@ if (err != DFB_OK)                                          \
  *
  * @param
  * service_number - [in] btoj trenutnog programa
+ * name - [in] naziv servisa iz SDT tabele (NULL ako nije poznat)
  * vpid - [in] PID video streama
  * apid - [in] PID audio streama
  * teletekst - [in] vrijednost da li program sadrzi teletekst ili ne (0 = ne,>0 da)
+ * title - [in] naziv trenutnog dogadjaja iz EIT tabele (NULL ako nije poznat)
  *****************************************************************************/
-void drawTextInfo(int32_t service_number, uint16_t vpid, uint16_t apid, uint8_t teletekst);
+void drawTextInfo(int32_t service_number, const char* name, uint16_t vpid, uint16_t apid, uint8_t teletekst, const char* title);
 
 /****************************************************************************
  *
  * @brief
- * Fukcija koja se koristi za inicijalizaciju directFB komponenti
+ * Fukcija koja pokrece nit za iscrtavanje, koja kreira sve directFB komponente.
+ * Ostale funkcije ovog modula samo salju komande toj niti i ne cekaju.
  * 
  *****************************************************************************/
 void initDirectFB();
@@ -64,7 +52,7 @@ void initDirectFB();
 /****************************************************************************
  *
  * @brief
- * Fukcija koja se koristi za deinicijalizaciju directFB komponenti
+ * Fukcija koja zaustavlja nit za iscrtavanje, koja oslobadja directFB komponente
  * 
  *****************************************************************************/
 void deinitDirectFB();
@@ -75,7 +63,7 @@ void deinitDirectFB();
  * Funkcija koja se koristi za iscrtavanje informacije o jacini zvuka
  *
  * @param
- * volume -[in] vrijednost renutne jacine zvuka (od 0 do 9)
+ * volume -[in] vrijednost renutne jacine zvuka (od 0 do 10)
  *****************************************************************************/
 void drawVolume(int32_t volume);
 
@@ -0,0 +1,401 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file epg_index.c
+ * \brief
+ * Ovaj modul realizuje indeks EPG rasporeda. Dogadjaji jednog servisa se ne
+ * preklapaju, pa su u nizu sortiranom po pocetku sortirani i po kraju; upit
+ * "sta je na servisu u trenutku T" je jedna binarna pretraga. Naziv i tekst
+ * dogadjaja se cuvaju jedan iza drugog u areni, a dogadjaj pamti samo offset,
+ * tako da se niz dogadjaja moze pomjerati bez kopiranja stringova.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "epg_index.h"
+#include "service_slot.h"
+#include "table_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define EPG_SLOTS SERVICE_SLOT_COUNT(EPG_MAX_SERVICES)
+#define EPG_INITIAL_CAPACITY 32
+
+typedef struct _EpgEvent
+{
+    uint32_t start_time;
+    uint32_t end_time;
+    uint32_t strings; // offset naziva u areni, tekst pocinje iza '\0' naziva
+    uint16_t event_id;
+    uint8_t running_status;
+} EpgEvent;
+
+typedef struct _EpgService
+{
+    ServiceSlotKey key;
+    EpgEvent* events; // sortirano po start_time, bez preklapanja
+    uint32_t count;
+    uint32_t capacity;
+} EpgService;
+
+static EpgService services[EPG_SLOTS];
+static uint32_t serviceCount = 0;
+static char* arena = NULL;
+static uint32_t arenaUsed = 0;
+static pthread_mutex_t epgMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi servis, ili prazan ulaz u koji servis treba
+ * upisati. Poziva se sa zakljucanim epgMutex.
+ *
+ * @param service_id - [in] service_id
+ * @return pokazivac na ulaz, NULL ako je tabela puna
+ *****************************************************************************/
+static EpgService* epgFindService(uint16_t service_id)
+{
+    int32_t slot = serviceSlotFind(&(services[0].key), sizeof (services[0]), EPG_SLOTS, service_id);
+    return (slot < 0) ? NULL : &services[slot];
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca indeks prvog dogadjaja servisa koji se zavrsava nakon
+ * trenutka time (binarna pretraga po end_time).
+ *
+ *****************************************************************************/
+static uint32_t epgFirstEndingAfter(const EpgService* service, uint32_t time)
+{
+    uint32_t low = 0;
+    uint32_t high = service->count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (service->events[mid].end_time <= time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja sabija arenu: stringovi svih dogadjaja se kopiraju u novu
+ * arenu, a prostor zamijenjenih dogadjaja se oslobadja.
+ *
+ * @return 0 ako nema greske, -1 ako nema memorije
+ *****************************************************************************/
+static int32_t epgArenaCompact(void)
+{
+    char* compacted = (char*) malloc(EPG_ARENA_SIZE);
+    uint32_t used = 2;
+    uint32_t i;
+    uint32_t j;
+    if (compacted == NULL)
+        return -1;
+    compacted[0] = '\0';
+    compacted[1] = '\0';
+    for (i = 0; i < EPG_SLOTS; i++)
+    {
+        for (j = 0; j < services[i].count; j++)
+        {
+            EpgEvent* event = &(services[i].events[j]);
+            const char* name = arena + event->strings;
+            uint32_t length;
+            if (event->strings == 0)
+                continue;
+            length = (uint32_t) strlen(name) + 1;
+            length += (uint32_t) strlen(name + length) + 1;
+            memcpy(compacted + used, name, length);
+            event->strings = used;
+            used += length;
+        }
+    }
+    free(arena);
+    arena = compacted;
+    arenaUsed = used;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje naziv i tekst dogadjaja u arenu.
+ *
+ * @param strings - [in] naziv i tekst, razdvojeni i zavrseni sa '\0'
+ * @param length - [in] ukupna duzina, ukljucujuci oba '\0'
+ * @return offset u areni, 0 (prazan naziv i tekst) ako nema mjesta
+ *****************************************************************************/
+static uint32_t epgArenaStore(const char* strings, uint32_t length)
+{
+    uint32_t offset;
+    if (arena == NULL)
+    {
+        arena = (char*) malloc(EPG_ARENA_SIZE);
+        if (arena == NULL)
+            return 0;
+        // offset 0 je uvijek prazan naziv i prazan tekst
+        arena[0] = '\0';
+        arena[1] = '\0';
+        arenaUsed = 2;
+    }
+    if (arenaUsed + length > EPG_ARENA_SIZE && epgArenaCompact() != 0)
+        return 0;
+    if (arenaUsed + length > EPG_ARENA_SIZE)
+        return 0;
+    offset = arenaUsed;
+    memcpy(arena + offset, strings, length);
+    arenaUsed += length;
+    return offset;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja iz deskriptora dogadjaja izdvaja naziv i tekst (short_event,
+ * pa tekst extended_event deskriptora) u jedan bafer.
+ *
+ * @param event - [in] pogled na EIT dogadjaj
+ * @param strings - [out] bafer velicine EPG_NAME_SIZE + EPG_TEXT_SIZE
+ * @return ukupna duzina, ukljucujuci oba '\0'
+ *****************************************************************************/
+static uint32_t epgEventStrings(const EitEventView* event, char* strings)
+{
+    DescriptorIterator it;
+    DescriptorView descriptor;
+    ShortEventDescriptor shortEvent;
+    ExtendedEventDescriptor extendedEvent;
+    char name[EPG_NAME_SIZE];
+    char text[EPG_TEXT_SIZE];
+    uint32_t nameLength = 0;
+    uint32_t textLength = 0;
+
+    name[0] = '\0';
+    text[0] = '\0';
+    descriptorIteratorInit(&it, event->descriptors, event->descriptors_loop_length);
+    while (descriptorNext(&it, &descriptor))
+    {
+        if (descriptor.tag == 0x4D && nameLength == 0 && textLength == 0)
+        {
+            if (parseShortEventDescriptor(&descriptor, &shortEvent) == 0)
+            {
+                nameLength = dvbStringCopy(name, sizeof (name), shortEvent.event_name, shortEvent.event_name_length);
+                textLength = dvbStringCopy(text, sizeof (text), shortEvent.text, shortEvent.text_length);
+            }
+        }
+        else if (descriptor.tag == 0x4E && textLength + 1 < sizeof (text))
+        {
+            if (parseExtendedEventDescriptor(&descriptor, &extendedEvent) == 0)
+                textLength += dvbStringCopy(text + textLength, sizeof (text) - textLength, extendedEvent.text, extendedEvent.text_length);
+        }
+    }
+    memcpy(strings, name, nameLength + 1);
+    memcpy(strings + nameLength + 1, text, textLength + 1);
+    return nameLength + textLength + 2;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje dogadjaj u niz servisa. Dogadjaji sa istim event_id i
+ * dogadjaji koji se preklapaju sa novim se brisu. Poziva se sa zakljucanim
+ * epgMutex.
+ *
+ * @return 0 ako nema greske, -1 ako nema memorije
+ *****************************************************************************/
+static int32_t epgInsert(EpgService* service, const EpgEvent* event)
+{
+    uint32_t position;
+    uint32_t last;
+    uint32_t i;
+
+    for (i = 0; i < service->count; i++)
+    {
+        if (service->events[i].event_id == event->event_id)
+        {
+            memmove(&(service->events[i]), &(service->events[i + 1]), (service->count - i - 1) * sizeof (EpgEvent));
+            service->count--;
+            break;
+        }
+    }
+
+    position = epgFirstEndingAfter(service, event->start_time);
+    for (last = position; last < service->count && service->events[last].start_time < event->end_time; last++)
+        ;
+    if (last > position)
+    {
+        memmove(&(service->events[position]), &(service->events[last]), (service->count - last) * sizeof (EpgEvent));
+        service->count -= last - position;
+    }
+
+    if (service->count == service->capacity)
+    {
+        uint32_t capacity = service->capacity ? 2 * service->capacity : EPG_INITIAL_CAPACITY;
+        EpgEvent* events = (EpgEvent*) realloc(service->events, capacity * sizeof (EpgEvent));
+        if (events == NULL)
+            return -1;
+        service->events = events;
+        service->capacity = capacity;
+    }
+    memmove(&(service->events[position + 1]), &(service->events[position]), (service->count - position) * sizeof (EpgEvent));
+    service->events[position] = *event;
+    service->count++;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja popunjava rezultat upita iz dogadjaja indeksa. Poziva se sa
+ * zakljucanim epgMutex.
+ *
+ *****************************************************************************/
+static void epgFillInfo(EpgEventInfo* info, uint16_t service_id, const EpgEvent* event)
+{
+    const char* name = arena != NULL ? arena + event->strings : "";
+    uint32_t nameLength = (uint32_t) strlen(name);
+    info->service_id = service_id;
+    info->event_id = event->event_id;
+    info->start_time = event->start_time;
+    info->end_time = event->end_time;
+    info->running_status = event->running_status;
+    strncpy(info->name, name, sizeof (info->name) - 1);
+    info->name[sizeof (info->name) - 1] = '\0';
+    strncpy(info->text, arena != NULL ? name + nameLength + 1 : "", sizeof (info->text) - 1);
+    info->text[sizeof (info->text) - 1] = '\0';
+}
+
+void epgIndexReset(void)
+{
+    uint32_t i;
+    pthread_mutex_lock(&epgMutex);
+    for (i = 0; i < EPG_SLOTS; i++)
+    {
+        free(services[i].events);
+    }
+    memset(services, 0, sizeof (services));
+    serviceCount = 0;
+    free(arena);
+    arena = NULL;
+    arenaUsed = 0;
+    pthread_mutex_unlock(&epgMutex);
+}
+
+int32_t epgIndexAddSection(const SectionView* view)
+{
+    EitEventIterator it;
+    EitEventView eventView;
+    EpgService* service;
+    EpgEvent event;
+    char strings[EPG_NAME_SIZE + EPG_TEXT_SIZE];
+    int32_t added = 0;
+
+    if (view->table_id < EIT_SCHEDULE_FIRST_TABLE_ID || view->table_id > EIT_SCHEDULE_LAST_TABLE_ID)
+        return -1;
+    if (!view->current_next_indicator || eitEventIteratorInit(view, &it) != SECTION_OK)
+        return -1;
+
+    pthread_mutex_lock(&epgMutex);
+    service = epgFindService(view->table_id_extension);
+    if (service == NULL || (!service->key.used && serviceCount >= EPG_MAX_SERVICES))
+    {
+        pthread_mutex_unlock(&epgMutex);
+        return -1;
+    }
+    if (!service->key.used)
+    {
+        service->key.used = 1;
+        service->key.service_id = view->table_id_extension;
+        serviceCount++;
+    }
+
+    while (eitEventNext(&it, &eventView))
+    {
+        // vrijeme se dekoduje samo jednom, prilikom upisa u indeks
+        event.start_time = dvbTimeToEpoch(eventView.start_time);
+        if (event.start_time == 0)
+            continue;
+        event.end_time = event.start_time + dvbDurationToSeconds(eventView.duration);
+        event.event_id = eventView.event_id;
+        event.running_status = eventView.running_status;
+        event.strings = epgArenaStore(strings, epgEventStrings(&eventView, strings));
+        if (epgInsert(service, &event) != 0)
+        {
+            printf("%s: ERROR out of memory for service %d\n", __FUNCTION__, service->key.service_id);
+            break;
+        }
+        added++;
+    }
+    pthread_mutex_unlock(&epgMutex);
+    return added;
+}
+
+int32_t epgIndexFindAt(uint16_t service_id, uint32_t time, EpgEventInfo* info)
+{
+    EpgService* service;
+    uint32_t i;
+    pthread_mutex_lock(&epgMutex);
+    service = epgFindService(service_id);
+    if (service == NULL || !service->key.used)
+    {
+        pthread_mutex_unlock(&epgMutex);
+        return -1;
+    }
+    i = epgFirstEndingAfter(service, time);
+    if (i >= service->count || service->events[i].start_time > time)
+    {
+        pthread_mutex_unlock(&epgMutex);
+        return -1;
+    }
+    epgFillInfo(info, service_id, &(service->events[i]));
+    pthread_mutex_unlock(&epgMutex);
+    return 0;
+}
+
+uint32_t epgIndexFindOverlapping(uint32_t from, uint32_t to, EpgEventInfo* infos, uint32_t maxInfos)
+{
+    uint32_t found = 0;
+    uint32_t i;
+    uint32_t j;
+    pthread_mutex_lock(&epgMutex);
+    for (i = 0; i < EPG_SLOTS && found < maxInfos; i++)
+    {
+        const EpgService* service = &(services[i]);
+        if (!service->key.used)
+            continue;
+        for (j = epgFirstEndingAfter(service, from); j < service->count && service->events[j].start_time < to && found < maxInfos; j++)
+        {
+            epgFillInfo(&(infos[found++]), service->key.service_id, &(service->events[j]));
+        }
+    }
+    pthread_mutex_unlock(&epgMutex);
+    return found;
+}
+
+uint32_t epgIndexEventCount(void)
+{
+    uint32_t count = 0;
+    uint32_t i;
+    pthread_mutex_lock(&epgMutex);
+    for (i = 0; i < EPG_SLOTS; i++)
+    {
+        count += services[i].count;
+    }
+    pthread_mutex_unlock(&epgMutex);
+    return count;
+}
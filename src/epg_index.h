@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file epg_index.h
+ * \brief
+ * Ovaj modul realizuje indeks EPG rasporeda (EIT schedule, table_id 0x50 -
+ * 0x6F) za sve servise multipleksa. Dogadjaji svakog servisa se cuvaju
+ * sortirani po vremenu pocetka (u sekundama od 1.1.1970), a nazivi i opisi
+ * u zajednickoj areni, tako da se upiti po vremenu rjesavaju binarnom
+ * pretragom.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef EPG_INDEX_H
+#define EPG_INDEX_H
+
+#include <stdint.h>
+#include "section_view.h"
+
+#define EPG_MAX_SERVICES 64
+#define EPG_ARENA_SIZE (256 * 1024)
+#define EPG_NAME_SIZE 64
+#define EPG_TEXT_SIZE 256
+
+typedef struct _EpgEventInfo
+{
+    uint16_t service_id;
+    uint16_t event_id;
+    uint32_t start_time; // sekunde od 1.1.1970 (UTC)
+    uint32_t end_time; // start_time + trajanje
+    uint8_t running_status;
+    char name[EPG_NAME_SIZE];
+    char text[EPG_TEXT_SIZE];
+} EpgEventInfo;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sve dogadjaje i oslobadja memoriju indeksa.
+ *
+ *****************************************************************************/
+void epgIndexReset(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja dodaje sve dogadjaje iz EIT schedule sekcije u indeks.
+ * Dogadjaj koji ima isti event_id ili se vremenski preklapa sa novim
+ * dogadjajem istog servisa se zamjenjuje.
+ *
+ * @param view - [in] validiran pogled na EIT sekciju (table_id 0x50 - 0x6F)
+ * @return broj dodatih dogadjaja, ili -1 ako sekcija nije EIT schedule
+ *****************************************************************************/
+int32_t epgIndexAddSection(const SectionView* view);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi dogadjaj koji se na servisu emituje u trenutku
+ * time. Slozenost je O(log n), n je broj dogadjaja servisa.
+ *
+ * @param service_id - [in] service_id
+ * @param time - [in] trenutak (sekunde od 1.1.1970, UTC)
+ * @param info - [out] pronadjeni dogadjaj
+ * @return 0 ako je dogadjaj pronadjen, -1 u suprotnom
+ *****************************************************************************/
+int32_t epgIndexFindAt(uint16_t service_id, uint32_t time, EpgEventInfo* info);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi sve dogadjaje svih servisa koji se preklapaju sa
+ * intervalom [from, to). Za svaki servis se granica pronalazi binarnom
+ * pretragom, pa je slozenost O(S log n + k) za S servisa i k rezultata.
+ *
+ * @param from - [in] pocetak intervala
+ * @param to - [in] kraj intervala
+ * @param infos - [out] niz za rezultate, grupisan po servisu i sortiran po vremenu
+ * @param maxInfos - [in] velicina niza
+ * @return broj upisanih dogadjaja
+ *****************************************************************************/
+uint32_t epgIndexFindOverlapping(uint32_t from, uint32_t to, EpgEventInfo* infos, uint32_t maxInfos);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca ukupan broj dogadjaja u indeksu.
+ *
+ * @return broj dogadjaja
+ *****************************************************************************/
+uint32_t epgIndexEventCount(void);
+
+#endif
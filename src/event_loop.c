@@ -0,0 +1,308 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file event_loop.c
+ * \brief
+ * epoll_event.data.ptr pokazuje na EventLoopSource, tako da se deskriptori
+ * tajmera, eventfd i ulazni uredjaji obradjuju istim kodom. Obavjestenja iz
+ * drugih niti idu u kruzni red pod mutex-om, a eventfd samo budi petlju.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "event_loop.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define EVENT_LOOP_BATCH 8
+
+typedef struct _EventLoopPostEntry
+{
+    Event_Loop_Callback callback;
+    void* arg;
+} EventLoopPostEntry;
+
+static int32_t epollFd = -1;
+static EventLoopSource wakeSource = {-1, NULL, NULL};
+static EventLoopSource sources[EVENT_LOOP_MAX_SOURCES];
+static uint8_t stopRequested = 0;
+
+static pthread_mutex_t postMutex = PTHREAD_MUTEX_INITIALIZER;
+static EventLoopPostEntry posts[EVENT_LOOP_MAX_POSTS];
+static uint32_t postHead = 0;
+static uint32_t postCount = 0;
+
+static void eventLoopWake(void)
+{
+    uint64_t one = 1;
+    // a full counter still wakes the loop, the write may be dropped
+    if (write(wakeSource.fd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+        printf("%s: ERROR eventfd write failed\n", __FUNCTION__);
+}
+
+static void eventLoopDrainPosts(int32_t fd, uint32_t events, void* arg)
+{
+    EventLoopPostEntry entry;
+    uint64_t count;
+    if (read(fd, &count, sizeof (count)) < 0 && errno != EAGAIN)
+        return;
+    while (1)
+    {
+        pthread_mutex_lock(&postMutex);
+        if (postCount == 0)
+        {
+            pthread_mutex_unlock(&postMutex);
+            return;
+        }
+        entry = posts[postHead];
+        postHead = (postHead + 1) % EVENT_LOOP_MAX_POSTS;
+        postCount--;
+        pthread_mutex_unlock(&postMutex);
+        clockTakeOver();
+        entry.callback(entry.arg);
+    }
+}
+
+static int32_t eventLoopAddSource(EventLoopSource* source, uint32_t events)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof (event));
+    event.events = events;
+    event.data.ptr = source;
+    return (epoll_ctl(epollFd, EPOLL_CTL_ADD, source->fd, &event) == 0) ? 0 : -1;
+}
+
+int32_t eventLoopInit(void)
+{
+    uint32_t i;
+    for (i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+        sources[i].fd = -1;
+    postHead = 0;
+    postCount = 0;
+    stopRequested = 0;
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        printf("%s: ERROR epoll_create1 failed (%s)\n", __FUNCTION__, strerror(errno));
+        return -1;
+    }
+    wakeSource.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    wakeSource.callback = eventLoopDrainPosts;
+    wakeSource.arg = NULL;
+    if (wakeSource.fd < 0 || eventLoopAddSource(&wakeSource, EPOLLIN) != 0)
+    {
+        printf("%s: ERROR eventfd failed (%s)\n", __FUNCTION__, strerror(errno));
+        eventLoopDeinit();
+        return -1;
+    }
+    return 0;
+}
+
+void eventLoopDeinit(void)
+{
+    if (wakeSource.fd >= 0)
+    {
+        close(wakeSource.fd);
+        wakeSource.fd = -1;
+    }
+    if (epollFd >= 0)
+    {
+        close(epollFd);
+        epollFd = -1;
+    }
+}
+
+void eventLoopRun(void)
+{
+    struct epoll_event events[EVENT_LOOP_BATCH];
+    EventLoopSource* source;
+    int32_t count;
+    int32_t i;
+    while (!__atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE))
+    {
+        // on virtual time the clock moves on once the posts taken so far are handled
+        clockThreadIdle();
+        count = epoll_wait(epollFd, events, EVENT_LOOP_BATCH, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            printf("%s: ERROR epoll_wait failed (%s)\n", __FUNCTION__, strerror(errno));
+            break;
+        }
+        for (i = 0; i < count; i++)
+        {
+            source = (EventLoopSource*) events[i].data.ptr;
+            // an earlier callback of this batch may have removed the source
+            if (source->fd >= 0)
+                source->callback(source->fd, events[i].events, source->arg);
+        }
+    }
+    clockThreadIdle();
+    stopRequested = 0;
+}
+
+void eventLoopStop(void)
+{
+    __atomic_store_n(&stopRequested, 1, __ATOMIC_RELEASE);
+    eventLoopWake();
+}
+
+int32_t eventLoopAddFd(int32_t fd, uint32_t events, Event_Loop_Fd_Callback callback, void* arg)
+{
+    uint32_t i;
+    for (i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (sources[i].fd < 0)
+            break;
+    }
+    if (i == EVENT_LOOP_MAX_SOURCES)
+    {
+        printf("%s: ERROR no free source for fd %d\n", __FUNCTION__, fd);
+        return -1;
+    }
+    sources[i].fd = fd;
+    sources[i].callback = callback;
+    sources[i].arg = arg;
+    if (eventLoopAddSource(&sources[i], events) != 0)
+    {
+        printf("%s: ERROR epoll_ctl failed for fd %d (%s)\n", __FUNCTION__, fd, strerror(errno));
+        sources[i].fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void eventLoopRemoveFd(int32_t fd)
+{
+    uint32_t i;
+    for (i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (sources[i].fd == fd)
+        {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+            sources[i].fd = -1;
+            return;
+        }
+    }
+}
+
+int32_t eventLoopPost(Event_Loop_Callback callback, void* arg)
+{
+    pthread_mutex_lock(&postMutex);
+    if (postCount == EVENT_LOOP_MAX_POSTS)
+    {
+        pthread_mutex_unlock(&postMutex);
+        printf("%s: ERROR post queue is full\n", __FUNCTION__);
+        return -1;
+    }
+    posts[(postHead + postCount) % EVENT_LOOP_MAX_POSTS].callback = callback;
+    posts[(postHead + postCount) % EVENT_LOOP_MAX_POSTS].arg = arg;
+    postCount++;
+    // before the loop thread can take the post
+    clockHandOff();
+    pthread_mutex_unlock(&postMutex);
+    eventLoopWake();
+    return 0;
+}
+
+static void eventLoopTimerExpired(int32_t fd, uint32_t events, void* arg)
+{
+    EventLoopTimer* timer = (EventLoopTimer*) arg;
+    uint64_t expirations;
+    // nothing to read if the timer was restarted after it fired
+    if (read(fd, &expirations, sizeof (expirations)) != sizeof (expirations))
+        return;
+    timer->callback(timer->arg);
+}
+
+static void eventLoopVirtualFire(void* arg)
+{
+    EventLoopTimer* timer = (EventLoopTimer*) arg;
+    // a post left over from a timer that was restarted or stopped is ignored
+    if (__atomic_exchange_n(&(timer->expired), 0, __ATOMIC_ACQ_REL))
+        timer->callback(timer->arg);
+}
+
+/* called from clockAdvance, the callback itself has to run on the loop thread */
+static void eventLoopVirtualExpired(void* arg)
+{
+    EventLoopTimer* timer = (EventLoopTimer*) arg;
+    __atomic_store_n(&(timer->expired), 1, __ATOMIC_RELEASE);
+    eventLoopPost(eventLoopVirtualFire, timer);
+}
+
+int32_t eventLoopTimerStart(EventLoopTimer* timer, uint32_t timeoutMs, Event_Loop_Callback callback, void* arg)
+{
+    struct itimerspec timerSpec;
+
+    timer->callback = callback;
+    timer->arg = arg;
+    if (clockIsVirtual())
+    {
+        __atomic_store_n(&(timer->expired), 0, __ATOMIC_RELEASE);
+        return clockTimerStart(&(timer->virtualTimer), timeoutMs, eventLoopVirtualExpired, timer);
+    }
+
+    if (timer->source.fd < 0)
+    {
+        timer->source.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timer->source.fd < 0)
+            return -1;
+        timer->source.callback = eventLoopTimerExpired;
+        timer->source.arg = timer;
+        if (eventLoopAddSource(&(timer->source), EPOLLIN) != 0)
+        {
+            close(timer->source.fd);
+            timer->source.fd = -1;
+            return -1;
+        }
+    }
+    memset(&timerSpec, 0, sizeof (timerSpec));
+    timerSpec.it_value.tv_sec = timeoutMs / 1000;
+    timerSpec.it_value.tv_nsec = (long) (timeoutMs % 1000) * 1000000L;
+    // a zero it_value would disarm the timer instead of firing it
+    if (timeoutMs == 0)
+        timerSpec.it_value.tv_nsec = 1;
+    return (timerfd_settime(timer->source.fd, 0, &timerSpec, NULL) == 0) ? 0 : -1;
+}
+
+void eventLoopTimerStop(EventLoopTimer* timer)
+{
+    struct itimerspec timerSpec;
+    __atomic_store_n(&(timer->expired), 0, __ATOMIC_RELEASE);
+    clockTimerStop(&(timer->virtualTimer));
+    if (timer->source.fd >= 0)
+    {
+        memset(&timerSpec, 0, sizeof (timerSpec));
+        timerfd_settime(timer->source.fd, 0, &timerSpec, NULL);
+    }
+}
+
+void eventLoopTimerDelete(EventLoopTimer* timer)
+{
+    eventLoopTimerStop(timer);
+    clockTimerDelete(&(timer->virtualTimer));
+    if (timer->source.fd >= 0)
+    {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, timer->source.fd, NULL);
+        close(timer->source.fd);
+        timer->source.fd = -1;
+    }
+}
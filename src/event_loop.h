@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file event_loop.h
+ * \brief
+ * Ovaj modul realizuje petlju dogadjaja (reactor) nad epoll-om. Ulaz sa
+ * daljinskog upravljaca, tajmeri za sakrivanje OSD-a (timerfd) i obavjestenja
+ * iz niti demultipleksera i plejera (eventfd) obradjuju se u jednoj niti, pa
+ * stanje korisnickog interfejsa i iscrtavanje ne traze zakljucavanje.
+ *
+ * Funkcije eventLoopPost i eventLoopStop se smiju pozivati iz bilo koje niti,
+ * a sve ostale samo iz niti petlje ili prije nego sto se petlja pokrene.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include "clock_source.h"
+
+/* najveci broj fajl deskriptora koje petlja prati, ne racunajuci tajmere */
+#define EVENT_LOOP_MAX_SOURCES 16
+/* najveci broj obavjestenja koja cekaju na obradu */
+#define EVENT_LOOP_MAX_POSTS 64
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja se poziva kada je fajl deskriptor spreman.
+ *
+ * @param fd - [in] fajl deskriptor
+ * @param events - [in] EPOLLIN, EPOLLERR, ...
+ * @param arg - [in] pokazivac proslijedjen pri registraciji
+ *****************************************************************************/
+typedef void(*Event_Loop_Fd_Callback)(int32_t fd, uint32_t events, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja se poziva iz niti petlje za tajmere i obavjestenja.
+ *
+ * @param arg - [in] pokazivac proslijedjen pri pokretanju
+ *****************************************************************************/
+typedef void(*Event_Loop_Callback)(void* arg);
+
+typedef struct _EventLoopSource
+{
+    int32_t fd; // -1 ako je mjesto slobodno
+    Event_Loop_Fd_Callback callback;
+    void* arg;
+} EventLoopSource;
+
+typedef struct _EventLoopTimer
+{
+    Event_Loop_Callback callback;
+    void* arg;
+    EventLoopSource source; // timerfd, stvarni rezim
+    ClockTimer virtualTimer; // virtuelni rezim, istek se prosljedjuje kroz eventLoopPost
+    uint8_t expired;
+} EventLoopTimer;
+
+#define EVENT_LOOP_TIMER_INITIALIZER {NULL, NULL, {-1, NULL, NULL}, CLOCK_TIMER_INITIALIZER, 0}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja kreira epoll i eventfd petlje.
+ *
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t eventLoopInit(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zatvara petlju. Obavjestenja koja nisu obradjena se odbacuju.
+ *
+ *****************************************************************************/
+void eventLoopDeinit(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja obradjuje dogadjaje u niti pozivaoca dok se ne pozove
+ * eventLoopStop.
+ *
+ *****************************************************************************/
+void eventLoopRun(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja eventLoopRun nakon dogadjaja koji se obradjuje.
+ *
+ *****************************************************************************/
+void eventLoopStop(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja registruje fajl deskriptor.
+ *
+ * @param fd - [in] fajl deskriptor
+ * @param events - [in] dogadjaji koji se prate (EPOLLIN, ...)
+ * @param callback - [in] funkcija koja se poziva kada je deskriptor spreman
+ * @param arg - [in] argument funkcije
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t eventLoopAddFd(int32_t fd, uint32_t events, Event_Loop_Fd_Callback callback, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja uklanja fajl deskriptor iz petlje. Deskriptor ne zatvara.
+ *
+ * @param fd - [in] fajl deskriptor
+ *****************************************************************************/
+void eventLoopRemoveFd(int32_t fd);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja iz bilo koje niti zakazuje poziv funkcije u niti petlje.
+ *
+ * @param callback - [in] funkcija
+ * @param arg - [in] argument funkcije
+ * @return 0 ako nema greske, -1 ako je red pun
+ *****************************************************************************/
+int32_t eventLoopPost(Event_Loop_Callback callback, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pokrece jednokratni tajmer. Ako tajmer vec ceka, novi rok
+ * zamjenjuje stari.
+ *
+ * @param timer - [in/out] tajmer (EVENT_LOOP_TIMER_INITIALIZER)
+ * @param timeoutMs - [in] vrijeme do isteka u ms
+ * @param callback - [in] funkcija koja se poziva iz niti petlje
+ * @param arg - [in] argument funkcije
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t eventLoopTimerStart(EventLoopTimer* timer, uint32_t timeoutMs, Event_Loop_Callback callback, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja tajmer ako jos nije istekao.
+ *
+ * @param timer - [in/out] tajmer
+ *****************************************************************************/
+void eventLoopTimerStop(EventLoopTimer* timer);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja tajmer i oslobadja njegove resurse.
+ *
+ * @param timer - [in/out] tajmer
+ *****************************************************************************/
+void eventLoopTimerDelete(EventLoopTimer* timer);
+
+#endif
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file font_cache.c
+ * \brief
+ * Tekst se u kesu cuva na ARGB povrsini sa providnom pozadinom i kopira se
+ * na odrediste sa DSBLIT_BLEND_ALPHACHANNEL. Kljuc je visina fonta, boja i
+ * sam tekst; za izbacivanje se koristi brojac posljednje upotrebe.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "font_cache.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct _FontCacheFont
+{
+    int32_t height; // 0 ako je mjesto slobodno
+    int32_t ascender;
+    IDirectFBFont* font;
+} FontCacheFont;
+
+typedef struct _FontCacheText
+{
+    IDirectFBSurface* surface; // NULL ako je mjesto slobodno
+    int32_t height;
+    uint32_t color;
+    char text[FONT_CACHE_TEXT_SIZE];
+    int32_t ascender;
+    uint32_t lastUse;
+} FontCacheText;
+
+static IDirectFB* dfbInterface = NULL;
+static FontCacheFont fonts[FONT_CACHE_MAX_FONTS];
+static FontCacheText texts[FONT_CACHE_MAX_TEXTS];
+static uint32_t useCounter = 0;
+
+static FontCacheFont* fontCacheFind(int32_t height)
+{
+    DFBFontDescription fontDesc;
+    uint32_t i;
+    for (i = 0; i < FONT_CACHE_MAX_FONTS; i++)
+    {
+        if (fonts[i].height == height)
+            return &fonts[i];
+    }
+    for (i = 0; i < FONT_CACHE_MAX_FONTS; i++)
+    {
+        if (fonts[i].height == 0)
+            break;
+    }
+    if (dfbInterface == NULL || i == FONT_CACHE_MAX_FONTS)
+    {
+        printf("%s: ERROR no room for font of height %d\n", __FUNCTION__, height);
+        return NULL;
+    }
+    // the description has to be filled before CreateFont, not after it
+    memset(&fontDesc, 0, sizeof (fontDesc));
+    fontDesc.flags = DFDESC_HEIGHT;
+    fontDesc.height = height;
+    if (dfbInterface->CreateFont(dfbInterface, FONT_CACHE_PATH, &fontDesc, &(fonts[i].font)) != DFB_OK)
+    {
+        printf("%s: ERROR cannot load %s\n", __FUNCTION__, FONT_CACHE_PATH);
+        return NULL;
+    }
+    fonts[i].font->GetAscender(fonts[i].font, &(fonts[i].ascender));
+    fonts[i].height = height;
+    return &fonts[i];
+}
+
+int32_t fontCacheInit(IDirectFB* dfb, const int32_t* heights, uint32_t count)
+{
+    int32_t result = 0;
+    uint32_t i;
+    memset(fonts, 0, sizeof (fonts));
+    memset(texts, 0, sizeof (texts));
+    useCounter = 0;
+    dfbInterface = dfb;
+    for (i = 0; i < count; i++)
+    {
+        if (fontCacheFind(heights[i]) == NULL)
+            result = -1;
+    }
+    return result;
+}
+
+void fontCacheDeinit(void)
+{
+    uint32_t i;
+    for (i = 0; i < FONT_CACHE_MAX_TEXTS; i++)
+    {
+        if (texts[i].surface != NULL)
+        {
+            texts[i].surface->Release(texts[i].surface);
+            texts[i].surface = NULL;
+        }
+    }
+    for (i = 0; i < FONT_CACHE_MAX_FONTS; i++)
+    {
+        if (fonts[i].height != 0)
+        {
+            fonts[i].font->Release(fonts[i].font);
+            fonts[i].height = 0;
+        }
+    }
+    dfbInterface = NULL;
+}
+
+IDirectFBFont* fontCacheGet(int32_t height)
+{
+    FontCacheFont* font = fontCacheFind(height);
+    return (font != NULL) ? font->font : NULL;
+}
+
+/* renders the text once into its own surface, replacing the least recently used entry */
+static FontCacheText* fontCacheRender(FontCacheFont* font, const char* text, uint32_t color)
+{
+    DFBSurfaceDescription desc;
+    FontCacheText* entry = &texts[0];
+    int32_t width;
+    int32_t height;
+    uint32_t i;
+    for (i = 1; i < FONT_CACHE_MAX_TEXTS && entry->surface != NULL; i++)
+    {
+        if (texts[i].surface == NULL || texts[i].lastUse < entry->lastUse)
+            entry = &texts[i];
+    }
+    if (font->font->GetStringWidth(font->font, text, -1, &width) != DFB_OK || width <= 0)
+        return NULL;
+    font->font->GetHeight(font->font, &height);
+    if (entry->surface != NULL)
+    {
+        entry->surface->Release(entry->surface);
+        entry->surface = NULL;
+    }
+    memset(&desc, 0, sizeof (desc));
+    desc.flags = DSDESC_WIDTH | DSDESC_HEIGHT | DSDESC_PIXELFORMAT;
+    desc.width = width;
+    desc.height = height;
+    desc.pixelformat = DSPF_ARGB;
+    if (dfbInterface->CreateSurface(dfbInterface, &desc, &(entry->surface)) != DFB_OK)
+    {
+        entry->surface = NULL;
+        return NULL;
+    }
+    entry->surface->Clear(entry->surface, 0x00, 0x00, 0x00, 0x00);
+    entry->surface->SetFont(entry->surface, font->font);
+    entry->surface->SetColor(entry->surface, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, (color >> 24) & 0xFF);
+    entry->surface->DrawString(entry->surface, text, -1, 0, 0, DSTF_TOPLEFT);
+    entry->height = font->height;
+    entry->color = color;
+    entry->ascender = font->ascender;
+    strcpy(entry->text, text);
+    return entry;
+}
+
+int32_t fontCacheDrawText(IDirectFBSurface* surface, int32_t height, const char* text, int32_t x, int32_t y, uint32_t color)
+{
+    FontCacheFont* font = fontCacheFind(height);
+    FontCacheText* entry = NULL;
+    uint32_t i;
+    if (font == NULL)
+        return -1;
+    for (i = 0; i < FONT_CACHE_MAX_TEXTS; i++)
+    {
+        if (texts[i].surface != NULL && texts[i].height == height && texts[i].color == color &&
+                strcmp(texts[i].text, text) == 0)
+        {
+            entry = &texts[i];
+            break;
+        }
+    }
+    if (entry == NULL && strlen(text) < FONT_CACHE_TEXT_SIZE)
+        entry = fontCacheRender(font, text, color);
+    if (entry == NULL)
+    {
+        // too long to be worth caching, or the surface could not be created
+        surface->SetFont(surface, font->font);
+        surface->SetColor(surface, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, (color >> 24) & 0xFF);
+        return (surface->DrawString(surface, text, -1, x, y, DSTF_LEFT) == DFB_OK) ? 0 : -1;
+    }
+    entry->lastUse = ++useCounter;
+    surface->SetBlittingFlags(surface, DSBLIT_BLEND_ALPHACHANNEL);
+    return (surface->Blit(surface, entry->surface, NULL, x, y - entry->ascender) == DFB_OK) ? 0 : -1;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file font_cache.h
+ * \brief
+ * Ovaj modul cuva fontove OSD-a, po jedan za svaku velicinu, i povrsine sa
+ * vec iscrtanim tekstovima koji se ponavljaju (broj i naziv programa, PID-ovi,
+ * "TXT"). Font se ucitava i rasterizuje samo jednom, a tekst iz kesa se na
+ * ekran prenosi jednim Blit pozivom. Kes tekstova ima ogranicen broj mjesta i
+ * izbacuje tekst koji najduze nije koriscen.
+ *
+ * Modul nema zakljucavanja, poziva se samo iz niti koja iscrtava OSD.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef FONT_CACHE_H
+#define FONT_CACHE_H
+
+#include <stdint.h>
+#include <directfb.h>
+
+#define FONT_CACHE_PATH "/home/galois/fonts/DejaVuSans.ttf"
+/* broj razlicitih velicina fonta */
+#define FONT_CACHE_MAX_FONTS 4
+/* broj iscrtanih tekstova koji se cuvaju */
+#define FONT_CACHE_MAX_TEXTS 32
+/* duzi tekstovi se iscrtavaju direktno, bez kesa */
+#define FONT_CACHE_TEXT_SIZE 64
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pamti DirectFB interfejs i ucitava fontove zadatih velicina.
+ *
+ * @param dfb - [in] DirectFB interfejs
+ * @param heights - [in] velicine fontova koje se ucitavaju odmah
+ * @param count - [in] broj velicina
+ * @return 0 ako nema greske, -1 ako neki font nije ucitan
+ *****************************************************************************/
+int32_t fontCacheInit(IDirectFB* dfb, const int32_t* heights, uint32_t count);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja sve fontove i povrsine sa tekstovima.
+ *
+ *****************************************************************************/
+void fontCacheDeinit(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca font zadate velicine i ucitava ga ako ga nema u kesu.
+ *
+ * @param height - [in] visina fonta u pikselima
+ * @return font, NULL ako font nije moguce ucitati
+ *****************************************************************************/
+IDirectFBFont* fontCacheGet(int32_t height);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja iscrtava tekst na povrsinu. Tekst se prvi put iscrtava u
+ * posebnu povrsinu, a zatim se ta povrsina samo kopira (Blit).
+ *
+ * @param surface - [in] povrsina na koju se iscrtava
+ * @param height - [in] visina fonta u pikselima
+ * @param text - [in] tekst
+ * @param x - [in] x koordinata lijeve ivice teksta
+ * @param y - [in] y koordinata osnovne linije teksta (kao DSTF_LEFT)
+ * @param color - [in] boja teksta u ARGB formatu
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t fontCacheDrawText(IDirectFBSurface* surface, int32_t height, const char* text, int32_t x, int32_t y, uint32_t color);
+
+#endif
@@ -25,23 +25,33 @@
 #include <stdint.h>
 #include "remote.h"
 #include "drawing.h"
+#include "dfb_check.h"
 #include "table_parser.h"
 #include "remote.h"
 #include "config_parser.h"
 #include "device_control.h"
+#include "event_loop.h"
 
 int32_t main(int32_t argc, char** argv)
 {
     DeviceHandle handle;
     config_parameters parms;
     DFBCHECK(DirectFBInit(&argc, &argv));
+    // the OSD timer of initDirectFB/deviceInit lives in the event loop
+    if (eventLoopInit() != 0)
+    {
+        return ERROR;
+    }
     initDirectFB();
+    // keys missing from the configuration keep these values
+    initDefaultValues(&parms);
     if (argc == 2)
     {
         if (parseConfig(&parms, argv[1]) == ERROR)
         {
             printf("%s : ERROR while parsing configuration\n", __FUNCTION__);
             deinitDirectFB();
+            eventLoopDeinit();
             return ERROR;
         }
     }
@@ -51,27 +61,34 @@ int32_t main(int32_t argc, char** argv)
         {
             printf("%s : ERROR while parsing configuration\n", __FUNCTION__);
             deinitDirectFB();
+            eventLoopDeinit();
             return ERROR;
         }
     }
  //   dumpConfig(&parms);
-    pthread_t remote_thread;
     if (deviceInit(&parms, &handle) == ERROR)
     {
         printf("%s : ERROR while init \n", __FUNCTION__);
         deinitDirectFB();
         deviceDeInit(&handle);
+        eventLoopDeinit();
         return ERROR;
     }
 
     registerServiceNumberRemoteCallBack(remoteServiceCallback);
     registerVolumeRemoteCallback(remoteVolumeCallback);
     registerInfoButtonCallback(remoteInfoCallback);
-    pthread_create(&remote_thread, NULL, &remoteControlThread, NULL);
-
-    pthread_join(remote_thread, NULL);
+    registerServiceSkipRemoteCallback(remoteServiceSkipCallback);
+    remoteSetServiceNumber(deviceGetServiceNumber());
+    // remote keys, OSD timers and device notifications are all handled on this thread
+    if (remoteInit() == NO_ERROR)
+    {
+        eventLoopRun();
+        remoteDeinit();
+    }
 
     deviceDeInit(&handle);
     deinitDirectFB();
+    eventLoopDeinit();
     return 0;
 }
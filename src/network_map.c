@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file network_map.c
+ * \brief
+ * Ovaj modul cuva mapu mreze iz NIT tabele. Kanal pamti indeks multipleksa,
+ * a ne frekvenciju, tako da promjena terrestrial_delivery_system deskriptora
+ * ne zahtijeva prolaz kroz sve kanale.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "network_map.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+typedef struct _NetworkMapChannel
+{
+    uint8_t valid;
+    uint8_t section_number;
+    uint8_t version_number;
+    uint8_t multiplex; // indeks u nizu multiplexes
+    uint16_t service_id;
+    uint8_t service_type;
+    uint8_t visible_service_flag;
+} NetworkMapChannel;
+
+static NetworkMapChannel channels[NETWORK_MAP_MAX_LCN];
+static NetworkMultiplex multiplexes[NETWORK_MAP_MAX_MULTIPLEXES];
+static uint32_t multiplexCount = 0;
+static pthread_mutex_t networkMapMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi multipleks po (original_network_id,
+ * transport_stream_id), ili ga dodaje ako ne postoji. Poziva se sa
+ * zakljucanim networkMapMutex.
+ *
+ * @return indeks multipleksa, -1 ako je niz multipleksa pun
+ *****************************************************************************/
+static int32_t networkMapMultiplex(const NitTransportStream* ts)
+{
+    uint32_t i;
+    for (i = 0; i < multiplexCount; i++)
+    {
+        if (multiplexes[i].transport_stream_id == ts->transport_stream_id &&
+                multiplexes[i].original_network_id == ts->original_network_id)
+            break;
+    }
+    if (i == multiplexCount)
+    {
+        if (multiplexCount >= NETWORK_MAP_MAX_MULTIPLEXES)
+            return -1;
+        memset(&multiplexes[i], 0, sizeof (NetworkMultiplex));
+        multiplexes[i].transport_stream_id = ts->transport_stream_id;
+        multiplexes[i].original_network_id = ts->original_network_id;
+        multiplexCount++;
+    }
+    if (ts->hasTerrestrialDelivery)
+    {
+        multiplexes[i].frequency = ts->terrestrialDelivery.centre_frequency;
+        multiplexes[i].bandwidth = ts->terrestrialDelivery.bandwidth;
+    }
+    return (int32_t) i;
+}
+
+void networkMapReset(void)
+{
+    pthread_mutex_lock(&networkMapMutex);
+    memset(channels, 0, sizeof (channels));
+    memset(multiplexes, 0, sizeof (multiplexes));
+    multiplexCount = 0;
+    pthread_mutex_unlock(&networkMapMutex);
+}
+
+int32_t networkMapUpdate(const NitTable* table)
+{
+    const NitTransportStream* ts;
+    const NitService* service;
+    NetworkMapChannel* channel;
+    int32_t multiplex;
+    int32_t result = 0;
+    uint32_t i;
+    uint32_t j;
+    if (table->header.table_id != NIT_ACTUAL_TABLE_ID || !table->header.current_next_indicator)
+        return -1;
+
+    pthread_mutex_lock(&networkMapMutex);
+    for (i = 0; i < table->transportStreamCount; i++)
+    {
+        ts = &(table->transportStreams[i]);
+        multiplex = networkMapMultiplex(ts);
+        if (multiplex < 0)
+        {
+            result = -1;
+            continue;
+        }
+        for (j = 0; j < ts->serviceCount; j++)
+        {
+            service = &(ts->services[j]);
+            if (service->logical_channel_number == 0)
+                continue;
+            channel = &(channels[service->logical_channel_number]);
+            // a visible service keeps its LCN against a hidden duplicate from the same version
+            if (channel->valid && channel->visible_service_flag && !service->visible_service_flag &&
+                    channel->version_number == table->header.version_number)
+                continue;
+            channel->valid = 1;
+            channel->section_number = table->header.section_number;
+            channel->version_number = table->header.version_number;
+            channel->multiplex = (uint8_t) multiplex;
+            channel->service_id = service->service_id;
+            channel->service_type = service->service_type;
+            channel->visible_service_flag = service->visible_service_flag;
+        }
+    }
+    // LCNs carried by an older version of this section are gone
+    for (i = 0; i < NETWORK_MAP_MAX_LCN; i++)
+    {
+        if (channels[i].valid && channels[i].section_number == table->header.section_number &&
+                channels[i].version_number != table->header.version_number)
+        {
+            channels[i].valid = 0;
+        }
+    }
+    pthread_mutex_unlock(&networkMapMutex);
+    return result;
+}
+
+int32_t networkMapLookupLcn(uint16_t lcn, NetworkChannel* channel)
+{
+    const NetworkMapChannel* entry;
+    if (lcn >= NETWORK_MAP_MAX_LCN)
+        return -1;
+    pthread_mutex_lock(&networkMapMutex);
+    entry = &(channels[lcn]);
+    if (!entry->valid)
+    {
+        pthread_mutex_unlock(&networkMapMutex);
+        return -1;
+    }
+    channel->logical_channel_number = lcn;
+    channel->service_id = entry->service_id;
+    channel->service_type = entry->service_type;
+    channel->visible_service_flag = entry->visible_service_flag;
+    channel->multiplex = multiplexes[entry->multiplex];
+    pthread_mutex_unlock(&networkMapMutex);
+    return 0;
+}
+
+uint32_t networkMapGetMultiplexes(NetworkMultiplex* out, uint32_t maxMultiplexes)
+{
+    uint32_t count;
+    pthread_mutex_lock(&networkMapMutex);
+    count = (multiplexCount < maxMultiplexes) ? multiplexCount : maxMultiplexes;
+    memcpy(out, multiplexes, count * sizeof (NetworkMultiplex));
+    pthread_mutex_unlock(&networkMapMutex);
+    return count;
+}
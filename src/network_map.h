@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file network_map.h
+ * \brief
+ * Ovaj modul cuva mapu mreze iz NIT tabele: multiplekse (transportne tokove)
+ * sa frekvencijom i sirinom kanala, i logicke brojeve kanala (LCN). LCN se
+ * direktno koristi kao indeks u tabeli, pa je pronalazenje frekvencije i
+ * service_id za dati LCN O(1).
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef NETWORK_MAP_H
+#define NETWORK_MAP_H
+
+#include <stdint.h>
+#include "table_parser.h"
+
+/* LCN je 10-bitno polje */
+#define NETWORK_MAP_MAX_LCN 1024
+#define NETWORK_MAP_MAX_MULTIPLEXES 16
+
+typedef struct _NetworkMultiplex
+{
+    uint16_t transport_stream_id;
+    uint16_t original_network_id;
+    uint32_t frequency; // Hz, 0 ako NIT ne nosi terrestrial_delivery_system deskriptor
+    uint8_t bandwidth; // MHz
+} NetworkMultiplex;
+
+typedef struct _NetworkChannel
+{
+    uint16_t logical_channel_number;
+    uint16_t service_id;
+    uint8_t service_type;
+    uint8_t visible_service_flag;
+    NetworkMultiplex multiplex;
+} NetworkChannel;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sadrzaj mape mreze.
+ *
+ *****************************************************************************/
+void networkMapReset(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje NIT actual sekciju u mapu mreze. LCN-ovi koje je
+ * ista sekcija nosila u prethodnoj verziji, a kojih nema u novoj, se brisu.
+ *
+ * @param table - [in] parsirana NIT sekcija (table_id 0x40)
+ * @return 0 ako nema greske, -1 ako sekcija nije NIT actual ili je mapa puna
+ *****************************************************************************/
+int32_t networkMapUpdate(const NitTable* table);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi kanal po logickom broju kanala.
+ *
+ * @param lcn - [in] logicki broj kanala
+ * @param channel - [out] servis i multipleks kanala
+ * @return 0 ako kanal postoji, -1 u suprotnom
+ *****************************************************************************/
+int32_t networkMapLookupLcn(uint16_t lcn, NetworkChannel* channel);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca multiplekse mreze.
+ *
+ * @param multiplexes - [out] niz za multiplekse
+ * @param maxMultiplexes - [in] velicina niza
+ * @return broj upisanih multipleksa
+ *****************************************************************************/
+uint32_t networkMapGetMultiplexes(NetworkMultiplex* multiplexes, uint32_t maxMultiplexes);
+
+#endif
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file now_next.c
+ * \brief
+ * Ovaj modul cuva trenutni i sljedeci dogadjaj (EIT present/following) za
+ * svaki servis, indeksirano po service_id. Servisi se smjestaju u hes tabelu
+ * sa linearnim probanjem, tako da je pristup O(1) bez alokacije memorije.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "now_next.h"
+#include "service_slot.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#define NOW_NEXT_SLOTS SERVICE_SLOT_COUNT(NOW_NEXT_MAX_SERVICES)
+
+typedef struct _NowNextEntry
+{
+    ServiceSlotKey key;
+    NowNextEvent events[2];
+} NowNextEntry;
+
+static NowNextEntry entries[NOW_NEXT_SLOTS];
+static uint32_t entryCount = 0;
+static pthread_mutex_t nowNextMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi ulaz servisa, ili prazan ulaz u koji servis treba
+ * upisati. Poziva se sa zakljucanim nowNextMutex.
+ *
+ * @param service_id - [in] service_id
+ * @return pokazivac na ulaz, NULL ako je tabela puna
+ *****************************************************************************/
+static NowNextEntry* nowNextFind(uint16_t service_id)
+{
+    int32_t slot = serviceSlotFind(&(entries[0].key), sizeof (entries[0]), NOW_NEXT_SLOTS, service_id);
+    return (slot < 0) ? NULL : &entries[slot];
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja popunjava dogadjaj skladista iz parsiranog EIT dogadjaja.
+ *
+ * @param dst - [out] dogadjaj u skladistu
+ * @param src - [in] parsirani EIT dogadjaj
+ *****************************************************************************/
+static void nowNextFill(NowNextEvent* dst, const EitEvents* src)
+{
+    uint32_t used = 0;
+    uint8_t i;
+    dst->valid = 1;
+    dst->running_status = src->running_status;
+    dst->event_id = src->event_id;
+    dst->start_time = dvbTimeToEpoch(src->start_time);
+    dst->duration = dvbDurationToSeconds(src->durration);
+    dst->language[0] = '\0';
+    dst->name[0] = '\0';
+    dst->text[0] = '\0';
+    if (src->hasShortEvent)
+    {
+        memcpy(dst->language, src->shortEvent.language_code, 3);
+        dst->language[3] = '\0';
+        dvbStringCopy(dst->name, sizeof (dst->name), src->shortEvent.event_name, src->shortEvent.event_name_length);
+        used = dvbStringCopy(dst->text, sizeof (dst->text), src->shortEvent.text, src->shortEvent.text_length);
+    }
+    for (i = 0; i < src->extendedEventCount && used + 1 < sizeof (dst->text); i++)
+    {
+        used += dvbStringCopy(dst->text + used, sizeof (dst->text) - used, src->extendedEvents[i].text, src->extendedEvents[i].text_length);
+    }
+}
+
+void nowNextReset(void)
+{
+    pthread_mutex_lock(&nowNextMutex);
+    memset(entries, 0, sizeof (entries));
+    entryCount = 0;
+    pthread_mutex_unlock(&nowNextMutex);
+}
+
+int32_t nowNextUpdate(const EitTable* table)
+{
+    NowNextEntry* entry;
+    NowNextEvent* event;
+    if (table->header.table_id != EIT_PF_ACTUAL_TABLE_ID && table->header.table_id != EIT_PF_OTHER_TABLE_ID)
+        return -1;
+    if (table->header.section_number > NOW_NEXT_FOLLOWING || !table->header.current_next_indicator)
+        return -1;
+
+    pthread_mutex_lock(&nowNextMutex);
+    entry = nowNextFind(table->header.service_id);
+    if (entry == NULL || (!entry->key.used && entryCount >= NOW_NEXT_MAX_SERVICES))
+    {
+        pthread_mutex_unlock(&nowNextMutex);
+        return -1;
+    }
+    if (!entry->key.used)
+    {
+        entry->key.used = 1;
+        entry->key.service_id = table->header.service_id;
+        entryCount++;
+    }
+    event = &(entry->events[table->header.section_number]);
+    if (table->eventCount > 0)
+        nowNextFill(event, &(table->events[0]));
+    else
+        event->valid = 0;
+    pthread_mutex_unlock(&nowNextMutex);
+    return 0;
+}
+
+int32_t nowNextGet(uint16_t service_id, NowNextEvent* present, NowNextEvent* following)
+{
+    NowNextEntry* entry;
+    pthread_mutex_lock(&nowNextMutex);
+    entry = nowNextFind(service_id);
+    if (entry == NULL || !entry->key.used)
+    {
+        pthread_mutex_unlock(&nowNextMutex);
+        if (present != NULL)
+            present->valid = 0;
+        if (following != NULL)
+            following->valid = 0;
+        return -1;
+    }
+    if (present != NULL)
+        *present = entry->events[NOW_NEXT_PRESENT];
+    if (following != NULL)
+        *following = entry->events[NOW_NEXT_FOLLOWING];
+    pthread_mutex_unlock(&nowNextMutex);
+    return 0;
+}
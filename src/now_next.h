@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file now_next.h
+ * \brief
+ * Ovaj modul cuva trenutni i sljedeci dogadjaj (EIT present/following) za
+ * svaki servis, indeksirano po service_id. Skladiste se puni u pozadini iz
+ * EIT callback funkcije, a citanje je moguce iz bilo koje niti.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef NOW_NEXT_H
+#define NOW_NEXT_H
+
+#include <stdint.h>
+#include "table_parser.h"
+
+#define NOW_NEXT_MAX_SERVICES 64
+#define NOW_NEXT_NAME_SIZE 64
+#define NOW_NEXT_TEXT_SIZE 256
+
+typedef enum
+{
+    NOW_NEXT_PRESENT = 0,
+    NOW_NEXT_FOLLOWING = 1
+} NowNextSlot;
+
+typedef struct _NowNextEvent
+{
+    uint8_t valid;
+    uint8_t running_status;
+    uint16_t event_id;
+    uint32_t start_time; // sekunde od 1.1.1970 (UTC), 0 ako nije definisano
+    uint32_t duration; // sekunde
+    char language[4];
+    char name[NOW_NEXT_NAME_SIZE];
+    char text[NOW_NEXT_TEXT_SIZE]; // short_event tekst, pa tekst extended_event deskriptora
+} NowNextEvent;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sadrzaj skladista (npr. prilikom promjene multipleksa).
+ *
+ *****************************************************************************/
+void nowNextReset(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje EIT present/following sekciju u skladiste. Sekcija 0
+ * nosi trenutni, a sekcija 1 sljedeci dogadjaj; prazna sekcija brise dogadjaj.
+ *
+ * @param table - [in] parsirana EIT p/f sekcija (table_id 0x4E ili 0x4F)
+ * @return 0 ako nema greske, -1 ako sekcija nije p/f ili je skladiste puno
+ *****************************************************************************/
+int32_t nowNextUpdate(const EitTable* table);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita trenutni i sljedeci dogadjaj servisa.
+ *
+ * @param service_id - [in] service_id (program_number iz PAT/PMT)
+ * @param present - [out] trenutni dogadjaj (moze biti NULL)
+ * @param following - [out] sljedeci dogadjaj (moze biti NULL)
+ * @return 0 ako servis postoji u skladistu, -1 u suprotnom
+ *****************************************************************************/
+int32_t nowNextGet(uint16_t service_id, NowNextEvent* present, NowNextEvent* following);
+
+#endif
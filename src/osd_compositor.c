@@ -0,0 +1,179 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file osd_compositor.c
+ * \brief
+ * Pravougaonici koji se preklapaju spajaju se u jedan, tako da se nijedan
+ * piksel ne iscrtava dva puta. Kada lista pravougaonika napuni, novi se spaja
+ * sa onim cija se povrsina spajanjem najmanje poveca.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "osd_compositor.h"
+#include <stdint.h>
+#include <string.h>
+
+typedef struct _OsdWidgetState
+{
+    uint8_t visible;
+    OsdRect rect;
+    Osd_Draw_Callback draw;
+    void* arg;
+} OsdWidgetState;
+
+static OsdRect screen;
+static Osd_Backdrop_Callback backdropCallback = NULL;
+static Osd_Present_Callback presentCallback = NULL;
+static uint8_t backdropOpaque = 0;
+static OsdWidgetState widgets[OSD_WIDGET_COUNT];
+static OsdRect dirty[OSD_MAX_DIRTY_RECTS];
+static uint32_t dirtyCount = 0;
+
+static uint8_t osdIntersect(const OsdRect* a, const OsdRect* b, OsdRect* result)
+{
+    int32_t x1 = (a->x > b->x) ? a->x : b->x;
+    int32_t y1 = (a->y > b->y) ? a->y : b->y;
+    int32_t x2 = (a->x + a->w < b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int32_t y2 = (a->y + a->h < b->y + b->h) ? a->y + a->h : b->y + b->h;
+    if (x2 <= x1 || y2 <= y1)
+        return 0;
+    result->x = x1;
+    result->y = y1;
+    result->w = x2 - x1;
+    result->h = y2 - y1;
+    return 1;
+}
+
+static void osdUnion(const OsdRect* a, const OsdRect* b, OsdRect* result)
+{
+    int32_t x1 = (a->x < b->x) ? a->x : b->x;
+    int32_t y1 = (a->y < b->y) ? a->y : b->y;
+    int32_t x2 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int32_t y2 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    result->x = x1;
+    result->y = y1;
+    result->w = x2 - x1;
+    result->h = y2 - y1;
+}
+
+void osdCompositorInit(int32_t width, int32_t height, Osd_Backdrop_Callback drawBackdrop, Osd_Present_Callback present)
+{
+    screen.x = 0;
+    screen.y = 0;
+    screen.w = width;
+    screen.h = height;
+    backdropCallback = drawBackdrop;
+    presentCallback = present;
+    backdropOpaque = 0;
+    memset(widgets, 0, sizeof (widgets));
+    dirtyCount = 0;
+    // the contents of both buffers are unknown at startup
+    osdInvalidate(&screen);
+}
+
+void osdSetBackdrop(uint8_t opaque)
+{
+    opaque = (opaque != 0);
+    if (opaque == backdropOpaque)
+        return;
+    backdropOpaque = opaque;
+    osdInvalidate(&screen);
+}
+
+void osdShowWidget(OsdWidget widget, const OsdRect* rect, Osd_Draw_Callback draw, void* arg)
+{
+    if (widget >= OSD_WIDGET_COUNT)
+        return;
+    if (widgets[widget].visible)
+        osdInvalidate(&(widgets[widget].rect));
+    widgets[widget].visible = 1;
+    widgets[widget].rect = *rect;
+    widgets[widget].draw = draw;
+    widgets[widget].arg = arg;
+    osdInvalidate(rect);
+}
+
+void osdHideWidget(OsdWidget widget)
+{
+    if (widget >= OSD_WIDGET_COUNT || !widgets[widget].visible)
+        return;
+    widgets[widget].visible = 0;
+    osdInvalidate(&(widgets[widget].rect));
+}
+
+void osdInvalidate(const OsdRect* rect)
+{
+    OsdRect area;
+    OsdRect merged;
+    OsdRect overlap;
+    uint64_t bestGrowth = UINT64_MAX;
+    uint64_t growth;
+    uint32_t best = 0;
+    uint32_t i = 0;
+    if (!osdIntersect(rect, &screen, &area))
+        return;
+    while (i < dirtyCount)
+    {
+        if (osdIntersect(&dirty[i], &area, &overlap))
+        {
+            osdUnion(&dirty[i], &area, &area);
+            dirty[i] = dirty[--dirtyCount];
+            // the grown rectangle may now overlap one that was already checked
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    if (dirtyCount < OSD_MAX_DIRTY_RECTS)
+    {
+        dirty[dirtyCount++] = area;
+        return;
+    }
+    for (i = 0; i < dirtyCount; i++)
+    {
+        osdUnion(&dirty[i], &area, &merged);
+        growth = (uint64_t) merged.w * (uint64_t) merged.h - (uint64_t) dirty[i].w * (uint64_t) dirty[i].h;
+        if (growth < bestGrowth)
+        {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    osdUnion(&dirty[best], &area, &merged);
+    dirty[best] = dirty[--dirtyCount];
+    osdInvalidate(&merged);
+}
+
+uint32_t osdCompose(void)
+{
+    OsdRect clip;
+    uint32_t count = dirtyCount;
+    uint32_t i;
+    uint32_t w;
+    if (count == 0)
+        return 0;
+    for (i = 0; i < count; i++)
+    {
+        backdropCallback(&dirty[i], backdropOpaque);
+        for (w = 0; w < OSD_WIDGET_COUNT; w++)
+        {
+            if (widgets[w].visible && osdIntersect(&(widgets[w].rect), &dirty[i], &clip))
+                widgets[w].draw(&clip, widgets[w].arg);
+        }
+    }
+    presentCallback(dirty, count);
+    dirtyCount = 0;
+    return count;
+}
@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file osd_compositor.h
+ * \brief
+ * Ovaj modul slaze OSD od pozadine (providna ili plava kada program nema
+ * video) i widgeta (informacije o programu, jacina zvuka). Za svaku promjenu
+ * pamti se pravougaonik koji je postao nevazeci, pa osdCompose ponovo
+ * iscrtava i prikazuje samo te pravougaonike umjesto cijelog ekrana.
+ *
+ * Modul ne zavisi od DirectFB-a: iscrtavanje i prikaz (Flip) radi drawing.c
+ * kroz funkcije koje se proslijede pri inicijalizaciji. Nema zakljucavanja,
+ * poziva se samo iz niti koja iscrtava OSD.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef OSD_COMPOSITOR_H
+#define OSD_COMPOSITOR_H
+
+#include <stdint.h>
+
+/* najveci broj odvojenih pravougaonika, visak se spaja u najblizi */
+#define OSD_MAX_DIRTY_RECTS 4
+
+typedef struct _OsdRect
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+} OsdRect;
+
+typedef enum
+{
+    OSD_WIDGET_BANNER = 0, // informacije o programu
+    OSD_WIDGET_VOLUME, // jacina zvuka
+    OSD_WIDGET_COUNT
+} OsdWidget;
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja iscrtava widget unutar pravougaonika.
+ * Sve sto se iscrta van pravougaonika clip mora biti odsjeceno.
+ *
+ * @param clip - [in] pravougaonik koji se iscrtava
+ * @param arg - [in] pokazivac proslijedjen pri registraciji
+ *****************************************************************************/
+typedef void(*Osd_Draw_Callback)(const OsdRect* clip, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja iscrtava pozadinu unutar pravougaonika.
+ *
+ * @param clip - [in] pravougaonik koji se iscrtava
+ * @param opaque - [in] 1 za neprovidnu pozadinu (program bez videa)
+ *****************************************************************************/
+typedef void(*Osd_Backdrop_Callback)(const OsdRect* clip, uint8_t opaque);
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije koja prikazuje iscrtane pravougaonike (Flip po regionima).
+ *
+ * @param rects - [in] pravougaonici
+ * @param count - [in] broj pravougaonika
+ *****************************************************************************/
+typedef void(*Osd_Present_Callback)(const OsdRect* rects, uint32_t count);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja postavlja velicinu ekrana i funkcije za iscrtavanje pozadine
+ * i prikaz. Cijeli ekran se oznacava kao nevazeci.
+ *
+ * @param width - [in] sirina ekrana
+ * @param height - [in] visina ekrana
+ * @param drawBackdrop - [in] funkcija koja iscrtava pozadinu
+ * @param present - [in] funkcija koja prikazuje pravougaonike
+ *****************************************************************************/
+void osdCompositorInit(int32_t width, int32_t height, Osd_Backdrop_Callback drawBackdrop, Osd_Present_Callback present);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja bira providnu ili neprovidnu pozadinu. Promjena oznacava
+ * cijeli ekran kao nevazeci.
+ *
+ * @param opaque - [in] 1 ako program nema video
+ *****************************************************************************/
+void osdSetBackdrop(uint8_t opaque);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja prikazuje ili mijenja widget. Stari i novi polozaj widgeta
+ * postaju nevazeci.
+ *
+ * @param widget - [in] widget
+ * @param rect - [in] polozaj i velicina widgeta
+ * @param draw - [in] funkcija koja iscrtava widget
+ * @param arg - [in] argument funkcije
+ *****************************************************************************/
+void osdShowWidget(OsdWidget widget, const OsdRect* rect, Osd_Draw_Callback draw, void* arg);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja sakriva widget. Njegov polozaj postaje nevazeci.
+ *
+ * @param widget - [in] widget
+ *****************************************************************************/
+void osdHideWidget(OsdWidget widget);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oznacava pravougaonik kao nevazeci.
+ *
+ * @param rect - [in] pravougaonik
+ *****************************************************************************/
+void osdInvalidate(const OsdRect* rect);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ponovo iscrtava nevazece pravougaonike (pozadina pa vidljivi
+ * widgeti redom) i prikazuje ih.
+ *
+ * @return broj prikazanih pravougaonika
+ *****************************************************************************/
+uint32_t osdCompose(void);
+
+#endif
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file pid_router.c
+ * \brief
+ * Ovaj modul realizuje tabelu usmjeravanja po PID-u. Prosljedjivanje drzi
+ * citacku bravu, tako da se vise niti moze prosljedjivati istovremeno, a
+ * pretplata i ukidanje pretplate uzimaju bravu za pisanje.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "pid_router.h"
+#include <stdint.h>
+#include <string.h>
+
+void pidRouterInit(PidRouter* router)
+{
+    int16_t i;
+    memset(router->wanted, 0, sizeof (router->wanted));
+    for (i = 0; i < TS_NUM_OF_PIDS; i++)
+    {
+        router->first[i] = PID_ROUTER_NO_ROUTE;
+    }
+    for (i = 0; i < PID_ROUTER_MAX_ROUTES; i++)
+    {
+        router->routes[i].handler = NULL;
+        router->routes[i].context = NULL;
+        router->routes[i].next = (int16_t) ((i + 1 < PID_ROUTER_MAX_ROUTES) ? i + 1 : PID_ROUTER_NO_ROUTE);
+    }
+    router->freeRoute = 0;
+    pthread_rwlock_init(&(router->lock), NULL);
+}
+
+void pidRouterDestroy(PidRouter* router)
+{
+    pthread_rwlock_destroy(&(router->lock));
+}
+
+int32_t pidRouterSubscribe(PidRouter* router, uint16_t pid, Pid_Route_Handler handler, void* context)
+{
+    int16_t i;
+    if (pid >= TS_NUM_OF_PIDS || handler == NULL)
+        return -1;
+    pthread_rwlock_wrlock(&(router->lock));
+    for (i = router->first[pid]; i != PID_ROUTER_NO_ROUTE; i = router->routes[i].next)
+    {
+        if (router->routes[i].handler == handler && router->routes[i].context == context)
+        {
+            pthread_rwlock_unlock(&(router->lock));
+            return 0;
+        }
+    }
+    i = router->freeRoute;
+    if (i == PID_ROUTER_NO_ROUTE)
+    {
+        pthread_rwlock_unlock(&(router->lock));
+        return -1;
+    }
+    router->freeRoute = router->routes[i].next;
+    router->routes[i].handler = handler;
+    router->routes[i].context = context;
+    router->routes[i].next = router->first[pid];
+    router->first[pid] = i;
+    router->wanted[pid >> 5] |= 1u << (pid & 31);
+    pthread_rwlock_unlock(&(router->lock));
+    return 0;
+}
+
+void pidRouterUnsubscribe(PidRouter* router, uint16_t pid, Pid_Route_Handler handler, void* context)
+{
+    int16_t* link;
+    int16_t i;
+    if (pid >= TS_NUM_OF_PIDS)
+        return;
+    pthread_rwlock_wrlock(&(router->lock));
+    for (link = &(router->first[pid]); *link != PID_ROUTER_NO_ROUTE; link = &(router->routes[*link].next))
+    {
+        i = *link;
+        if (router->routes[i].handler == handler && router->routes[i].context == context)
+        {
+            *link = router->routes[i].next;
+            router->routes[i].handler = NULL;
+            router->routes[i].context = NULL;
+            router->routes[i].next = router->freeRoute;
+            router->freeRoute = i;
+            break;
+        }
+    }
+    if (router->first[pid] == PID_ROUTER_NO_ROUTE)
+        router->wanted[pid >> 5] &= ~(1u << (pid & 31));
+    pthread_rwlock_unlock(&(router->lock));
+}
+
+uint32_t pidRouterDispatch(PidRouter* router, uint16_t pid, const uint8_t* data, uint32_t length)
+{
+    uint32_t count = 0;
+    int16_t i;
+    if (pid >= TS_NUM_OF_PIDS || !pidRouterWanted(router, pid))
+        return 0;
+    pthread_rwlock_rdlock(&(router->lock));
+    for (i = router->first[pid]; i != PID_ROUTER_NO_ROUTE; i = router->routes[i].next)
+    {
+        router->routes[i].handler(pid, data, length, router->routes[i].context);
+        count++;
+    }
+    pthread_rwlock_unlock(&(router->lock));
+    return count;
+}
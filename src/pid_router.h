@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file pid_router.h
+ * \brief
+ * Ovaj modul realizuje tabelu usmjeravanja po PID-u za svih 8192 PID-ova.
+ * Bit mapa oznacava trazene PID-ove, a za svaki PID se cuva indeks prvog
+ * pretplatnika, tako da se paket ili sekcija proslijedi jednim indeksiranim
+ * citanjem. Na isti PID moze biti pretplaceno vise korisnika (parseri,
+ * snimanje, mjerenje protoka).
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef PID_ROUTER_H
+#define PID_ROUTER_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "section_assembler.h"
+
+/* ukupan broj pretplata na svim PID-ovima */
+#define PID_ROUTER_MAX_ROUTES 64
+#define PID_ROUTER_NO_ROUTE -1
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip funkcije pretplatnika. Bafer je validan samo za vrijeme trajanja poziva.
+ *
+ * @param pid - [in] PID paketa ili sekcije
+ * @param data - [in] paket ili sekcija
+ * @param length - [in] duzina u bajtovima
+ * @param context - [in] pokazivac proslijedjen pri pretplati
+ * @return 0 ako nema greske
+ *****************************************************************************/
+typedef int32_t(*Pid_Route_Handler)(uint16_t pid, const uint8_t* data, uint32_t length, void* context);
+
+typedef struct _PidRoute
+{
+    Pid_Route_Handler handler;
+    void* context;
+    int16_t next; // sljedeca pretplata na istom PID-u, PID_ROUTER_NO_ROUTE na kraju
+} PidRoute;
+
+typedef struct _PidRouter
+{
+    uint32_t wanted[TS_NUM_OF_PIDS / 32];
+    int16_t first[TS_NUM_OF_PIDS];
+    PidRoute routes[PID_ROUTER_MAX_ROUTES];
+    int16_t freeRoute; // lista slobodnih pretplata, povezana preko next
+    pthread_rwlock_t lock;
+} PidRouter;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje tabelu bez ijedne pretplate.
+ *
+ * @param router - [out] tabela usmjeravanja
+ *****************************************************************************/
+void pidRouterInit(PidRouter* router);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja resurse tabele usmjeravanja.
+ *
+ * @param router - [in] tabela usmjeravanja
+ *****************************************************************************/
+void pidRouterDestroy(PidRouter* router);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pretplacuje funkciju na PID. Ponovljena pretplata sa istom
+ * funkcijom i kontekstom se ignorise.
+ *
+ * @param router - [in/out] tabela usmjeravanja
+ * @param pid - [in] PID
+ * @param handler - [in] funkcija pretplatnika
+ * @param context - [in] pokazivac koji se prosljedjuje funkciji
+ * @return 0 ako nema greske, -1 ako je PID neispravan ili nema slobodne pretplate
+ *****************************************************************************/
+int32_t pidRouterSubscribe(PidRouter* router, uint16_t pid, Pid_Route_Handler handler, void* context);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ukida pretplatu sa datom funkcijom i kontekstom. Ne smije se
+ * pozivati iz funkcije pretplatnika.
+ *
+ * @param router - [in/out] tabela usmjeravanja
+ * @param pid - [in] PID
+ * @param handler - [in] funkcija pretplatnika
+ * @param context - [in] kontekst naveden pri pretplati
+ *****************************************************************************/
+void pidRouterUnsubscribe(PidRouter* router, uint16_t pid, Pid_Route_Handler handler, void* context);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja provjerava da li je neko pretplacen na PID (samo bit mapa).
+ *
+ * @param router - [in] tabela usmjeravanja
+ * @param pid - [in] PID
+ * @return != 0 ako je PID trazen
+ *****************************************************************************/
+static inline uint32_t pidRouterWanted(const PidRouter* router, uint16_t pid)
+{
+    return router->wanted[(pid & 0x1FFF) >> 5] & (1u << (pid & 31));
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja prosljedjuje paket ili sekciju svim pretplatnicima PID-a.
+ *
+ * @param router - [in] tabela usmjeravanja
+ * @param pid - [in] PID
+ * @param data - [in] paket ili sekcija
+ * @param length - [in] duzina u bajtovima
+ * @return broj pozvanih pretplatnika
+ *****************************************************************************/
+uint32_t pidRouterDispatch(PidRouter* router, uint16_t pid, const uint8_t* data, uint32_t length);
+
+#endif
@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file pmt_acquisition.c
+ * \brief
+ * Ovaj modul realizuje istovremeno dohvatanje PMT tabela. Callback funkcija
+ * demultipleksera samo parsira sekciju i oznacava program; filteri se
+ * oslobadjaju i postavljaju iz niti koja ceka, a ne iz callback funkcije.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "pmt_acquisition.h"
+#include "clock_source.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#define PMT_STATE_SKIPPED 0
+#define PMT_STATE_PENDING 1
+#define PMT_STATE_ARMING 2
+#define PMT_STATE_ARMED 3
+#define PMT_STATE_RECEIVED 4
+#define PMT_STATE_DONE 5
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja filtere primljenih programa i postavlja filtere za
+ * programe koji cekaju. Poziva se sa zakljucanim mutex-om, ali ga otpusta
+ * dok poziva demultiplekser, jer callback demultipleksera zakljucava isti
+ * mutex.
+ *
+ *****************************************************************************/
+static void pmtAcquisitionArm(PmtAcquisition* acquisition)
+{
+    uint32_t freeHandles[MAX_NUM_OF_PIDS];
+    uint32_t armIndices[MAX_NUM_OF_PIDS];
+    uint32_t armHandles[MAX_NUM_OF_PIDS];
+    uint32_t freeCount = 0;
+    uint32_t armCount = 0;
+    uint32_t armedCount;
+    uint32_t count = acquisition->patTable->serviceInfoCount;
+    uint32_t index;
+    uint32_t i;
+    for (i = 0; i < acquisition->patTable->serviceInfoCount; i++)
+    {
+        if (acquisition->state[i] == PMT_STATE_RECEIVED)
+        {
+            freeHandles[freeCount++] = acquisition->filterHandles[i];
+            acquisition->state[i] = PMT_STATE_DONE;
+            acquisition->armed--;
+        }
+    }
+    // reserved slots count as armed, so a concurrent caller does not overshoot maxFilters;
+    // the scan starts at the cursor, so after a retry the services not tried yet come first
+    for (i = 0; i < count && acquisition->armed < acquisition->maxFilters; i++)
+    {
+        index = (acquisition->cursor + i) % count;
+        if (acquisition->state[index] != PMT_STATE_PENDING)
+            continue;
+        acquisition->state[index] = PMT_STATE_ARMING;
+        acquisition->armed++;
+        armIndices[armCount++] = index;
+    }
+    if (armCount > 0)
+        acquisition->cursor = (armIndices[armCount - 1] + 1) % count;
+    if (freeCount == 0 && armCount == 0)
+        return;
+    pthread_mutex_unlock(&(acquisition->mutex));
+    for (i = 0; i < freeCount; i++)
+    {
+        acquisition->ops.freeFilter(acquisition->ops.context, freeHandles[i]);
+    }
+    for (armedCount = 0; armedCount < armCount; armedCount++)
+    {
+        // no free filter slot: try again when the next PMT frees one
+        if (acquisition->ops.setFilter(acquisition->ops.context, acquisition->patTable->patServiceInfoArray[armIndices[armedCount]].pid,
+                                       PMT_TABLE_ID, &(armHandles[armedCount])))
+            break;
+    }
+    pthread_mutex_lock(&(acquisition->mutex));
+    for (i = 0; i < armCount; i++)
+    {
+        if (i < armedCount)
+        {
+            acquisition->filterHandles[armIndices[i]] = armHandles[i];
+            acquisition->state[armIndices[i]] = PMT_STATE_ARMED;
+        }
+        else
+        {
+            acquisition->state[armIndices[i]] = PMT_STATE_PENDING;
+            acquisition->armed--;
+        }
+    }
+}
+
+int32_t pmtAcquisitionStart(PmtAcquisition* acquisition, const PmtAcquisitionOps* ops, PatTable* patTable,
+                            PmtTable** pmtTables, uint32_t maxFilters)
+{
+    uint32_t i;
+    acquisition->ops = *ops;
+    acquisition->patTable = patTable;
+    acquisition->pmtTables = pmtTables;
+    acquisition->maxFilters = (maxFilters > 0) ? maxFilters : 1;
+    acquisition->armed = 0;
+    acquisition->cursor = 0;
+    acquisition->received = 0;
+    acquisition->total = 0;
+    acquisition->cancelled = 0;
+    pthread_mutex_init(&(acquisition->mutex), NULL);
+    pthread_cond_init(&(acquisition->condition), NULL);
+    for (i = 0; i < MAX_NUM_OF_PIDS; i++)
+    {
+        acquisition->state[i] = PMT_STATE_SKIPPED;
+        if (i < patTable->serviceInfoCount && patTable->patServiceInfoArray[i].program_number != 0)
+        {
+            acquisition->state[i] = PMT_STATE_PENDING;
+            acquisition->total++;
+        }
+    }
+    pthread_mutex_lock(&(acquisition->mutex));
+    pmtAcquisitionArm(acquisition);
+    pthread_mutex_unlock(&(acquisition->mutex));
+    if (acquisition->armed == 0 && acquisition->total > 0)
+    {
+        printf("%s: ERROR no PMT filter could be set\n", __FUNCTION__);
+        return -1;
+    }
+    return 0;
+}
+
+int32_t pmtAcquisitionOnSection(PmtAcquisition* acquisition, const SectionView* view)
+{
+    uint32_t i;
+    int32_t index = -1;
+    if (view->table_id != PMT_TABLE_ID)
+        return -1;
+    pthread_mutex_lock(&(acquisition->mutex));
+    // the section carries its program_number, PAT maps it back to the PID
+    for (i = 0; i < acquisition->patTable->serviceInfoCount; i++)
+    {
+        if (acquisition->patTable->patServiceInfoArray[i].program_number == view->table_id_extension)
+        {
+            if (acquisition->state[i] == PMT_STATE_ARMED)
+                index = (int32_t) i;
+            break;
+        }
+    }
+    if (index >= 0 && parsePmtSection(view, acquisition->pmtTables[index]) == 0)
+    {
+        acquisition->state[index] = PMT_STATE_RECEIVED;
+        acquisition->received++;
+        clockBroadcast(&(acquisition->condition));
+    }
+    else
+    {
+        index = -1;
+    }
+    pthread_mutex_unlock(&(acquisition->mutex));
+    return index;
+}
+
+int32_t pmtAcquisitionService(PmtAcquisition* acquisition)
+{
+    int32_t complete;
+    pthread_mutex_lock(&(acquisition->mutex));
+    pmtAcquisitionArm(acquisition);
+    complete = (acquisition->received == acquisition->total);
+    pthread_mutex_unlock(&(acquisition->mutex));
+    return complete;
+}
+
+int32_t pmtAcquisitionWait(PmtAcquisition* acquisition, uint32_t timeoutSeconds)
+{
+    uint64_t deadline = clockNow() + (uint64_t) timeoutSeconds * CLOCK_NS_PER_SEC;
+    int32_t result = 0;
+    pthread_mutex_lock(&(acquisition->mutex));
+    while (1)
+    {
+        pmtAcquisitionArm(acquisition);
+        if (acquisition->received == acquisition->total)
+            break;
+        if (acquisition->cancelled)
+        {
+            result = -1;
+            break;
+        }
+        if (ETIMEDOUT == clockWait(&(acquisition->condition), &(acquisition->mutex), deadline))
+        {
+            printf("%s: ERROR %u of %u PMT tables received before timeout\n", __FUNCTION__,
+                   acquisition->received, acquisition->total);
+            result = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&(acquisition->mutex));
+    return result;
+}
+
+uint32_t pmtAcquisitionRetry(PmtAcquisition* acquisition)
+{
+    uint32_t freeHandles[MAX_NUM_OF_PIDS];
+    uint32_t freeCount = 0;
+    uint32_t missing;
+    uint32_t i;
+    pthread_mutex_lock(&(acquisition->mutex));
+    // a PMT that did not arrive until the deadline gives its filter to the services still waiting
+    for (i = 0; i < acquisition->patTable->serviceInfoCount; i++)
+    {
+        if (acquisition->state[i] == PMT_STATE_ARMED)
+        {
+            freeHandles[freeCount++] = acquisition->filterHandles[i];
+            acquisition->state[i] = PMT_STATE_PENDING;
+            acquisition->armed--;
+        }
+    }
+    pthread_mutex_unlock(&(acquisition->mutex));
+    for (i = 0; i < freeCount; i++)
+    {
+        acquisition->ops.freeFilter(acquisition->ops.context, freeHandles[i]);
+    }
+    pthread_mutex_lock(&(acquisition->mutex));
+    pmtAcquisitionArm(acquisition);
+    missing = acquisition->total - acquisition->received;
+    pthread_mutex_unlock(&(acquisition->mutex));
+    return missing;
+}
+
+void pmtAcquisitionCancel(PmtAcquisition* acquisition)
+{
+    pthread_mutex_lock(&(acquisition->mutex));
+    acquisition->cancelled = 1;
+    clockBroadcast(&(acquisition->condition));
+    pthread_mutex_unlock(&(acquisition->mutex));
+}
+
+void pmtAcquisitionStop(PmtAcquisition* acquisition)
+{
+    uint32_t freeHandles[MAX_NUM_OF_PIDS];
+    uint32_t freeCount = 0;
+    uint32_t i;
+    pthread_mutex_lock(&(acquisition->mutex));
+    for (i = 0; i < acquisition->patTable->serviceInfoCount; i++)
+    {
+        if (acquisition->state[i] == PMT_STATE_ARMED || acquisition->state[i] == PMT_STATE_RECEIVED)
+        {
+            freeHandles[freeCount++] = acquisition->filterHandles[i];
+            acquisition->state[i] = (acquisition->state[i] == PMT_STATE_RECEIVED) ? PMT_STATE_DONE : PMT_STATE_PENDING;
+        }
+    }
+    acquisition->armed = 0;
+    pthread_mutex_unlock(&(acquisition->mutex));
+    // the demux may wait for a callback in flight, which takes the mutex
+    for (i = 0; i < freeCount; i++)
+    {
+        acquisition->ops.freeFilter(acquisition->ops.context, freeHandles[i]);
+    }
+    pthread_cond_destroy(&(acquisition->condition));
+    pthread_mutex_destroy(&(acquisition->mutex));
+}
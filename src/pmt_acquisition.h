@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file pmt_acquisition.h
+ * \brief
+ * Ovaj modul realizuje istovremeno dohvatanje PMT tabela svih programa iz
+ * PAT tabele. Filteri se postavljaju za vise PMT PID-ova odjednom (do broja
+ * slobodnih filtera demultipleksera), sekcije se usmjeravaju na program po
+ * program_number polju, a dohvatanje se zavrsava cim stigne posljednja PMT.
+ * Demultiplekser se zadaje preko pokazivaca na funkcije, tako da se isti kod
+ * koristi i sa simuliranim demultiplekserom na racunaru.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef PMT_ACQUISITION_H
+#define PMT_ACQUISITION_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "table_parser.h"
+
+/* podrazumijevani broj istovremeno postavljenih PMT filtera */
+#define PMT_ACQUISITION_MAX_FILTERS 8
+
+typedef struct _PmtAcquisitionOps
+{
+    /* postavlja filter, vraca 0 ako je filter postavljen, != 0 ako nema slobodnog filtera */
+    int32_t(*setFilter)(void* context, uint16_t pid, uint8_t tableId, uint32_t* filterHandle);
+    void (*freeFilter)(void* context, uint32_t filterHandle);
+    void* context;
+} PmtAcquisitionOps;
+
+typedef struct _PmtAcquisition
+{
+    PmtAcquisitionOps ops;
+    PatTable* patTable;
+    PmtTable** pmtTables; // indeksirano kao patServiceInfoArray
+    uint32_t maxFilters;
+    uint8_t state[MAX_NUM_OF_PIDS];
+    uint32_t filterHandles[MAX_NUM_OF_PIDS];
+    uint32_t armed;
+    uint32_t cursor; // indeks od kojeg se trazi sljedeci program za filter
+    uint32_t received;
+    uint32_t total;
+    uint8_t cancelled; // pmtAcquisitionWait se vraca odmah
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+} PmtAcquisition;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pokrece dohvatanje PMT tabela svih programa iz PAT tabele
+ * (program_number 0, odnosno NIT, se preskace) i postavlja prve filtere.
+ *
+ * @param acquisition - [out] stanje dohvatanja
+ * @param ops - [in] funkcije demultipleksera
+ * @param patTable - [in] parsirana PAT tabela
+ * @param pmtTables - [out] tabele u koje se parsiraju PMT sekcije
+ * @param maxFilters - [in] najveci broj istovremeno postavljenih filtera
+ * @return 0 ako nema greske, -1 ako nijedan filter nije postavljen
+ *****************************************************************************/
+int32_t pmtAcquisitionStart(PmtAcquisition* acquisition, const PmtAcquisitionOps* ops, PatTable* patTable,
+                            PmtTable** pmtTables, uint32_t maxFilters);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja se poziva iz callback funkcije demultipleksera za svaku PMT
+ * sekciju. Sekcija se usmjerava na program po program_number polju i parsira;
+ * ponovljene sekcije vec dohvacenih programa se odbacuju.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ * @param view - [in] validiran pogled na PMT sekciju
+ * @return indeks programa u PAT tabeli, -1 ako je sekcija odbacena
+ *****************************************************************************/
+int32_t pmtAcquisitionOnSection(PmtAcquisition* acquisition, const SectionView* view);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja filtere programa cije su PMT tabele stigle i
+ * postavlja filtere za sljedece programe. Ne blokira.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ * @return 1 ako su stigle sve PMT tabele, 0 u suprotnom
+ *****************************************************************************/
+int32_t pmtAcquisitionService(PmtAcquisition* acquisition);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ceka da stignu sve PMT tabele, postavljajuci nove filtere
+ * kako se stari oslobadjaju.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ * @param timeoutSeconds - [in] ukupno vrijeme cekanja za sve programe
+ * @return 0 ako su stigle sve PMT tabele, -1 ako je isteklo vrijeme ili je
+ * cekanje prekinuto
+ *****************************************************************************/
+int32_t pmtAcquisitionWait(PmtAcquisition* acquisition, uint32_t timeoutSeconds);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja se poziva nakon isteka pmtAcquisitionWait. Programi cije
+ * PMT tabele nisu stigle oslobadjaju filtere i vracaju se u red, a filteri se
+ * postavljaju redom od programa koji do sada nisu dosli na red, tako da
+ * sljedeci pmtAcquisitionWait pokusa i njih. Ne blokira.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ * @return broj programa cije PMT tabele jos nisu stigle
+ *****************************************************************************/
+uint32_t pmtAcquisitionRetry(PmtAcquisition* acquisition);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja prekida cekanje u pmtAcquisitionWait (npr. pri gasenju).
+ * Smije se pozvati samo izmedju pmtAcquisitionStart i pmtAcquisitionStop.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ *****************************************************************************/
+void pmtAcquisitionCancel(PmtAcquisition* acquisition);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja sve jos postavljene filtere. Poziva se kada se
+ * pmtAcquisitionWait i pmtAcquisitionService vise ne izvrsavaju, a callback
+ * demultipleksera vise ne moze pozvati pmtAcquisitionOnSection.
+ *
+ * @param acquisition - [in/out] stanje dohvatanja
+ *****************************************************************************/
+void pmtAcquisitionStop(PmtAcquisition* acquisition);
+
+#endif
@@ -0,0 +1,241 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file pmt_startup_bench.c
+ * \brief
+ * Program koji mjeri vrijeme dohvatanja svih PMT tabela pri pokretanju, sa
+ * simuliranim demultiplekserom. Svaka PMT se ponavlja sa zadatim periodom i
+ * slucajnom fazom, a demultiplekser ima ograniceni broj filtera. Vrijeme je
+ * simulirano (diskretni dogadjaji), pa je rezultat ponovljiv; broj filtera 1
+ * odgovara ranijem serijskom dohvatanju.
+ *
+ * Upotreba: pmt_startup_bench [servisa] [period_ms] [filtera]
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "pmt_acquisition.h"
+#include "crc32.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_TRIALS 200
+/* vrijeme koje drajver trosi na postavljanje, odnosno oslobadjanje filtera */
+#define BENCH_SET_FILTER_MS 2.0
+#define BENCH_FREE_FILTER_MS 1.0
+#define BENCH_MAX_SLOTS 32
+
+typedef struct _BenchSlot
+{
+    uint8_t used;
+    uint16_t pid;
+    double armedAt;
+} BenchSlot;
+
+typedef struct _BenchDemux
+{
+    double now; // simulirano vrijeme u ms
+    double period;
+    uint32_t slotCount;
+    BenchSlot slots[BENCH_MAX_SLOTS];
+    double phase[MAX_NUM_OF_PIDS];
+    uint8_t sections[MAX_NUM_OF_PIDS][64];
+    uint16_t sectionSizes[MAX_NUM_OF_PIDS];
+} BenchDemux;
+
+static int32_t benchSetFilter(void* context, uint16_t pid, uint8_t tableId, uint32_t* filterHandle)
+{
+    BenchDemux* demux = (BenchDemux*) context;
+    uint32_t i;
+    for (i = 0; i < demux->slotCount; i++)
+    {
+        if (!demux->slots[i].used)
+        {
+            demux->now += BENCH_SET_FILTER_MS;
+            demux->slots[i].used = 1;
+            demux->slots[i].pid = pid;
+            demux->slots[i].armedAt = demux->now;
+            *filterHandle = i;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void benchFreeFilter(void* context, uint32_t filterHandle)
+{
+    BenchDemux* demux = (BenchDemux*) context;
+    demux->now += BENCH_FREE_FILTER_MS;
+    demux->slots[filterHandle].used = 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pravi PMT sekciju sa jednim video i jednim audio tokom.
+ *
+ *****************************************************************************/
+static uint16_t benchBuildPmt(uint8_t* section, uint16_t programNumber, uint16_t pid)
+{
+    static const uint8_t streams[] = {0x02, 0xE0, 0x00, 0xF0, 0x00, 0x03, 0xE0, 0x00, 0xF0, 0x00};
+    uint16_t sectionLength = 9 + sizeof (streams) + 4;
+    uint32_t crc;
+    section[0] = PMT_TABLE_ID;
+    section[1] = (uint8_t) (0xB0 | (sectionLength >> 8));
+    section[2] = (uint8_t) sectionLength;
+    section[3] = (uint8_t) (programNumber >> 8);
+    section[4] = (uint8_t) programNumber;
+    section[5] = 0xC1;
+    section[6] = 0;
+    section[7] = 0;
+    section[8] = (uint8_t) (0xE0 | ((pid + 1) >> 8));
+    section[9] = (uint8_t) (pid + 1);
+    section[10] = 0xF0;
+    section[11] = 0;
+    memcpy(section + 12, streams, sizeof (streams));
+    section[13] |= (uint8_t) ((pid + 1) >> 8);
+    section[14] = (uint8_t) (pid + 1);
+    section[18] |= (uint8_t) ((pid + 2) >> 8);
+    section[19] = (uint8_t) (pid + 2);
+    crc = crc32Mpeg2(section, 12 + sizeof (streams));
+    section[22] = (uint8_t) (crc >> 24);
+    section[23] = (uint8_t) (crc >> 16);
+    section[24] = (uint8_t) (crc >> 8);
+    section[25] = (uint8_t) crc;
+    return (uint16_t) (sectionLength + 3);
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja simulira jedno pokretanje: sekcije se isporucuju redom po
+ * vremenu prvog ponavljanja nakon postavljanja filtera.
+ *
+ * @return simulirano vrijeme dohvatanja svih PMT tabela u ms
+ *****************************************************************************/
+static double benchRun(BenchDemux* demux, PatTable* pat, PmtTable** pmts, uint32_t window)
+{
+    PmtAcquisition acquisition;
+    PmtAcquisitionOps ops;
+    SectionView view;
+    uint32_t i;
+    ops.setFilter = benchSetFilter;
+    ops.freeFilter = benchFreeFilter;
+    ops.context = demux;
+    demux->now = 0;
+    memset(demux->slots, 0, sizeof (demux->slots));
+    if (pmtAcquisitionStart(&acquisition, &ops, pat, pmts, window) != 0)
+        return -1;
+    while (!pmtAcquisitionService(&acquisition))
+    {
+        double first = -1;
+        uint32_t service = 0;
+        for (i = 0; i < demux->slotCount; i++)
+        {
+            uint32_t index;
+            double arrival;
+            if (!demux->slots[i].used)
+                continue;
+            index = demux->slots[i].pid - 0x100;
+            arrival = demux->phase[index];
+            if (arrival < demux->slots[i].armedAt)
+                arrival += demux->period * (uint32_t) ((demux->slots[i].armedAt - arrival) / demux->period + 1);
+            if (first < 0 || arrival < first)
+            {
+                first = arrival;
+                service = index;
+            }
+        }
+        if (first < 0)
+            break;
+        if (first > demux->now)
+            demux->now = first;
+        sectionViewInit(&view, demux->sections[service], demux->sectionSizes[service]);
+        pmtAcquisitionOnSection(&acquisition, &view);
+    }
+    pmtAcquisitionStop(&acquisition);
+    return demux->now;
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    static BenchDemux demux;
+    static const uint32_t windows[] = {1, 2, 4, 8, 16};
+    PatHeader patHeader;
+    PatTable pat;
+    PmtHeader pmtHeaders[MAX_NUM_OF_PIDS];
+    PmtTable pmtStorage[MAX_NUM_OF_PIDS];
+    PmtTable* pmts[MAX_NUM_OF_PIDS];
+    uint32_t services = (argc > 1) ? (uint32_t) atoi(argv[1]) : MAX_NUM_OF_PIDS - 1;
+    uint32_t i;
+    uint32_t w;
+    uint32_t trial;
+
+    demux.period = (argc > 2) ? atof(argv[2]) : 400.0;
+    demux.slotCount = (argc > 3) ? (uint32_t) atoi(argv[3]) : PMT_ACQUISITION_MAX_FILTERS;
+    if (services < 1 || services > MAX_NUM_OF_PIDS - 1 || demux.slotCount < 1 || demux.slotCount > BENCH_MAX_SLOTS)
+    {
+        printf("usage: %s [services 1-%d] [period_ms] [filters 1-%d]\n", argv[0], MAX_NUM_OF_PIDS - 1, BENCH_MAX_SLOTS);
+        return 1;
+    }
+
+    // PAT index 0 is the NIT, like on air
+    pat.patHeader = &patHeader;
+    pat.serviceInfoCount = (uint8_t) (services + 1);
+    pat.patServiceInfoArray[0].program_number = 0;
+    pat.patServiceInfoArray[0].pid = 0x10;
+    for (i = 0; i < MAX_NUM_OF_PIDS; i++)
+    {
+        pmtStorage[i].pmtHeader = &pmtHeaders[i];
+        pmts[i] = &pmtStorage[i];
+    }
+    for (i = 1; i <= services; i++)
+    {
+        pat.patServiceInfoArray[i].program_number = (uint16_t) i;
+        pat.patServiceInfoArray[i].pid = (uint16_t) (0x100 + i);
+        demux.sectionSizes[i] = benchBuildPmt(demux.sections[i], (uint16_t) i, (uint16_t) (0x100 + i));
+    }
+
+    printf("%u services, PMT every %.0f ms, %u demux filters, %d trials\n", services, demux.period,
+           demux.slotCount, BENCH_TRIALS);
+    for (w = 0; w < sizeof (windows) / sizeof (windows[0]); w++)
+    {
+        double total = 0;
+        double worst = 0;
+        struct timespec start;
+        struct timespec end;
+        if (windows[w] > demux.slotCount && w > 0 && windows[w - 1] >= demux.slotCount)
+            break;
+        srand(1);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (trial = 0; trial < BENCH_TRIALS; trial++)
+        {
+            double elapsed;
+            for (i = 1; i <= services; i++)
+            {
+                demux.phase[i] = demux.period * rand() / ((double) RAND_MAX + 1);
+            }
+            elapsed = benchRun(&demux, &pat, pmts, windows[w]);
+            total += elapsed;
+            if (elapsed > worst)
+                worst = elapsed;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        printf("%2u filter(s)%s: startup avg %7.1f ms, worst %7.1f ms (host CPU %.2f us/run)\n",
+               windows[w], (windows[w] == 1) ? " (serial)" : "", total / BENCH_TRIALS, worst,
+               ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3) / BENCH_TRIALS);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file psi_cache.c
+ * \brief
+ * Ovaj modul realizuje kes PSI/SI sekcija po kljucu (PID, table_id,
+ * table_id_extension, section_number). Kes je direktno mapiran: kolizija
+ * samo znaci da ce sekcija jos jednom biti parsirana.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "psi_cache.h"
+#include <string.h>
+#include <stdint.h>
+
+#define PSI_CACHE_VALID_BIT ((uint64_t) 1 << 63)
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pakuje PID, table_id, table_id_extension i section_number u
+ * jedan 64-bitni kljuc.
+ *
+ *****************************************************************************/
+static inline uint64_t psiCacheKey(uint16_t pid, uint8_t tableId, uint16_t extension, uint8_t sectionNumber)
+{
+    return PSI_CACHE_VALID_BIT | ((uint64_t) (pid & 0x1FFF) << 32) | ((uint64_t) tableId << 24) |
+            ((uint64_t) extension << 8) | sectionNumber;
+}
+
+static inline PsiCacheEntry* psiCacheSlot(PsiCache* cache, uint64_t key)
+{
+    return &(cache->entries[((key * 0x9E3779B97F4A7C15ull) >> (64 - PSI_CACHE_BITS)) & (PSI_CACHE_SIZE - 1)]);
+}
+
+void psiCacheReset(PsiCache* cache)
+{
+    memset(cache, 0, sizeof (PsiCache));
+}
+
+PsiCacheResult psiCacheCheck(PsiCache* cache, uint16_t pid, const uint8_t* buffer, uint32_t bufferSize)
+{
+    PsiCacheEntry* entry;
+    const uint8_t* crc;
+    uint64_t key;
+    uint16_t size;
+
+    if (bufferSize < SECTION_LONG_HEADER_SIZE + SECTION_CRC_SIZE || !(buffer[1] & 0x80))
+        return PSI_CACHE_NEW;
+    size = (uint16_t) ((((buffer[1] << 8) + buffer[2]) & 0x0FFF) + 3);
+    if (size > bufferSize || size < SECTION_LONG_HEADER_SIZE + SECTION_CRC_SIZE)
+        return PSI_CACHE_NEW;
+    // a "next" section must neither be applied nor replace the current entry
+    if (!(buffer[5] & 0x01))
+        return PSI_CACHE_NEXT;
+
+    key = psiCacheKey(pid, buffer[0], (uint16_t) ((buffer[3] << 8) + buffer[4]), buffer[6]);
+    entry = psiCacheSlot(cache, key);
+    if (entry->key != key)
+    {
+        cache->misses++;
+        return PSI_CACHE_NEW;
+    }
+    crc = buffer + size - SECTION_CRC_SIZE;
+    if (entry->version_number == ((buffer[5] >> 1) & 0x1F) &&
+            entry->crc == (((uint32_t) crc[0] << 24) | ((uint32_t) crc[1] << 16) | ((uint32_t) crc[2] << 8) | crc[3]))
+    {
+        cache->hits++;
+        return PSI_CACHE_UNCHANGED;
+    }
+    cache->misses++;
+    return PSI_CACHE_CHANGED;
+}
+
+void psiCacheUpdate(PsiCache* cache, uint16_t pid, const SectionView* view)
+{
+    PsiCacheEntry* entry;
+    uint64_t key;
+    if (view->section_syntax_indicator == 0 || view->current_next_indicator == 0)
+        return;
+    key = psiCacheKey(pid, view->table_id, view->table_id_extension, view->section_number);
+    entry = psiCacheSlot(cache, key);
+    entry->key = key;
+    entry->crc = view->crc;
+    entry->version_number = view->version_number;
+}
+
+void psiCacheInvalidatePid(PsiCache* cache, uint16_t pid)
+{
+    int32_t i;
+    for (i = 0; i < PSI_CACHE_SIZE; i++)
+    {
+        if ((cache->entries[i].key & PSI_CACHE_VALID_BIT) && ((cache->entries[i].key >> 32) & 0x1FFF) == pid)
+        {
+            cache->entries[i].key = 0;
+        }
+    }
+}
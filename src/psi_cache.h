@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file psi_cache.h
+ * \brief
+ * Ovaj modul realizuje kes PSI/SI sekcija po kljucu (PID, table_id,
+ * table_id_extension, section_number). Za svaki kljuc pamte se
+ * version_number i CRC_32 posljednje prihvacene sekcije, tako da se
+ * ponovljene sekcije odbacuju prije validacije i parsiranja. Sekcije sa
+ * current_next_indicator = 0 opisuju sljedecu verziju tabele, ne upisuju
+ * se u kes i odbacuju se isto kao ponovljene.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef PSI_CACHE_H
+#define PSI_CACHE_H
+
+#include <stdint.h>
+#include "section_view.h"
+
+/* broj ulaza u kesu je 2^PSI_CACHE_BITS */
+#define PSI_CACHE_BITS 10
+#define PSI_CACHE_SIZE (1 << PSI_CACHE_BITS)
+
+/* rezultati od PSI_CACHE_UNCHANGED nadalje znace da se sekcija odbacuje */
+typedef enum _PsiCacheResult
+{
+    PSI_CACHE_NEW = 0, /* sekcija sa ovim kljucem jos nije vidjena */
+    PSI_CACHE_CHANGED, /* promijenjena je verzija ili sadrzaj sekcije */
+    PSI_CACHE_UNCHANGED, /* ponovljena sekcija, moze se odbaciti */
+    PSI_CACHE_NEXT /* current_next_indicator = 0, sekcija jos ne vazi */
+} PsiCacheResult;
+
+typedef struct _PsiCacheEntry
+{
+    uint64_t key; /* 0 oznacava prazan ulaz */
+    uint32_t crc;
+    uint8_t version_number;
+} PsiCacheEntry;
+
+typedef struct _PsiCache
+{
+    PsiCacheEntry entries[PSI_CACHE_SIZE];
+    uint32_t hits;
+    uint32_t misses;
+} PsiCache;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja prazni kes.
+ *
+ * @param cache - [out] kes
+ *****************************************************************************/
+void psiCacheReset(PsiCache* cache);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja provjerava da li je sekcija vec vidjena. Cita se samo
+ * zaglavlje i CRC_32 sa kraja sekcije, bez racunanja CRC-a, pa se poziva
+ * prije sectionViewInit. Za sekcije bez dugog zaglavlja uvijek vraca
+ * PSI_CACHE_NEW.
+ *
+ * @param cache - [in] kes
+ * @param pid - [in] PID na kome je sekcija primljena
+ * @param buffer - [in] bafer sa sekcijom
+ * @param bufferSize - [in] broj bajtova koji se smiju procitati iz bafera
+ * @return PSI_CACHE_UNCHANGED ako je ista sekcija vec prihvacena,
+ * PSI_CACHE_NEXT ako sekcija jos ne vazi
+ *****************************************************************************/
+PsiCacheResult psiCacheCheck(PsiCache* cache, uint16_t pid, const uint8_t* buffer, uint32_t bufferSize);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje validiranu sekciju u kes. Poziva se tek nakon
+ * uspjesne validacije, tako da neispravna sekcija nikad ne zavrsi u kesu.
+ * Sekcije sa current_next_indicator = 0 se ne upisuju.
+ *
+ * @param cache - [in/out] kes
+ * @param pid - [in] PID na kome je sekcija primljena
+ * @param view - [in] validiran pogled na sekciju
+ *****************************************************************************/
+void psiCacheUpdate(PsiCache* cache, uint16_t pid, const SectionView* view);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sve ulaze jednog PID-a, npr. prilikom postavljanja
+ * novog filtera, tako da prva sljedeca sekcija sigurno bude obradjena.
+ *
+ * @param cache - [in/out] kes
+ * @param pid - [in] PID
+ *****************************************************************************/
+void psiCacheInvalidatePid(PsiCache* cache, uint16_t pid);
+
+#endif
@@ -28,13 +28,24 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <errno.h>
-#include <pthread.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
 #include "tdp_api.h"
+#include "clock_source.h"
+#include "zap_stats.h"
+#include "event_loop.h"
 
 static int32_t inputFileDesc;
 static Remote_Control_Callback sectionNumberCallback;
 static Remote_Control_Callback volumeCallback;
 static Remote_Control_Callback infoCallback;
+static Remote_Control_Callback serviceSkipCallback;
+/* input_event.time is on CLOCK_MONOTONIC, the same clock as clockNow() */
+static uint8_t monotonicEvents = 0;
+/* program P+/P- count from, restored from the channel database at startup */
+static uint32_t serviceNumber = 1;
+static struct input_event eventBuf[NUM_EVENTS];
 
 /****************************************************************************
  *
@@ -47,6 +58,14 @@ static Remote_Control_Callback infoCallback;
  * eventsRead - [out] broj dogadjaja koji su ucitani
  *****************************************************************************/
 int32_t getKeys(int32_t count, uint8_t* buf, int32_t* eventRead);
+
+/* kernel timestamp of the key press, so time spent queued in evdev is measured too */
+static uint64_t remoteEventTime(const struct input_event* event)
+{
+    if (!monotonicEvents || clockIsVirtual())
+        return clockNow();
+    return (uint64_t) event->time.tv_sec * CLOCK_NS_PER_SEC + (uint64_t) event->time.tv_usec * 1000u;
+}
 /****************************************************************************
  *
  * @brief
@@ -98,110 +117,160 @@ void registerInfoButtonCallback(Remote_Control_Callback remote_ControllCallback)
 /****************************************************************************
  *
  * @brief
- * Fukncija koja se treba kreirati kao poseban thread, a predstavlja beskonacnu petlju koja se vrti, 
- * i u slucaju pritiska dugmeta na daljinskom upravljacu aktivira se odgovarajuca callback funkcija.
+ * Fukcija koja se koristi za registovanje callback funkcije koja odlucuje da li se program preskace pri promjeni tasterima P+/P-
  *
+ * @param
+ * remote_ControllCallback - [in] pokazivac na funkciju koja vraca 1 za program koji se preskace
  *
  *
  *
  *****************************************************************************/
-void* remoteControlThread(void* nn)
+void registerServiceSkipRemoteCallback(Remote_Control_Callback remote_ControllCallback)
+{
+    serviceSkipCallback = remote_ControllCallback;
+}
+
+void remoteSetServiceNumber(uint32_t service_number)
+{
+    serviceNumber = service_number;
+}
+
+/* a key press is handled completely on the event loop thread */
+static void remoteHandleKey(const struct input_event* event)
 {
-    const char* dev = "/dev/input/event0";
-    char deviceName[20];
-    struct input_event* eventBuf;
-    uint32_t eventCnt;
-    uint32_t i;
-    uint32_t service_number = 1;
     uint32_t tmp_number;
-    uint32_t tmp_number2;
-    inputFileDesc = open(dev, O_RDWR);
-    if (inputFileDesc == -1)
+    zapStatsKeyEvent(remoteEventTime(event));
+    switch (event->code)
     {
-        printf("Error while opening device (%s) !", strerror(errno));
-        return;
+    case REMOTE_BTN_PROGRAM_PLUS:
+        tmp_number = serviceNumber + 1;
+        while (serviceSkipCallback != NULL && serviceSkipCallback(tmp_number))
+        {
+            tmp_number++;
+        }
+        if (sectionNumberCallback(tmp_number) == NO_ERROR)
+        {
+            serviceNumber = tmp_number;
+        }
+        break;
+    case REMOTE_BTN_PROGRAM_MINUS:
+        tmp_number = serviceNumber - 1;
+        while (serviceSkipCallback != NULL && serviceSkipCallback(tmp_number))
+        {
+            tmp_number--;
+        }
+        if (sectionNumberCallback(tmp_number) == NO_ERROR)
+        {
+            serviceNumber = tmp_number;
+        }
+        break;
+    case REMOTE_BTN_VOLUME_PLUS:
+        if (volumeCallback != NULL)
+        {
+            volumeCallback(VOLUME_PLUS);
+        }
+        break;
+    case REMOTE_BTN_VOLUME_MINUS:
+        if (volumeCallback != NULL)
+        {
+            volumeCallback(VOLUME_MINUS);
+        }
+        break;
+    case REMOTE_BTN_MUTE:
+        printf(" MUTE\n");
+        if (volumeCallback != NULL)
+        {
+            volumeCallback(VOLUME_MUTE);
+        }
+        break;
+    case REMOTE_BTN_INFO:
+        if (infoCallback != NULL)
+        {
+            infoCallback(1);
+        }
+        break;
+    case REMOTE_BTN_EXIT:
+        eventLoopStop();
+        break;
+    default:
+        tmp_number = remoteCheckServiceNumberCode(event->code);
+        if (tmp_number != -1)
+        {
+            //  printf("****Service number: %d tmp_number\n", serviceNumber);
+            if (sectionNumberCallback(tmp_number) == NO_ERROR)
+            {
+                serviceNumber = tmp_number;
+            }
+        }
     }
-    ioctl(inputFileDesc, EVIOCGNAME(sizeof (deviceName)), deviceName);
-    printf("RC device opened succesfully [%s]\n", deviceName);
+}
 
-    eventBuf = malloc(NUM_EVENTS * sizeof (struct input_event));
-    if (!eventBuf)
+static void remoteInputReady(int32_t fd, uint32_t events, void* arg)
+{
+    int32_t eventCnt;
+    int32_t i;
+    if (getKeys(NUM_EVENTS, (uint8_t*) eventBuf, &eventCnt))
     {
-        printf("Error allocating memory !");
+        printf("Error while reading input events !");
+        eventLoopStop();
         return;
     }
-    tmp_number = service_number;
-
-    while (NON_STOP)
+    for (i = 0; i < eventCnt; i++)
     {
-        if (getKeys(NUM_EVENTS, (uint8_t*) eventBuf, &eventCnt))
+        if (eventBuf[i].value == 1 && eventBuf[i].type == 1)
         {
-            printf("Error while reading input events !");
-            return;
+            remoteHandleKey(&eventBuf[i]);
         }
+    }
+}
 
-        for (i = 0; i < eventCnt; i++)
-        {
-            if (eventBuf[i].value == 1 && eventBuf[i].type == 1)
-            {
-                tmp_number2 = service_number;
-                switch (eventBuf[i].code)
-                {
-                case REMOTE_BTN_PROGRAM_PLUS:
-                    if (sectionNumberCallback(service_number + 1) == NO_ERROR)
-                    {
-                        service_number++;
-                    }
-                    break;
-                case REMOTE_BTN_PROGRAM_MINUS:
-
-                    if (sectionNumberCallback(service_number - 1) == NO_ERROR)
-                    {
-                        service_number--;
-                    }
-                    break;
-                case REMOTE_BTN_VOLUME_PLUS:
-                    if (volumeCallback != NULL)
-                    {
-                        volumeCallback(VOLUME_PLUS);
-                    }
-                    break;
-                case REMOTE_BTN_VOLUME_MINUS:
-                    if (volumeCallback != NULL)
-                    {
-                        volumeCallback(VOLUME_MINUS);
-                    }
-                    break;
-                case REMOTE_BTN_MUTE:
-                    printf(" MUTE\n");
-                    if (volumeCallback != NULL)
-                    {
-                        volumeCallback(VOLUME_MUTE);
-                    }
-                    break;
-                case REMOTE_BTN_INFO:
-                    if (infoCallback != NULL)
-                    {
-                        infoCallback(1);
-                    }
-                    break;
-                case REMOTE_BTN_EXIT:
-                    free(eventBuf);
-                    return;
-                default:
-                    tmp_number = remoteCheckServiceNumberCode(eventBuf[i].code);
-                    if (tmp_number != -1)
-                    {
-                        //  printf("****Service number: %d tmp_number\n", service_number);
-                        if (sectionNumberCallback(tmp_number) == NO_ERROR)
-                        {
-                            service_number = tmp_number;
-                        }
-                    }
-                }
-            }
-        }
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja otvara ulazni uredjaj daljinskog upravljaca i registruje ga u
+ * petlji dogadjaja. Tasteri se obradjuju u niti koja pozove eventLoopRun, a
+ * taster EXIT zaustavlja petlju.
+ *
+ * @return NO_ERROR ako nema greske, ERROR u suprotnom
+ *****************************************************************************/
+int32_t remoteInit(void)
+{
+    const char* dev = "/dev/input/event0";
+    char deviceName[20];
+    int32_t clockId = CLOCK_MONOTONIC;
+    inputFileDesc = open(dev, O_RDWR | O_NONBLOCK);
+    if (inputFileDesc == -1)
+    {
+        printf("Error while opening device (%s) !", strerror(errno));
+        return ERROR;
+    }
+    ioctl(inputFileDesc, EVIOCGNAME(sizeof (deviceName)), deviceName);
+    printf("RC device opened succesfully [%s]\n", deviceName);
+#ifdef EVIOCSCLOCKID
+    monotonicEvents = (ioctl(inputFileDesc, EVIOCSCLOCKID, &clockId) == 0);
+#endif
+    if (eventLoopAddFd(inputFileDesc, EPOLLIN, remoteInputReady, NULL))
+    {
+        close(inputFileDesc);
+        inputFileDesc = -1;
+        return ERROR;
+    }
+    return NO_ERROR;
+}
 
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja uklanja ulazni uredjaj iz petlje dogadjaja i zatvara ga.
+ *
+ *****************************************************************************/
+void remoteDeinit(void)
+{
+    if (inputFileDesc != -1)
+    {
+        eventLoopRemoveFd(inputFileDesc);
+        close(inputFileDesc);
+        inputFileDesc = -1;
     }
 }
 /****************************************************************************
@@ -271,6 +340,12 @@ int32_t getKeys(int32_t count, uint8_t* buf, int32_t* eventsRead)
 
     /* read input events and put them in buffer */
     ret = read(inputFileDesc, buf, (size_t) (count * (int) sizeof (struct input_event)));
+    // the descriptor is non-blocking, epoll may report it before the events are there
+    if (ret < 0 && errno == EAGAIN)
+    {
+        *eventsRead = 0;
+        return NO_ERROR;
+    }
     if (ret <= 0)
     {
         printf("Error code %d", ret);
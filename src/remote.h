@@ -99,17 +99,49 @@ void registerVolumeRemoteCallback(Remote_Control_Callback remoteControllCallback
  *****************************************************************************/
 void registerInfoButtonCallback(Remote_Control_Callback remoteControllCallback);
 
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja se koristi za registovanje callback funkcije koja odlucuje da li se program preskace pri promjeni tasterima P+/P-
+ *
+ * @param
+ * remote_ControllCallback - [in] pokazivac na funkciju koja vraca 1 za program koji se preskace
+ *
+ *
+ *
+ *****************************************************************************/
+void registerServiceSkipRemoteCallback(Remote_Control_Callback remoteControllCallback);
 
 /****************************************************************************
  *
  * @brief
- * Fukncija koja se treba kreirati kao poseban thread, a predstavlja beskonacnu petlju koja se vrti, 
- * i u slucaju pritiska dugmeta na daljinskom upravljacu aktivira se odgovarajuca callback funkcija.
+ * Fukcija koja postavlja program od kojeg se racuna promjena tasterima P+/P-.
+ * Poziva se prije pokretanja petlje dogadjaja.
  *
+ * @param
+ * service_number - [in] redni broj programa koji se reprodukuje
  *
+ *****************************************************************************/
+void remoteSetServiceNumber(uint32_t service_number);
+
+
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja otvara ulazni uredjaj daljinskog upravljaca i registruje ga u
+ * petlji dogadjaja. Tasteri se obradjuju u niti koja pozove eventLoopRun, a
+ * taster EXIT zaustavlja petlju.
  *
+ * @return NO_ERROR ako nema greske, ERROR u suprotnom
+ *****************************************************************************/
+int32_t remoteInit(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja uklanja ulazni uredjaj iz petlje dogadjaja i zatvara ga.
  *
  *****************************************************************************/
-void* remoteControlThread(void*);
+void remoteDeinit(void);
 
 #endif
\ No newline at end of file
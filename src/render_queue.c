@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file render_queue.c
+ * \brief
+ * Mjesto je slobodno za upis na poziciji pos kada mu je redni broj jednak
+ * pos, a spremno za citanje kada je pos + 1. Pisac zauzima poziciju
+ * atomskim compare-and-swap nad enqueuePos, a citalac nakon citanja
+ * postavlja redni broj na pos + RENDER_QUEUE_SIZE za sljedeci krug.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "render_queue.h"
+#include <stdint.h>
+#include <errno.h>
+#include <semaphore.h>
+
+int32_t renderQueueInit(RenderQueue* queue)
+{
+    uint32_t i;
+    for (i = 0; i < RENDER_QUEUE_SIZE; i++)
+        queue->slots[i].sequence = i;
+    queue->enqueuePos = 0;
+    queue->dequeuePos = 0;
+    return (sem_init(&(queue->ready), 0, 0) == 0) ? 0 : -1;
+}
+
+void renderQueueDestroy(RenderQueue* queue)
+{
+    sem_destroy(&(queue->ready));
+}
+
+int32_t renderQueuePush(RenderQueue* queue, const RenderCommand* command)
+{
+    RenderSlot* slot;
+    uint32_t pos = __atomic_load_n(&(queue->enqueuePos), __ATOMIC_RELAXED);
+    uint32_t sequence;
+    int32_t diff;
+    while (1)
+    {
+        slot = &(queue->slots[pos & (RENDER_QUEUE_SIZE - 1)]);
+        sequence = __atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE);
+        diff = (int32_t) (sequence - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&(queue->enqueuePos), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // the reader is a whole lap behind
+            return -1;
+        }
+        else
+        {
+            pos = __atomic_load_n(&(queue->enqueuePos), __ATOMIC_RELAXED);
+        }
+    }
+    slot->command = *command;
+    __atomic_store_n(&(slot->sequence), pos + 1, __ATOMIC_RELEASE);
+    sem_post(&(queue->ready));
+    return 0;
+}
+
+int32_t renderQueuePop(RenderQueue* queue, RenderCommand* command)
+{
+    uint32_t pos = queue->dequeuePos;
+    RenderSlot* slot = &(queue->slots[pos & (RENDER_QUEUE_SIZE - 1)]);
+    uint32_t sequence = __atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE);
+    if ((int32_t) (sequence - (pos + 1)) < 0)
+        return 0;
+    *command = slot->command;
+    __atomic_store_n(&(slot->sequence), pos + RENDER_QUEUE_SIZE, __ATOMIC_RELEASE);
+    queue->dequeuePos = pos + 1;
+    return 1;
+}
+
+void renderQueueWait(RenderQueue* queue)
+{
+    while (sem_wait(&(queue->ready)) != 0 && errno == EINTR);
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file render_queue.h
+ * \brief
+ * Ovaj modul realizuje red komandi za nit koja iscrtava OSD. Red je
+ * ogranicen kruzni bafer bez zakljucavanja (svako mjesto ima redni broj,
+ * kao kod D. Vyukov-a): vise niti moze upisivati, a cita samo nit za
+ * iscrtavanje. Upis nikada ne ceka; ako je red pun, komanda se odbacuje.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <stdint.h>
+#include <semaphore.h>
+
+/* mora biti stepen dvojke */
+#define RENDER_QUEUE_SIZE 32
+#define RENDER_TEXT_SIZE 128
+
+typedef enum
+{
+    RENDER_BANNER = 0, // informacije o programu
+    RENDER_VOLUME, // jacina zvuka
+    RENDER_BACKDROP, // providna ili neprovidna pozadina
+    RENDER_HIDE_OSD, // istekao tajmer OSD-a
+    RENDER_QUIT // kraj niti za iscrtavanje
+} RenderCommandType;
+
+typedef struct _RenderBanner
+{
+    int32_t service_number;
+    char name[RENDER_TEXT_SIZE]; // "" ako nije poznat
+    uint16_t vpid;
+    uint16_t apid;
+    uint8_t teletekst;
+    char title[RENDER_TEXT_SIZE]; // "" ako nije poznat
+} RenderBanner;
+
+typedef struct _RenderCommand
+{
+    RenderCommandType type;
+    union
+    {
+        RenderBanner banner;
+        int32_t volume;
+        uint8_t opaque;
+    } data;
+} RenderCommand;
+
+typedef struct _RenderSlot
+{
+    uint32_t sequence;
+    RenderCommand command;
+} RenderSlot;
+
+typedef struct _RenderQueue
+{
+    RenderSlot slots[RENDER_QUEUE_SIZE];
+    uint32_t enqueuePos;
+    uint32_t dequeuePos; // samo nit koja cita
+    sem_t ready;
+} RenderQueue;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje prazan red.
+ *
+ * @param queue - [out] red
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t renderQueueInit(RenderQueue* queue);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja resurse reda.
+ *
+ * @param queue - [in/out] red
+ *****************************************************************************/
+void renderQueueDestroy(RenderQueue* queue);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje komandu i budi nit koja cita. Moze se pozivati iz
+ * vise niti istovremeno.
+ *
+ * @param queue - [in/out] red
+ * @param command - [in] komanda
+ * @return 0 ako je komanda upisana, -1 ako je red pun
+ *****************************************************************************/
+int32_t renderQueuePush(RenderQueue* queue, const RenderCommand* command);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedecu komandu bez cekanja.
+ *
+ * @param queue - [in/out] red
+ * @param command - [out] komanda
+ * @return 1 ako je komanda procitana, 0 ako je red prazan
+ *****************************************************************************/
+int32_t renderQueuePop(RenderQueue* queue, RenderCommand* command);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ceka dok se ne upise bar jedna komanda.
+ *
+ * @param queue - [in/out] red
+ *****************************************************************************/
+void renderQueueWait(RenderQueue* queue);
+
+#endif
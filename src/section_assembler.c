@@ -0,0 +1,319 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file section_assembler.c
+ * \brief
+ * Ovaj modul realizuje sastavljanje PSI/SI sekcija iz sirovih transportnih
+ * paketa (188 bajta). Za svaki registrovani PID prate se PUSI, pointer_field,
+ * adaptation field i continuity counter, a svaka kompletna sekcija se
+ * prosljedjuje callback funkciji, na isti nacin kao sto to radi demultiplekser.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "section_assembler.h"
+#include "section_view.h"
+#include "ts_scan.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define TS_HEADER_SIZE 4
+#define NO_CONTINUITY_COUNTER -1
+/* broj paketa koji se odjednom traze sa tsScanPackets */
+#define ASSEMBLER_SCAN_BATCH 256
+
+typedef struct _PidContext
+{
+    uint8_t buffer[SECTION_MAX_SIZE];
+    uint16_t fill; /* broj bajtova sekcije koji su do sada sastavljeni */
+    uint16_t expected; /* ukupna duzina sekcije, 0 dok se ne procita section_length */
+    uint8_t inSection;
+    int8_t lastCc;
+} PidContext;
+
+struct _SectionAssembler
+{
+    Section_Assembler_Callback callback;
+    void* userData;
+    SectionAssemblerStats stats;
+    PidContext* pids[TS_NUM_OF_PIDS];
+};
+
+SectionAssembler* sectionAssemblerCreate(Section_Assembler_Callback callback, void* userData)
+{
+    SectionAssembler* assembler;
+    if (callback == NULL)
+        return NULL;
+    assembler = (SectionAssembler*) calloc(1, sizeof (SectionAssembler));
+    if (assembler == NULL)
+        return NULL;
+    assembler->callback = callback;
+    assembler->userData = userData;
+    return assembler;
+}
+
+void sectionAssemblerDestroy(SectionAssembler* assembler)
+{
+    int32_t i;
+    if (assembler == NULL)
+        return;
+    for (i = 0; i < TS_NUM_OF_PIDS; i++)
+    {
+        free(assembler->pids[i]);
+    }
+    free(assembler);
+}
+
+int32_t sectionAssemblerAddPid(SectionAssembler* assembler, uint16_t pid)
+{
+    PidContext* ctx;
+    if (pid >= TS_NUM_OF_PIDS)
+        return -1;
+    if (assembler->pids[pid] != NULL)
+        return 0;
+    ctx = (PidContext*) malloc(sizeof (PidContext));
+    if (ctx == NULL)
+        return -1;
+    ctx->fill = 0;
+    ctx->expected = 0;
+    ctx->inSection = 0;
+    ctx->lastCc = NO_CONTINUITY_COUNTER;
+    assembler->pids[pid] = ctx;
+    return 0;
+}
+
+void sectionAssemblerRemovePid(SectionAssembler* assembler, uint16_t pid)
+{
+    if (pid >= TS_NUM_OF_PIDS)
+        return;
+    free(assembler->pids[pid]);
+    assembler->pids[pid] = NULL;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja racuna ukupnu duzinu sekcije iz prva tri bajta, ili vraca 0
+ * ako je section_length veci od dozvoljenog.
+ *
+ * @param header - [in] prva tri bajta sekcije
+ * @return ukupna duzina sekcije ili 0
+ *****************************************************************************/
+static uint16_t sectionTotalLength(const uint8_t* header)
+{
+    uint16_t length = (uint16_t) ((((header[1] << 8) + header[2]) & 0x0FFF) + 3);
+    return (length > SECTION_MAX_SIZE) ? 0 : length;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja dodaje dio korisnog sadrzaja paketa sekcijama datog PID-a.
+ * Sekcije koje se u potpunosti nalaze u paketu prosljedjuju se direktno iz
+ * paketa, bez kopiranja; samo sekcije koje prelaze granicu paketa se kopiraju
+ * u bafer PID konteksta.
+ *
+ * @param assembler - [in] sastavljac
+ * @param pid - [in] PID
+ * @param ctx - [in/out] kontekst PID-a
+ * @param data - [in] korisni sadrzaj paketa
+ * @param size - [in] duzina korisnog sadrzaja
+ *****************************************************************************/
+static void pidAssemble(SectionAssembler* assembler, uint16_t pid, PidContext* ctx, const uint8_t* data, uint32_t size)
+{
+    uint32_t take;
+    uint16_t length;
+    while (size > 0)
+    {
+        if (!ctx->inSection)
+        {
+            /* ostatak paketa je stuffing */
+            if (data[0] == 0xFF)
+                return;
+            if (size >= 3)
+            {
+                length = sectionTotalLength(data);
+                if (length == 0)
+                {
+                    assembler->stats.sectionErrors++;
+                    return;
+                }
+                if (length <= size)
+                {
+                    assembler->stats.sections++;
+                    assembler->callback(pid, data, length, assembler->userData);
+                    data += length;
+                    size -= length;
+                    continue;
+                }
+            }
+            ctx->inSection = 1;
+            ctx->fill = 0;
+            ctx->expected = 0;
+        }
+
+        if (ctx->expected == 0)
+        {
+            take = 3 - ctx->fill;
+            take = (take < size) ? take : size;
+            memcpy(ctx->buffer + ctx->fill, data, take);
+            ctx->fill += take;
+            data += take;
+            size -= take;
+            if (ctx->fill < 3)
+                return;
+            ctx->expected = sectionTotalLength(ctx->buffer);
+            if (ctx->expected == 0)
+            {
+                assembler->stats.sectionErrors++;
+                ctx->inSection = 0;
+                return;
+            }
+        }
+
+        take = ctx->expected - ctx->fill;
+        take = (take < size) ? take : size;
+        memcpy(ctx->buffer + ctx->fill, data, take);
+        ctx->fill += take;
+        data += take;
+        size -= take;
+        if (ctx->fill == ctx->expected)
+        {
+            ctx->inSection = 0;
+            assembler->stats.sections++;
+            assembler->callback(pid, ctx->buffer, ctx->expected, assembler->userData);
+        }
+    }
+}
+
+void sectionAssemblerPushPacket(SectionAssembler* assembler, const uint8_t* packet)
+{
+    PidContext* ctx;
+    const uint8_t* payload;
+    uint32_t size;
+    uint16_t pid;
+    uint8_t pusi;
+    uint8_t adaptationControl;
+    uint8_t cc;
+    uint8_t pointer;
+    uint8_t discontinuity = 0;
+
+    assembler->stats.packets++;
+    if (packet[0] != TS_SYNC_BYTE)
+    {
+        assembler->stats.syncErrors++;
+        return;
+    }
+    pid = (uint16_t) (((packet[1] << 8) + packet[2]) & 0x1FFF);
+    ctx = assembler->pids[pid];
+    if (ctx == NULL)
+        return;
+    if (packet[1] & 0x80)
+    {
+        assembler->stats.transportErrors++;
+        ctx->inSection = 0;
+        return;
+    }
+    pusi = (uint8_t) ((packet[1] >> 6) & 0x01);
+    adaptationControl = (uint8_t) ((packet[3] >> 4) & 0x03);
+    cc = (uint8_t) (packet[3] & 0x0F);
+
+    /* paketi bez korisnog sadrzaja ne povecavaju continuity counter */
+    if (!(adaptationControl & 0x01))
+        return;
+
+    payload = packet + TS_HEADER_SIZE;
+    size = TS_PACKET_SIZE - TS_HEADER_SIZE;
+    if (adaptationControl & 0x02)
+    {
+        if (payload[0] >= size)
+            return;
+        if (payload[0] > 0)
+            discontinuity = (uint8_t) (payload[1] & 0x80);
+        size -= payload[0] + 1;
+        payload += payload[0] + 1;
+    }
+
+    if (ctx->lastCc != NO_CONTINUITY_COUNTER && !discontinuity)
+    {
+        /* duplikat paketa se ignorise */
+        if (cc == ctx->lastCc)
+            return;
+        if (cc != ((ctx->lastCc + 1) & 0x0F))
+        {
+            assembler->stats.continuityErrors++;
+            ctx->inSection = 0;
+        }
+    }
+    ctx->lastCc = (int8_t) cc;
+
+    if (pusi)
+    {
+        pointer = payload[0];
+        payload++;
+        size--;
+        if (pointer > size)
+        {
+            assembler->stats.sectionErrors++;
+            ctx->inSection = 0;
+            return;
+        }
+        /* kraj sekcije zapocete u prethodnim paketima */
+        if (ctx->inSection)
+        {
+            pidAssemble(assembler, pid, ctx, payload, pointer);
+            if (ctx->inSection)
+            {
+                assembler->stats.sectionErrors++;
+                ctx->inSection = 0;
+            }
+        }
+        pidAssemble(assembler, pid, ctx, payload + pointer, size - pointer);
+    }
+    else if (ctx->inSection)
+    {
+        pidAssemble(assembler, pid, ctx, payload, size);
+    }
+}
+
+uint32_t sectionAssemblerPush(SectionAssembler* assembler, const uint8_t* data, uint32_t size)
+{
+    uint32_t offsets[ASSEMBLER_SCAN_BATCH];
+    uint16_t pids[ASSEMBLER_SCAN_BATCH];
+    uint32_t offset = 0;
+    uint32_t consumed;
+    uint32_t resyncs;
+    uint32_t count;
+    uint32_t i;
+    do
+    {
+        /* sync i PID se provjeravaju za cijeli niz paketa, a obradjuju se samo trazeni PID-ovi */
+        count = tsScanPackets(data + offset, size - offset, offsets, pids, ASSEMBLER_SCAN_BATCH, &consumed, &resyncs);
+        assembler->stats.syncErrors += resyncs;
+        for (i = 0; i < count; i++)
+        {
+            if (assembler->pids[pids[i]] != NULL)
+                sectionAssemblerPushPacket(assembler, data + offset + offsets[i]);
+            else
+                assembler->stats.packets++;
+        }
+        offset += consumed;
+    }
+    while (count == ASSEMBLER_SCAN_BATCH);
+    return offset;
+}
+
+const SectionAssemblerStats* sectionAssemblerGetStats(const SectionAssembler* assembler)
+{
+    return &(assembler->stats);
+}
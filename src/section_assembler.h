@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file section_assembler.h
+ * \brief
+ * Ovaj modul realizuje sastavljanje PSI/SI sekcija iz sirovih transportnih
+ * paketa (188 bajta). Za svaki registrovani PID prate se PUSI, pointer_field,
+ * adaptation field i continuity counter, a svaka kompletna sekcija se
+ * prosljedjuje callback funkciji, na isti nacin kao sto to radi demultiplekser.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef SECTION_ASSEMBLER_H
+#define SECTION_ASSEMBLER_H
+
+#include <stdint.h>
+
+#define TS_PACKET_SIZE 188
+#define TS_SYNC_BYTE 0x47
+#define TS_NUM_OF_PIDS 8192
+#define TS_NULL_PID 0x1FFF
+
+/****************************************************************************
+ *
+ * @brief
+ * Tip callback funkcije koja se poziva za svaku kompletnu sekciju. Bafer je
+ * validan samo za vrijeme trajanja poziva.
+ *
+ * @param pid - [in] PID na kome je sekcija primljena
+ * @param section - [in] sekcija (pocinje sa table_id)
+ * @param length - [in] duzina sekcije u bajtovima (3 + section_length)
+ * @param userData - [in] pokazivac proslijedjen pri kreiranju
+ * @return 0 ako nema greske
+ *****************************************************************************/
+typedef int32_t(*Section_Assembler_Callback)(uint16_t pid, const uint8_t* section, uint16_t length, void* userData);
+
+typedef struct _SectionAssemblerStats
+{
+    uint64_t packets; /* ukupan broj primljenih paketa */
+    uint64_t sections; /* broj kompletnih sekcija */
+    uint32_t syncErrors; /* paketi bez 0x47 sync bajta */
+    uint32_t transportErrors; /* paketi sa postavljenim transport_error_indicator */
+    uint32_t continuityErrors; /* prekidi continuity counter-a */
+    uint32_t sectionErrors; /* neispravne duzine sekcija */
+} SectionAssemblerStats;
+
+typedef struct _SectionAssembler SectionAssembler;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja kreira sastavljac sekcija.
+ *
+ * @param callback - [in] funkcija koja ce biti pozvana za svaku kompletnu sekciju
+ * @param userData - [in] pokazivac koji se prosljedjuje callback funkciji
+ * @return pokazivac na sastavljac, NULL u slucaju greske
+ *****************************************************************************/
+SectionAssembler* sectionAssemblerCreate(Section_Assembler_Callback callback, void* userData);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja oslobadja sastavljac sekcija i sve njegove PID kontekste.
+ *
+ * @param assembler - [in] sastavljac
+ *****************************************************************************/
+void sectionAssemblerDestroy(SectionAssembler* assembler);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ukljucuje sastavljanje sekcija za zadati PID.
+ *
+ * @param assembler - [in] sastavljac
+ * @param pid - [in] PID na kome se ocekuju sekcije
+ * @return 0 ako nema greske, -1 u slucaju greske
+ *****************************************************************************/
+int32_t sectionAssemblerAddPid(SectionAssembler* assembler, uint16_t pid);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja iskljucuje sastavljanje sekcija za zadati PID.
+ *
+ * @param assembler - [in] sastavljac
+ * @param pid - [in] PID
+ *****************************************************************************/
+void sectionAssemblerRemovePid(SectionAssembler* assembler, uint16_t pid);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja obradjuje jedan transportni paket.
+ *
+ * @param assembler - [in] sastavljac
+ * @param packet - [in] paket duzine TS_PACKET_SIZE
+ *****************************************************************************/
+void sectionAssemblerPushPacket(SectionAssembler* assembler, const uint8_t* packet);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja obradjuje niz uzastopnih transportnih paketa. Ako se u nizu
+ * izgubi sinhronizacija, trazi se sljedeci sync bajat.
+ *
+ * @param assembler - [in] sastavljac
+ * @param data - [in] niz paketa
+ * @param size - [in] duzina niza u bajtovima
+ * @return broj obradjenih bajtova (ostatak manji od paketa ostaje neobradjen)
+ *****************************************************************************/
+uint32_t sectionAssemblerPush(SectionAssembler* assembler, const uint8_t* data, uint32_t size);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca statistiku sastavljaca.
+ *
+ * @param assembler - [in] sastavljac
+ * @return pokazivac na statistiku
+ *****************************************************************************/
+const SectionAssemblerStats* sectionAssemblerGetStats(const SectionAssembler* assembler);
+
+#endif
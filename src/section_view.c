@@ -0,0 +1,400 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file section_view.c
+ * \brief
+ * Ovaj modul realizuje pogled (view) na PSI/SI sekciju koja se nalazi u baferu
+ * demultipleksera. Sekcija se validira samo jednom (duzina, sintaksa, CRC), a
+ * nakon toga se preko iteratora citaju programi PAT tabele, elementarni
+ * tokovi PMT tabele i deskriptori, direktno iz bafera, bez kopiranja i
+ * alokacije memorije.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "section_view.h"
+#include "crc32.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* PMT: pcr_pid (2) + program_info_length (2) nakon dugog zaglavlja */
+#define PMT_FIXED_FIELDS_SIZE 4
+#define PAT_PROGRAM_SIZE 4
+#define PMT_STREAM_HEADER_SIZE 5
+/* NIT: network_descriptors_length, pa transport_stream_loop_length */
+#define NIT_LOOP_LENGTH_SIZE 2
+#define NIT_TS_HEADER_SIZE 6
+/* SDT: original_network_id + reserved_future_use */
+#define SDT_FIXED_FIELDS_SIZE 3
+#define SDT_SERVICE_HEADER_SIZE 5
+/* EIT: transport_stream_id, original_network_id, segment_last_section_number, last_table_id */
+#define EIT_FIXED_FIELDS_SIZE 6
+#define EIT_EVENT_HEADER_SIZE 12
+
+int32_t sectionViewInit(SectionView* view, const uint8_t* buffer, uint32_t bufferSize)
+{
+    uint16_t maxLength;
+    const uint8_t* crc;
+    if (buffer == NULL || bufferSize < 3)
+        return SECTION_ERROR_TRUNCATED;
+
+    view->data = buffer;
+    view->table_id = buffer[0];
+    view->section_syntax_indicator = (uint8_t) (buffer[1] >> 7);
+    view->section_length = (uint16_t) (((buffer[1] << 8) + buffer[2]) & 0x0FFF);
+    view->size = (uint16_t) (view->section_length + 3);
+    view->table_id_extension = 0;
+    view->version_number = 0;
+    view->current_next_indicator = 1;
+    view->section_number = 0;
+    view->last_section_number = 0;
+    view->crc = 0;
+
+    /* PAT, CAT i PMT su ograniceni na 1024 bajta, ostale tabele na 4096 */
+    maxLength = (view->table_id <= 0x03) ? PSI_SECTION_MAX_SIZE - 3 : SECTION_MAX_SIZE - 3;
+    if (view->section_length > maxLength)
+        return SECTION_ERROR_LENGTH;
+    if (view->size > bufferSize)
+        return SECTION_ERROR_TRUNCATED;
+
+    if (view->section_syntax_indicator == 0)
+        return SECTION_OK;
+
+    if (view->size < SECTION_LONG_HEADER_SIZE + SECTION_CRC_SIZE)
+        return SECTION_ERROR_LENGTH;
+
+    view->table_id_extension = (uint16_t) ((buffer[3] << 8) + buffer[4]);
+    view->version_number = (uint8_t) ((buffer[5] >> 1) & 0x1F);
+    view->current_next_indicator = (uint8_t) (buffer[5] & 0x01);
+    view->section_number = buffer[6];
+    view->last_section_number = buffer[7];
+    if (view->section_number > view->last_section_number)
+        return SECTION_ERROR_SYNTAX;
+
+    crc = buffer + view->size - SECTION_CRC_SIZE;
+    view->crc = ((uint32_t) crc[0] << 24) | ((uint32_t) crc[1] << 16) | ((uint32_t) crc[2] << 8) | crc[3];
+    if (crc32Mpeg2(buffer, view->size) != 0)
+        return SECTION_ERROR_CRC;
+
+    return SECTION_OK;
+}
+
+const uint8_t* sectionViewPayload(const SectionView* view, uint16_t* length)
+{
+    if (view->section_syntax_indicator == 0)
+    {
+        *length = (uint16_t) (view->size - 3);
+        return view->data + 3;
+    }
+    *length = (uint16_t) (view->size - SECTION_LONG_HEADER_SIZE - SECTION_CRC_SIZE);
+    return view->data + SECTION_LONG_HEADER_SIZE;
+}
+
+int32_t patProgramIteratorInit(const SectionView* view, PatProgramIterator* it)
+{
+    uint16_t length;
+    it->pos = it->end = NULL;
+    if (view->table_id != PAT_TABLE_ID || view->section_syntax_indicator == 0)
+        return SECTION_ERROR_SYNTAX;
+    it->pos = sectionViewPayload(view, &length);
+    it->end = it->pos + length;
+    return SECTION_OK;
+}
+
+int32_t patProgramNext(PatProgramIterator* it, uint16_t* program_number, uint16_t* pid)
+{
+    if (it->end - it->pos < PAT_PROGRAM_SIZE)
+        return 0;
+    *program_number = (uint16_t) ((it->pos[0] << 8) + it->pos[1]);
+    *pid = (uint16_t) (((it->pos[2] << 8) + it->pos[3]) & 0x1FFF);
+    it->pos += PAT_PROGRAM_SIZE;
+    return 1;
+}
+
+uint16_t pmtPcrPid(const SectionView* view)
+{
+    return (uint16_t) (((view->data[8] << 8) + view->data[9]) & 0x1FFF);
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca duzinu program_info petlje PMT sekcije, ili -1 ako
+ * sekcija nije PMT ili petlja izlazi van tijela sekcije.
+ *
+ * @param view - [in] validiran pogled na PMT sekciju
+ * @return program_info_length ili -1
+ *****************************************************************************/
+static int32_t pmtProgramInfoLength(const SectionView* view)
+{
+    uint16_t length;
+    uint16_t programInfoLength;
+    if (view->table_id != PMT_TABLE_ID || view->section_syntax_indicator == 0)
+        return -1;
+    sectionViewPayload(view, &length);
+    if (length < PMT_FIXED_FIELDS_SIZE)
+        return -1;
+    programInfoLength = (uint16_t) (((view->data[10] << 8) + view->data[11]) & 0x0FFF);
+    if (programInfoLength > length - PMT_FIXED_FIELDS_SIZE)
+        return -1;
+    return programInfoLength;
+}
+
+int32_t pmtProgramDescriptors(const SectionView* view, DescriptorIterator* it)
+{
+    int32_t programInfoLength = pmtProgramInfoLength(view);
+    if (programInfoLength < 0)
+    {
+        descriptorIteratorInit(it, NULL, 0);
+        return SECTION_ERROR_SYNTAX;
+    }
+    descriptorIteratorInit(it, view->data + SECTION_LONG_HEADER_SIZE + PMT_FIXED_FIELDS_SIZE, (uint16_t) programInfoLength);
+    return SECTION_OK;
+}
+
+int32_t pmtStreamIteratorInit(const SectionView* view, PmtStreamIterator* it)
+{
+    uint16_t length;
+    const uint8_t* payload;
+    int32_t programInfoLength = pmtProgramInfoLength(view);
+    it->pos = it->end = NULL;
+    if (programInfoLength < 0)
+        return SECTION_ERROR_SYNTAX;
+    payload = sectionViewPayload(view, &length);
+    it->pos = payload + PMT_FIXED_FIELDS_SIZE + programInfoLength;
+    it->end = payload + length;
+    return SECTION_OK;
+}
+
+int32_t pmtStreamNext(PmtStreamIterator* it, PmtStreamView* stream)
+{
+    uint16_t esInfoLength;
+    if (it->end - it->pos < PMT_STREAM_HEADER_SIZE)
+        return 0;
+    esInfoLength = (uint16_t) (((it->pos[3] << 8) + it->pos[4]) & 0x0FFF);
+    if (esInfoLength > it->end - it->pos - PMT_STREAM_HEADER_SIZE)
+    {
+        it->pos = it->end;
+        return 0;
+    }
+    stream->stream_type = it->pos[0];
+    stream->el_pid = (uint16_t) (((it->pos[1] << 8) + it->pos[2]) & 0x1FFF);
+    stream->es_info_length = esInfoLength;
+    stream->es_info = it->pos + PMT_STREAM_HEADER_SIZE;
+    it->pos += PMT_STREAM_HEADER_SIZE + esInfoLength;
+    return 1;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca duzinu network_descriptors petlje NIT sekcije, ili -1
+ * ako sekcija nije NIT ili petlja izlazi van tijela sekcije.
+ *
+ * @param view - [in] validiran pogled na NIT sekciju
+ * @return network_descriptors_length ili -1
+ *****************************************************************************/
+static int32_t nitNetworkDescriptorsLength(const SectionView* view)
+{
+    uint16_t length;
+    const uint8_t* payload;
+    uint16_t descriptorsLength;
+    if ((view->table_id != NIT_ACTUAL_TABLE_ID && view->table_id != NIT_OTHER_TABLE_ID) ||
+            view->section_syntax_indicator == 0)
+        return -1;
+    payload = sectionViewPayload(view, &length);
+    if (length < NIT_LOOP_LENGTH_SIZE)
+        return -1;
+    descriptorsLength = (uint16_t) (((payload[0] << 8) + payload[1]) & 0x0FFF);
+    if (descriptorsLength > length - NIT_LOOP_LENGTH_SIZE)
+        return -1;
+    return descriptorsLength;
+}
+
+int32_t nitNetworkDescriptors(const SectionView* view, DescriptorIterator* it)
+{
+    int32_t descriptorsLength = nitNetworkDescriptorsLength(view);
+    if (descriptorsLength < 0)
+    {
+        descriptorIteratorInit(it, NULL, 0);
+        return SECTION_ERROR_SYNTAX;
+    }
+    descriptorIteratorInit(it, view->data + SECTION_LONG_HEADER_SIZE + NIT_LOOP_LENGTH_SIZE, (uint16_t) descriptorsLength);
+    return SECTION_OK;
+}
+
+int32_t nitTransportStreamIteratorInit(const SectionView* view, NitTransportStreamIterator* it)
+{
+    uint16_t length;
+    uint16_t loopLength;
+    const uint8_t* payload;
+    const uint8_t* loop;
+    int32_t descriptorsLength = nitNetworkDescriptorsLength(view);
+    it->pos = it->end = NULL;
+    if (descriptorsLength < 0)
+        return SECTION_ERROR_SYNTAX;
+    payload = sectionViewPayload(view, &length);
+    if (length < 2 * NIT_LOOP_LENGTH_SIZE + descriptorsLength)
+        return SECTION_ERROR_SYNTAX;
+    loop = payload + NIT_LOOP_LENGTH_SIZE + descriptorsLength;
+    loopLength = (uint16_t) (((loop[0] << 8) + loop[1]) & 0x0FFF);
+    if (loopLength > payload + length - loop - NIT_LOOP_LENGTH_SIZE)
+        return SECTION_ERROR_SYNTAX;
+    it->pos = loop + NIT_LOOP_LENGTH_SIZE;
+    it->end = it->pos + loopLength;
+    return SECTION_OK;
+}
+
+int32_t nitTransportStreamNext(NitTransportStreamIterator* it, NitTransportStreamView* ts)
+{
+    uint16_t descriptorsLength;
+    if (it->end - it->pos < NIT_TS_HEADER_SIZE)
+        return 0;
+    descriptorsLength = (uint16_t) (((it->pos[4] << 8) + it->pos[5]) & 0x0FFF);
+    if (descriptorsLength > it->end - it->pos - NIT_TS_HEADER_SIZE)
+    {
+        it->pos = it->end;
+        return 0;
+    }
+    ts->transport_stream_id = (uint16_t) ((it->pos[0] << 8) + it->pos[1]);
+    ts->original_network_id = (uint16_t) ((it->pos[2] << 8) + it->pos[3]);
+    ts->transport_descriptors_length = descriptorsLength;
+    ts->descriptors = it->pos + NIT_TS_HEADER_SIZE;
+    it->pos += NIT_TS_HEADER_SIZE + descriptorsLength;
+    return 1;
+}
+
+int32_t sdtServiceIteratorInit(const SectionView* view, SdtServiceIterator* it)
+{
+    uint16_t length;
+    const uint8_t* payload;
+    it->pos = it->end = NULL;
+    if ((view->table_id != SDT_ACTUAL_TABLE_ID && view->table_id != SDT_OTHER_TABLE_ID) ||
+            view->section_syntax_indicator == 0)
+        return SECTION_ERROR_SYNTAX;
+    payload = sectionViewPayload(view, &length);
+    if (length < SDT_FIXED_FIELDS_SIZE)
+        return SECTION_ERROR_SYNTAX;
+    it->pos = payload + SDT_FIXED_FIELDS_SIZE;
+    it->end = payload + length;
+    return SECTION_OK;
+}
+
+int32_t sdtServiceNext(SdtServiceIterator* it, SdtServiceView* service)
+{
+    uint16_t loopLength;
+    if (it->end - it->pos < SDT_SERVICE_HEADER_SIZE)
+        return 0;
+    loopLength = (uint16_t) (((it->pos[3] << 8) + it->pos[4]) & 0x0FFF);
+    if (loopLength > it->end - it->pos - SDT_SERVICE_HEADER_SIZE)
+    {
+        it->pos = it->end;
+        return 0;
+    }
+    service->service_id = (uint16_t) ((it->pos[0] << 8) + it->pos[1]);
+    service->EIT_schedule_flag = (uint8_t) ((it->pos[2] >> 1) & 0x01);
+    service->EIT_present_following_flag = (uint8_t) (it->pos[2] & 0x01);
+    service->running_status = (uint8_t) (it->pos[3] >> 5);
+    service->free_CA_mode = (uint8_t) ((it->pos[3] >> 4) & 0x01);
+    service->descriptors_loop_length = loopLength;
+    service->descriptors = it->pos + SDT_SERVICE_HEADER_SIZE;
+    it->pos += SDT_SERVICE_HEADER_SIZE + loopLength;
+    return 1;
+}
+
+int32_t eitEventIteratorInit(const SectionView* view, EitEventIterator* it)
+{
+    uint16_t length;
+    const uint8_t* payload;
+    it->pos = it->end = NULL;
+    if (view->table_id < EIT_PF_ACTUAL_TABLE_ID || view->table_id > EIT_SCHEDULE_LAST_TABLE_ID ||
+            view->section_syntax_indicator == 0)
+        return SECTION_ERROR_SYNTAX;
+    payload = sectionViewPayload(view, &length);
+    if (length < EIT_FIXED_FIELDS_SIZE)
+        return SECTION_ERROR_SYNTAX;
+    it->pos = payload + EIT_FIXED_FIELDS_SIZE;
+    it->end = payload + length;
+    return SECTION_OK;
+}
+
+int32_t eitEventNext(EitEventIterator* it, EitEventView* event)
+{
+    uint16_t loopLength;
+    if (it->end - it->pos < EIT_EVENT_HEADER_SIZE)
+        return 0;
+    loopLength = (uint16_t) (((it->pos[10] << 8) + it->pos[11]) & 0x0FFF);
+    if (loopLength > it->end - it->pos - EIT_EVENT_HEADER_SIZE)
+    {
+        it->pos = it->end;
+        return 0;
+    }
+    event->event_id = (uint16_t) ((it->pos[0] << 8) + it->pos[1]);
+    event->start_time = it->pos + 2;
+    event->duration = it->pos + 7;
+    event->running_status = (uint8_t) (it->pos[10] >> 5);
+    event->free_CA_mode = (uint8_t) ((it->pos[10] >> 4) & 0x01);
+    event->descriptors_loop_length = loopLength;
+    event->descriptors = it->pos + EIT_EVENT_HEADER_SIZE;
+    it->pos += EIT_EVENT_HEADER_SIZE + loopLength;
+    return 1;
+}
+
+void descriptorIteratorInit(DescriptorIterator* it, const uint8_t* loop, uint16_t length)
+{
+    it->pos = loop;
+    it->end = (loop != NULL) ? loop + length : NULL;
+}
+
+int32_t descriptorNext(DescriptorIterator* it, DescriptorView* descriptor)
+{
+    if (it->end - it->pos < 2)
+        return 0;
+    if (it->pos[1] > it->end - it->pos - 2)
+    {
+        it->pos = it->end;
+        return 0;
+    }
+    descriptor->tag = it->pos[0];
+    descriptor->length = it->pos[1];
+    descriptor->data = it->pos + 2;
+    it->pos += 2 + descriptor->length;
+    return 1;
+}
+
+void descriptorDispatchInit(DescriptorDispatchTable* table)
+{
+    uint32_t i;
+    for (i = 0; i < 256; i++)
+    {
+        table->handlers[i] = NULL;
+    }
+}
+
+void descriptorDispatchRegister(DescriptorDispatchTable* table, uint8_t tag, Descriptor_Handler handler)
+{
+    table->handlers[tag] = handler;
+}
+
+uint32_t descriptorDispatch(const DescriptorDispatchTable* table, const uint8_t* loop, uint16_t length, void* userData)
+{
+    DescriptorIterator it;
+    DescriptorView descriptor;
+    uint32_t handled = 0;
+    descriptorIteratorInit(&it, loop, length);
+    while (descriptorNext(&it, &descriptor))
+    {
+        if (table->handlers[descriptor.tag] != NULL && table->handlers[descriptor.tag](&descriptor, userData) == 0)
+            handled++;
+    }
+    return handled;
+}
@@ -0,0 +1,397 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file section_view.h
+ * \brief
+ * Ovaj modul realizuje pogled (view) na PSI/SI sekciju koja se nalazi u baferu
+ * demultipleksera. Sekcija se validira samo jednom (duzina, sintaksa, CRC), a
+ * nakon toga se preko iteratora citaju programi PAT tabele, elementarni
+ * tokovi PMT tabele i deskriptori, direktno iz bafera, bez kopiranja i
+ * alokacije memorije.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef SECTION_VIEW_H
+#define SECTION_VIEW_H
+
+#include <stdint.h>
+
+/* maksimalna duzina PSI sekcije (PAT, PMT, CAT) ukljucujuci 3 bajta zaglavlja */
+#define PSI_SECTION_MAX_SIZE 1024
+/* maksimalna duzina privatne sekcije (SDT, NIT, EIT) ukljucujuci 3 bajta zaglavlja */
+#define SECTION_MAX_SIZE 4096
+/* duzina dugog zaglavlja (table_id .. last_section_number) */
+#define SECTION_LONG_HEADER_SIZE 8
+#define SECTION_CRC_SIZE 4
+
+#define PAT_TABLE_ID 0x00
+#define PMT_TABLE_ID 0x02
+#define NIT_ACTUAL_TABLE_ID 0x40
+#define NIT_OTHER_TABLE_ID 0x41
+#define SDT_ACTUAL_TABLE_ID 0x42
+#define SDT_OTHER_TABLE_ID 0x46
+#define EIT_PF_ACTUAL_TABLE_ID 0x4E
+#define EIT_PF_OTHER_TABLE_ID 0x4F
+#define EIT_SCHEDULE_FIRST_TABLE_ID 0x50
+#define EIT_SCHEDULE_LAST_TABLE_ID 0x6F
+
+typedef enum _SectionStatus
+{
+    SECTION_OK = 0,
+    SECTION_ERROR_TRUNCATED = -1, /* bafer je kraci od zaglavlja ili od section_length */
+    SECTION_ERROR_LENGTH = -2, /* section_length van dozvoljenog opsega */
+    SECTION_ERROR_SYNTAX = -3, /* neispravna struktura sekcije */
+    SECTION_ERROR_CRC = -4 /* CRC_32 se ne poklapa */
+} SectionStatus;
+
+typedef struct _SectionView
+{
+    const uint8_t* data; /* pocetak sekcije (table_id) u baferu demultipleksera */
+    uint16_t size; /* ukupna duzina sekcije: 3 + section_length */
+    uint8_t table_id;
+    uint8_t section_syntax_indicator;
+    uint16_t section_length;
+    uint16_t table_id_extension; /* transport_stream_id, program_number, service_id... */
+    uint8_t version_number;
+    uint8_t current_next_indicator;
+    uint8_t section_number;
+    uint8_t last_section_number;
+    uint32_t crc; /* CRC_32 sa kraja sekcije */
+} SectionView;
+
+typedef struct _DescriptorView
+{
+    uint8_t tag;
+    uint8_t length;
+    const uint8_t* data; /* sadrzaj deskriptora, bez tag i length bajtova */
+} DescriptorView;
+
+typedef struct _DescriptorIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} DescriptorIterator;
+
+/* obrada jednog deskriptora; userData je struktura koju parser popunjava */
+typedef int32_t(*Descriptor_Handler)(const DescriptorView* descriptor, void* userData);
+
+typedef struct _DescriptorDispatchTable
+{
+    Descriptor_Handler handlers[256]; /* indeksirano po descriptor_tag, NULL za tagove koji se preskacu */
+} DescriptorDispatchTable;
+
+typedef struct _PatProgramIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} PatProgramIterator;
+
+typedef struct _PmtStreamView
+{
+    uint8_t stream_type;
+    uint16_t el_pid;
+    uint16_t es_info_length;
+    const uint8_t* es_info; /* pocetak petlje deskriptora elementarnog toka */
+} PmtStreamView;
+
+typedef struct _PmtStreamIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} PmtStreamIterator;
+
+typedef struct _NitTransportStreamView
+{
+    uint16_t transport_stream_id;
+    uint16_t original_network_id;
+    uint16_t transport_descriptors_length;
+    const uint8_t* descriptors;
+} NitTransportStreamView;
+
+typedef struct _NitTransportStreamIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} NitTransportStreamIterator;
+
+typedef struct _SdtServiceView
+{
+    uint16_t service_id;
+    uint8_t EIT_schedule_flag;
+    uint8_t EIT_present_following_flag;
+    uint8_t running_status;
+    uint8_t free_CA_mode;
+    uint16_t descriptors_loop_length;
+    const uint8_t* descriptors;
+} SdtServiceView;
+
+typedef struct _SdtServiceIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} SdtServiceIterator;
+
+typedef struct _EitEventView
+{
+    uint16_t event_id;
+    const uint8_t* start_time; /* 40 bita: MJD (16) + UTC u BCD (24) */
+    const uint8_t* duration; /* 24 bita BCD: hh mm ss */
+    uint8_t running_status;
+    uint8_t free_CA_mode;
+    uint16_t descriptors_loop_length;
+    const uint8_t* descriptors;
+} EitEventView;
+
+typedef struct _EitEventIterator
+{
+    const uint8_t* pos;
+    const uint8_t* end;
+} EitEventIterator;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja validira sekciju u baferu i popunjava pogled na nju. Provjerava
+ * se da li zaglavlje i cijela sekcija staju u bafer, da li je section_length u
+ * dozvoljenom opsegu i, za sekcije sa dugim zaglavljem, CRC_32.
+ *
+ * @param view - [out] pogled na sekciju
+ * @param buffer - [in] bafer u kome se nalazi sekcija (pocinje sa table_id)
+ * @param bufferSize - [in] broj bajtova koji se smiju procitati iz bafera
+ * @return SECTION_OK, ako je sekcija ispravna, odgovarajuci SectionStatus u suprotnom
+ *****************************************************************************/
+int32_t sectionViewInit(SectionView* view, const uint8_t* buffer, uint32_t bufferSize);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca pokazivac na tijelo sekcije (prvi bajt nakon dugog
+ * zaglavlja) i njegovu duzinu bez CRC_32 polja.
+ *
+ * @param view - [in] validiran pogled na sekciju
+ * @param length - [out] duzina tijela sekcije
+ * @return pokazivac na tijelo sekcije
+ *****************************************************************************/
+const uint8_t* sectionViewPayload(const SectionView* view, uint16_t* length);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad nizom programa PAT tabele.
+ *
+ * @param view - [in] validiran pogled na PAT sekciju
+ * @param it - [out] iterator
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije PAT
+ *****************************************************************************/
+int32_t patProgramIteratorInit(const SectionView* view, PatProgramIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci program iz PAT tabele.
+ *
+ * @param it - [in/out] iterator
+ * @param program_number - [out] broj programa (0 oznacava NIT)
+ * @param pid - [out] PID PMT tabele programa (ili NIT)
+ * @return 1 ako je procitan program, 0 na kraju niza
+ *****************************************************************************/
+int32_t patProgramNext(PatProgramIterator* it, uint16_t* program_number, uint16_t* pid);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca PCR PID iz PMT sekcije.
+ *
+ * @param view - [in] validiran pogled na PMT sekciju
+ * @return PCR PID
+ *****************************************************************************/
+uint16_t pmtPcrPid(const SectionView* view);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad deskriptorima programa u PMT sekciji
+ * (program_info petlja).
+ *
+ * @param view - [in] validiran pogled na PMT sekciju
+ * @param it - [out] iterator deskriptora
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako program_info_length izlazi van sekcije
+ *****************************************************************************/
+int32_t pmtProgramDescriptors(const SectionView* view, DescriptorIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad elementarnim tokovima PMT sekcije.
+ *
+ * @param view - [in] validiran pogled na PMT sekciju
+ * @param it - [out] iterator
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije ispravna PMT
+ *****************************************************************************/
+int32_t pmtStreamIteratorInit(const SectionView* view, PmtStreamIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci elementarni tok iz PMT sekcije. Elementarni tok
+ * cija petlja deskriptora izlazi van sekcije prekida iteraciju.
+ *
+ * @param it - [in/out] iterator
+ * @param stream - [out] pogled na elementarni tok
+ * @return 1 ako je procitan elementarni tok, 0 na kraju niza
+ *****************************************************************************/
+int32_t pmtStreamNext(PmtStreamIterator* it, PmtStreamView* stream);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad deskriptorima mreze u NIT sekciji
+ * (network_descriptors petlja, npr. network_name deskriptor).
+ *
+ * @param view - [in] validiran pogled na NIT sekciju
+ * @param it - [out] iterator deskriptora
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije ispravna NIT
+ *****************************************************************************/
+int32_t nitNetworkDescriptors(const SectionView* view, DescriptorIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad transportnim tokovima NIT sekcije.
+ *
+ * @param view - [in] validiran pogled na NIT sekciju (table_id 0x40 ili 0x41)
+ * @param it - [out] iterator
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije ispravna NIT
+ *****************************************************************************/
+int32_t nitTransportStreamIteratorInit(const SectionView* view, NitTransportStreamIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci transportni tok iz NIT sekcije. Transportni tok
+ * cija petlja deskriptora izlazi van sekcije prekida iteraciju.
+ *
+ * @param it - [in/out] iterator
+ * @param ts - [out] pogled na transportni tok
+ * @return 1 ako je procitan transportni tok, 0 na kraju niza
+ *****************************************************************************/
+int32_t nitTransportStreamNext(NitTransportStreamIterator* it, NitTransportStreamView* ts);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad servisima SDT sekcije
+ * (table_id 0x42 ili 0x46).
+ *
+ * @param view - [in] validiran pogled na SDT sekciju
+ * @param it - [out] iterator
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije ispravna SDT
+ *****************************************************************************/
+int32_t sdtServiceIteratorInit(const SectionView* view, SdtServiceIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci servis iz SDT sekcije. Servis cija petlja
+ * deskriptora izlazi van sekcije prekida iteraciju.
+ *
+ * @param it - [in/out] iterator
+ * @param service - [out] pogled na servis
+ * @return 1 ako je procitan servis, 0 na kraju niza
+ *****************************************************************************/
+int32_t sdtServiceNext(SdtServiceIterator* it, SdtServiceView* service);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad dogadjajima EIT sekcije
+ * (present/following i schedule, table_id 0x4E - 0x6F).
+ *
+ * @param view - [in] validiran pogled na EIT sekciju
+ * @param it - [out] iterator
+ * @return SECTION_OK, ili SECTION_ERROR_SYNTAX ako sekcija nije ispravna EIT
+ *****************************************************************************/
+int32_t eitEventIteratorInit(const SectionView* view, EitEventIterator* it);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci dogadjaj iz EIT sekcije. Dogadjaj cija petlja
+ * deskriptora izlazi van sekcije prekida iteraciju.
+ *
+ * @param it - [in/out] iterator
+ * @param event - [out] pogled na dogadjaj
+ * @return 1 ako je procitan dogadjaj, 0 na kraju niza
+ *****************************************************************************/
+int32_t eitEventNext(EitEventIterator* it, EitEventView* event);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje iterator nad petljom deskriptora.
+ *
+ * @param it - [out] iterator
+ * @param loop - [in] pocetak petlje deskriptora
+ * @param length - [in] duzina petlje u bajtovima
+ *****************************************************************************/
+void descriptorIteratorInit(DescriptorIterator* it, const uint8_t* loop, uint16_t length);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita sljedeci deskriptor iz petlje. Deskriptor ciji sadrzaj
+ * izlazi van petlje prekida iteraciju.
+ *
+ * @param it - [in/out] iterator
+ * @param descriptor - [out] pogled na deskriptor
+ * @return 1 ako je procitan deskriptor, 0 na kraju petlje
+ *****************************************************************************/
+int32_t descriptorNext(DescriptorIterator* it, DescriptorView* descriptor);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja inicijalizuje praznu tabelu obrade deskriptora.
+ *
+ * @param table - [out] tabela obrade deskriptora
+ *****************************************************************************/
+void descriptorDispatchInit(DescriptorDispatchTable* table);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja registruje funkciju za obradu deskriptora sa datim tagom.
+ *
+ * @param table - [in/out] tabela obrade deskriptora
+ * @param tag - [in] descriptor_tag
+ * @param handler - [in] funkcija za obradu, NULL da se tag preskace
+ *****************************************************************************/
+void descriptorDispatchRegister(DescriptorDispatchTable* table, uint8_t tag, Descriptor_Handler handler);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja u jednom prolazu kroz petlju deskriptora poziva registrovanu
+ * funkciju za svaki deskriptor ciji je tag registrovan. Ostali deskriptori se
+ * preskacu bez dekodovanja.
+ *
+ * @param table - [in] tabela obrade deskriptora
+ * @param loop - [in] pocetak petlje deskriptora
+ * @param length - [in] duzina petlje u bajtovima
+ * @param userData - [in/out] podaci koji se prosljedjuju funkcijama za obradu
+ * @return broj obradjenih deskriptora
+ *****************************************************************************/
+uint32_t descriptorDispatch(const DescriptorDispatchTable* table, const uint8_t* loop, uint16_t length, void* userData);
+
+#endif
@@ -0,0 +1,157 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file service_cache.c
+ * \brief
+ * Ovaj modul cuva podatke o servisima iz SDT tabele. Servisi se smjestaju u
+ * hes tabelu sa linearnim probanjem; uz svaki servis se pamti broj i verzija
+ * SDT sekcije iz koje je upisan, pa nova verzija sekcije uklanja servise
+ * koje vise ne nosi.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "service_cache.h"
+#include "service_slot.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#define SERVICE_CACHE_SLOTS SERVICE_SLOT_COUNT(SERVICE_CACHE_MAX_SERVICES)
+
+typedef struct _ServiceCacheEntry
+{
+    ServiceSlotKey key; // ulaz ostaje zauzet i kad servis vise ne postoji
+    uint8_t present; // servis postoji u posljednjoj verziji svoje sekcije
+    uint8_t section_number;
+    uint8_t version_number;
+    ServiceInfo info;
+} ServiceCacheEntry;
+
+static ServiceCacheEntry entries[SERVICE_CACHE_SLOTS];
+static uint32_t entryCount = 0;
+static pthread_mutex_t serviceCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi ulaz servisa, ili prazan ulaz u koji servis treba
+ * upisati. Poziva se sa zakljucanim serviceCacheMutex.
+ *
+ * @param service_id - [in] service_id
+ * @return pokazivac na ulaz, NULL ako je tabela puna
+ *****************************************************************************/
+static ServiceCacheEntry* serviceCacheFind(uint16_t service_id)
+{
+    int32_t slot = serviceSlotFind(&(entries[0].key), sizeof (entries[0]), SERVICE_CACHE_SLOTS, service_id);
+    return (slot < 0) ? NULL : &entries[slot];
+}
+
+void serviceCacheReset(void)
+{
+    pthread_mutex_lock(&serviceCacheMutex);
+    memset(entries, 0, sizeof (entries));
+    entryCount = 0;
+    pthread_mutex_unlock(&serviceCacheMutex);
+}
+
+int32_t serviceCacheUpdate(const SdtTable* table)
+{
+    ServiceCacheEntry* entry;
+    const SdtService* service;
+    int32_t result = 0;
+    uint32_t i;
+    if (table->header.table_id != SDT_ACTUAL_TABLE_ID || !table->header.current_next_indicator)
+        return -1;
+
+    pthread_mutex_lock(&serviceCacheMutex);
+    for (i = 0; i < table->serviceCount; i++)
+    {
+        service = &(table->services[i]);
+        entry = serviceCacheFind(service->service_id);
+        if (entry == NULL || (!entry->key.used && entryCount >= SERVICE_CACHE_MAX_SERVICES))
+        {
+            result = -1;
+            continue;
+        }
+        if (!entry->key.used)
+        {
+            entry->key.used = 1;
+            entry->key.service_id = service->service_id;
+            entryCount++;
+        }
+        entry->present = 1;
+        entry->section_number = table->header.section_number;
+        entry->version_number = table->header.version_number;
+        entry->info.service_id = service->service_id;
+        entry->info.free_CA_mode = service->free_CA_mode;
+        entry->info.running_status = service->running_status;
+        entry->info.service_type = 0;
+        entry->info.name[0] = '\0';
+        entry->info.provider[0] = '\0';
+        if (service->hasServiceDescriptor)
+        {
+            entry->info.service_type = service->serviceDescriptor.service_type;
+            dvbStringCopy(entry->info.name, sizeof (entry->info.name), service->serviceDescriptor.service_name, service->serviceDescriptor.service_name_length);
+            dvbStringCopy(entry->info.provider, sizeof (entry->info.provider), service->serviceDescriptor.provider_name, service->serviceDescriptor.provider_name_length);
+        }
+    }
+    // services carried by an older version of this section are gone
+    for (i = 0; i < SERVICE_CACHE_SLOTS; i++)
+    {
+        if (entries[i].present && entries[i].section_number == table->header.section_number &&
+                entries[i].version_number != table->header.version_number)
+        {
+            entries[i].present = 0;
+        }
+    }
+    pthread_mutex_unlock(&serviceCacheMutex);
+    return result;
+}
+
+int32_t serviceCacheGet(uint16_t service_id, ServiceInfo* info)
+{
+    ServiceCacheEntry* entry;
+    pthread_mutex_lock(&serviceCacheMutex);
+    entry = serviceCacheFind(service_id);
+    if (entry == NULL || !entry->present)
+    {
+        pthread_mutex_unlock(&serviceCacheMutex);
+        return -1;
+    }
+    *info = entry->info;
+    pthread_mutex_unlock(&serviceCacheMutex);
+    return 0;
+}
+
+int32_t serviceTypeIsTv(uint8_t service_type)
+{
+    switch (service_type)
+    {
+    case 0x01: // digital television
+    case 0x11: // MPEG-2 HD
+    case 0x16: // H.264 SD
+    case 0x17: // H.264 SD NVOD time-shifted
+    case 0x18: // H.264 SD NVOD reference
+    case 0x19: // H.264 HD
+    case 0x1A: // H.264 HD NVOD time-shifted
+    case 0x1B: // H.264 HD NVOD reference
+    case 0x1C: // H.264 frame compatible 3D HD
+    case 0x1D:
+    case 0x1E:
+    case 0x1F: // HEVC
+    case 0x20:
+        return 1;
+    default:
+        return 0;
+    }
+}
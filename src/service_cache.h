@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file service_cache.h
+ * \brief
+ * Ovaj modul cuva podatke o servisima iz SDT tabele (naziv, provajder, tip
+ * servisa, free_CA_mode, running_status), indeksirano po service_id. Kes se
+ * azurira u pozadini iz SDT callback funkcije, tako da promjena kanala ne
+ * mora da ceka na SI tabele da bi prikazala naziv servisa.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef SERVICE_CACHE_H
+#define SERVICE_CACHE_H
+
+#include <stdint.h>
+#include "table_parser.h"
+
+#define SERVICE_CACHE_MAX_SERVICES 64
+#define SERVICE_NAME_SIZE 32
+
+typedef struct _ServiceInfo
+{
+    uint16_t service_id;
+    uint8_t service_type; // 0 ako SDT nema service deskriptor
+    uint8_t free_CA_mode;
+    uint8_t running_status;
+    char name[SERVICE_NAME_SIZE];
+    char provider[SERVICE_NAME_SIZE];
+} ServiceInfo;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sadrzaj kesa (npr. prilikom promjene multipleksa).
+ *
+ *****************************************************************************/
+void serviceCacheReset(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje servise iz SDT actual sekcije u kes. Servisi koje je
+ * ista sekcija nosila u prethodnoj verziji, a kojih nema u novoj, se brisu.
+ *
+ * @param table - [in] parsirana SDT sekcija (table_id 0x42)
+ * @return 0 ako nema greske, -1 ako sekcija nije SDT actual ili je kes pun
+ *****************************************************************************/
+int32_t serviceCacheUpdate(const SdtTable* table);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita podatke o servisu.
+ *
+ * @param service_id - [in] service_id (program_number iz PAT/PMT)
+ * @param info - [out] podaci o servisu
+ * @return 0 ako servis postoji u kesu, -1 u suprotnom
+ *****************************************************************************/
+int32_t serviceCacheGet(uint16_t service_id, ServiceInfo* info);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja provjerava da li tip servisa oznacava televizijski servis
+ * (SD, HD, H.264, HEVC...).
+ *
+ * @param service_type - [in] service_type iz service deskriptora
+ * @return 1 za televizijski servis, 0 za radio, podatke i ostalo
+ *****************************************************************************/
+int32_t serviceTypeIsTv(uint8_t service_type);
+
+#endif
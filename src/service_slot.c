@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file service_slot.c
+ * \brief
+ * Ovaj modul realizuje pretragu hes tabele po service_id-ju. Pocetni ulaz
+ * se dobija mnozenjem, pa uzastopni service_id-jevi ne zauzimaju susjedne
+ * ulaze.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "service_slot.h"
+#include <stdint.h>
+
+int32_t serviceSlotFind(const ServiceSlotKey* key, uint32_t stride, uint32_t slotCount, uint16_t service_id)
+{
+    const uint8_t* base = (const uint8_t*) key;
+    const ServiceSlotKey* slotKey;
+    uint32_t slot = (service_id * 40503u) & (slotCount - 1);
+    uint32_t i;
+    for (i = 0; i < slotCount; i++)
+    {
+        slotKey = (const ServiceSlotKey*) (base + slot * stride);
+        if (!slotKey->used || slotKey->service_id == service_id)
+            return (int32_t) slot;
+        slot = (slot + 1) & (slotCount - 1);
+    }
+    return -1;
+}
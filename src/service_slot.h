@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file service_slot.h
+ * \brief
+ * Ovaj modul realizuje pretragu hes tabele po service_id-ju sa linearnim
+ * probanjem. Koriste je skladista koja se pune iz SI tabela (now/next, EPG,
+ * nazivi servisa): svako ima svoj niz ulaza, a svaki ulaz sadrzi
+ * ServiceSlotKey.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef SERVICE_SLOT_H
+#define SERVICE_SLOT_H
+
+#include <stdint.h>
+
+/* dvostruko vise ulaza od broja servisa, da bi probanje ostalo kratko;
+ * maxServices mora biti stepen dvojke */
+#define SERVICE_SLOT_COUNT(maxServices) (2 * (maxServices))
+
+typedef struct _ServiceSlotKey
+{
+    uint8_t used; // ulaz je zauzet ovim service_id-jem
+    uint16_t service_id;
+} ServiceSlotKey;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi ulaz servisa, ili prazan ulaz u koji servis treba
+ * upisati. Ulazi tabele su velicine stride bajtova, a key pokazuje na
+ * ServiceSlotKey u prvom ulazu.
+ *
+ * @param key - [in] kljuc prvog ulaza tabele
+ * @param stride - [in] velicina jednog ulaza u bajtovima
+ * @param slotCount - [in] broj ulaza, stepen dvojke
+ * @param service_id - [in] service_id
+ * @return indeks ulaza, -1 ako je tabela puna
+ *****************************************************************************/
+int32_t serviceSlotFind(const ServiceSlotKey* key, uint32_t stride, uint32_t slotCount, uint16_t service_id);
+
+#endif
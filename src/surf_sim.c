@@ -0,0 +1,469 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file surf_sim.c
+ * \brief
+ * Program koji simulira sat listanja programa na virtuelnom vremenu. Tjuner,
+ * demultiplekser i plejer su iz libtdp_host.a, PMT tabele dohvata
+ * pmt_acquisition (jedan program iz PAT tabele nema PMT, pa se njegov filter
+ * ponovo postavlja svaki krug), tasteri idu kroz petlju dogadjaja, a
+ * streamove mijenja zap_machine. Sve niti su vodjene satom, pa je rezultat
+ * uvijek isti; na kraju se poredi sa ocekivanim vrijednostima. Ispisuje OK,
+ * ili razlike i izlazi sa 1.
+ *
+ * Upotreba: surf_sim
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "tdp_api.h"
+#include "tdp_host.h"
+#include "ts_writer.h"
+#include "clock_source.h"
+#include "event_loop.h"
+#include "pmt_acquisition.h"
+#include "zap_machine.h"
+#include "zap_stats.h"
+#include "section_view.h"
+#include "table_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_SERVICES 13 // PAT index 0 is the NIT
+#define SIM_STUCK_SERVICE 7 // listed in the PAT, its PMT is never sent
+#define SIM_CYCLE_PACKETS 64 // one table cycle per tuner chunk, ~96 ms at SIM_BITRATE
+#define SIM_BITRATE 1000000
+#define SIM_LOCK_MS 300
+#define SIM_STREAM_MS 100
+#define SIM_SETTLE_MS 50
+#define SIM_ROUND_SECONDS 10
+#define SIM_DURATION_SEC 3600
+
+typedef struct _SimCounter
+{
+    const char* name;
+    uint64_t value;
+    uint64_t expected;
+} SimCounter;
+
+typedef struct _SimPlayer
+{
+    uint32_t playerHandle;
+    uint32_t sourceHandle;
+    uint32_t streamHandle[ZAP_STREAM_COUNT];
+} SimPlayer;
+
+static TsWriterService services[SIM_SERVICES];
+
+static pthread_mutex_t simMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t simCondition = PTHREAD_COND_INITIALIZER;
+static uint8_t tunerLocked = 0;
+static uint8_t patReady = 0;
+static uint8_t serviceReady[MAX_NUM_OF_PIDS];
+static uint8_t psiStop = 0;
+static uint8_t acquisitionActive = 0;
+
+static PatHeader patHeader;
+static PatTable patTable;
+static PmtHeader pmtHeaders[MAX_NUM_OF_PIDS];
+static PmtTable pmtStorage[MAX_NUM_OF_PIDS];
+static PmtTable* pmtTables[MAX_NUM_OF_PIDS];
+static PmtAcquisition acquisition;
+
+static SimPlayer player;
+static ZapMachine zapMachine;
+static EventLoopTimer settleTimer = EVENT_LOOP_TIMER_INITIALIZER;
+/* stanje korisnickog interfejsa, mijenja ga samo nit petlje dogadjaja */
+static uint32_t currentService = 0;
+static uint32_t pendingService = 0;
+
+static uint64_t keyCount = 0;
+static uint64_t keyRefused = 0;
+static uint64_t zapRequests = 0;
+static uint64_t retryRounds = 0;
+
+static int32_t simTunerCallback(t_LockStatus status)
+{
+    pthread_mutex_lock(&simMutex);
+    tunerLocked = (status == STATUS_LOCKED);
+    clockBroadcast(&simCondition);
+    pthread_mutex_unlock(&simMutex);
+    return NO_ERROR;
+}
+
+/* runs on the tuner thread, which is driven by the clock */
+static int32_t simSectionCallback(uint8_t* buffer)
+{
+    SectionView view;
+    int32_t index;
+    if (sectionViewInit(&view, buffer, PSI_SECTION_MAX_SIZE) != SECTION_OK)
+        return NO_ERROR;
+    if (view.table_id == PAT_TABLE_ID)
+    {
+        pthread_mutex_lock(&simMutex);
+        if (!patReady && parsePatSection(&view, &patTable) == 0)
+        {
+            patReady = 1;
+            clockBroadcast(&simCondition);
+        }
+        pthread_mutex_unlock(&simMutex);
+    }
+    else if (view.table_id == PMT_TABLE_ID)
+    {
+        // PMT filters exist only while the acquisition is running
+        index = pmtAcquisitionOnSection(&acquisition, &view);
+        if (index >= 0)
+        {
+            pthread_mutex_lock(&simMutex);
+            serviceReady[index] = 1;
+            pthread_mutex_unlock(&simMutex);
+        }
+    }
+    return NO_ERROR;
+}
+
+static int32_t simSetFilter(void* context, uint16_t pid, uint8_t tableId, uint32_t* filterHandle)
+{
+    return Demux_Set_Filter(player.playerHandle, pid, tableId, filterHandle);
+}
+
+static void simFreeFilter(void* context, uint32_t filterHandle)
+{
+    Demux_Free_Filter(player.playerHandle, filterHandle);
+}
+
+/* waits on simCondition until *flag is set or the simulation stops */
+static uint8_t simWaitFlag(const uint8_t* flag)
+{
+    uint8_t result;
+    pthread_mutex_lock(&simMutex);
+    while (!*flag && !psiStop)
+        clockWait(&simCondition, &simMutex, CLOCK_FOREVER);
+    result = *flag;
+    pthread_mutex_unlock(&simMutex);
+    return result;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Nit koja dohvata PAT, a zatim PMT tabele u krugovima, kao
+ * psiAcquisitionThread u device_control.c, sve dok se simulacija ne zaustavi.
+ *
+ *****************************************************************************/
+static void* simPsiThread(void* arg)
+{
+    PmtAcquisitionOps ops;
+    uint32_t patFilter;
+    uint8_t active;
+    clockThreadDriven(1);
+    clockTakeOver();
+    if (!simWaitFlag(&tunerLocked) || Demux_Set_Filter(player.playerHandle, 0x00, PAT_TABLE_ID, &patFilter) != NO_ERROR)
+    {
+        clockThreadDriven(0);
+        return NULL;
+    }
+    simWaitFlag(&patReady);
+    Demux_Free_Filter(player.playerHandle, patFilter);
+    if (!patReady)
+    {
+        clockThreadDriven(0);
+        return NULL;
+    }
+    ops.setFilter = simSetFilter;
+    ops.freeFilter = simFreeFilter;
+    ops.context = NULL;
+    pmtAcquisitionStart(&acquisition, &ops, &patTable, pmtTables, PMT_ACQUISITION_MAX_FILTERS);
+    pthread_mutex_lock(&simMutex);
+    acquisitionActive = !psiStop;
+    active = acquisitionActive;
+    pthread_mutex_unlock(&simMutex);
+    // like finishPmtParsing: missing services are re-armed every round until the stop
+    if (active && pmtAcquisitionWait(&acquisition, SIM_ROUND_SECONDS) != 0)
+    {
+        while (!psiStop)
+        {
+            retryRounds++;
+            if (pmtAcquisitionRetry(&acquisition) == 0 || pmtAcquisitionWait(&acquisition, SIM_ROUND_SECONDS) == 0)
+                break;
+        }
+    }
+    clockThreadDriven(0);
+    return NULL;
+}
+
+static int32_t simRemoveStream(void* context, ZapStream stream)
+{
+    if (Player_Stream_Remove(player.playerHandle, player.sourceHandle, player.streamHandle[stream]))
+        return ERROR;
+    player.streamHandle[stream] = 0;
+    return NO_ERROR;
+}
+
+static int32_t simCreateStream(void* context, ZapStream stream, uint16_t pid, uint8_t type)
+{
+    if (Player_Stream_Create(player.playerHandle, player.sourceHandle, pid, type, &(player.streamHandle[stream])))
+    {
+        player.streamHandle[stream] = 0;
+        return ERROR;
+    }
+    return NO_ERROR;
+}
+
+/* runs on the event loop thread once no key arrived for SIM_SETTLE_MS */
+static void simSettleExpired(void* arg)
+{
+    const PmtTable* pmt = pmtTables[pendingService];
+    ZapTarget target;
+    uint8_t i;
+    memset(&target, 0, sizeof (target));
+    target.service_number = pendingService;
+    for (i = 0; i < pmt->streamCount; i++)
+    {
+        if (pmt->pmtServiceInfoArray[i].stream_class == STREAM_CLASS_VIDEO && target.pid[ZAP_STREAM_VIDEO] == 0)
+        {
+            target.pid[ZAP_STREAM_VIDEO] = pmt->pmtServiceInfoArray[i].el_pid;
+            target.type[ZAP_STREAM_VIDEO] = VIDEO_TYPE_MPEG2;
+        }
+        if (pmt->pmtServiceInfoArray[i].stream_class == STREAM_CLASS_AUDIO && target.pid[ZAP_STREAM_AUDIO] == 0)
+        {
+            target.pid[ZAP_STREAM_AUDIO] = pmt->pmtServiceInfoArray[i].el_pid;
+            target.type[ZAP_STREAM_AUDIO] = AUDIO_TYPE_MPEG_AUDIO;
+        }
+    }
+    currentService = pendingService;
+    pendingService = 0;
+    zapRequests++;
+    zapMachineRequest(&zapMachine, &target);
+}
+
+/* runs on the event loop thread, like remoteServiceCallback */
+static void simKey(void* arg)
+{
+    uint32_t service_number = (uint32_t) (uintptr_t) arg;
+    uint8_t ready;
+    keyCount++;
+    pthread_mutex_lock(&simMutex);
+    ready = serviceReady[service_number];
+    pthread_mutex_unlock(&simMutex);
+    if (!ready || (service_number == currentService && pendingService == 0))
+    {
+        keyRefused++;
+        return;
+    }
+    pendingService = service_number;
+    eventLoopTimerStart(&settleTimer, SIM_SETTLE_MS, simSettleExpired, NULL);
+}
+
+static void* simLoopThread(void* arg)
+{
+    eventLoopRun();
+    return NULL;
+}
+
+/* deterministic script, the same for every run */
+static uint32_t simRandom(uint32_t* seed, uint32_t range)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return ((*seed >> 16) & 0x7FFF) % range;
+}
+
+static uint64_t simCountCalls(const char* function, uint32_t a0)
+{
+    TdpHostCall call;
+    uint64_t count = 0;
+    uint32_t i;
+    for (i = 0; tdpHostGetCall(i, &call) == 0; i++)
+    {
+        if (strcmp(call.function, function) == 0 && call.result == NO_ERROR && (a0 == 0xFFFFFFFFu || call.args[0] == a0))
+            count++;
+    }
+    return count;
+}
+
+static void simBuildMultiplex(void)
+{
+    uint32_t i;
+    memset(services, 0, sizeof (services));
+    services[0].pmtPid = 0x10;
+    services[0].omitPmt = 1;
+    for (i = 1; i < SIM_SERVICES; i++)
+    {
+        services[i].program_number = (uint16_t) (100 + i);
+        services[i].pmtPid = (uint16_t) (0x100 + 0x10 * i);
+        services[i].videoPid = services[i].pmtPid + 1;
+        services[i].videoStreamType = 0x02;
+        services[i].audioPid = services[i].pmtPid + 2;
+        services[i].audioStreamType = 0x04;
+        services[i].omitPmt = (i == SIM_STUCK_SERVICE);
+    }
+    patTable.patHeader = &patHeader;
+    for (i = 0; i < MAX_NUM_OF_PIDS; i++)
+    {
+        pmtStorage[i].pmtHeader = &pmtHeaders[i];
+        pmtTables[i] = &pmtStorage[i];
+    }
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    char tsPath[] = "/tmp/surf_sim_XXXXXX";
+    // expected values of the fixed script, a change here has to be explained
+    SimCounter counters[] = {
+        {"keys", 0, 364},
+        {"keys refused", 0, 31},
+        {"zap requests", 0, 333},
+        {"zaps retargeted", 0, 30},
+        {"Player_Stream_Create", 0, 636},
+        {"Player_Stream_Remove", 0, 634},
+        {"PMT tables received", 0, 11},
+        {"PMT retry rounds", 0, 359},
+        {"stuck PMT filter arms", 0, 360},
+        {"sections delivered", 0, 12},
+        {"virtual end ms", 0, 3600000},
+    };
+    const uint32_t counterCount = sizeof (counters) / sizeof (counters[0]);
+    TdpHostConfig hostConfig;
+    ZapMachineOps zapOps;
+    ZapTarget playing;
+    pthread_t loopThread;
+    pthread_t psiThread;
+    struct timespec wallStart;
+    struct timespec wallEnd;
+    uint64_t start;
+    uint64_t end;
+    uint64_t gap;
+    uint32_t seed = 1;
+    uint32_t service_number = 1;
+    uint32_t presses;
+    uint32_t failures = 0;
+    uint32_t i;
+    int fd;
+
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    // before any thread or timer exists
+    start = CLOCK_NS_PER_SEC;
+    clockUseVirtual(start);
+    end = start + SIM_DURATION_SEC * CLOCK_NS_PER_SEC;
+
+    simBuildMultiplex();
+    fd = mkstemp(tsPath);
+    if (fd < 0)
+    {
+        printf("%s: ERROR cannot create a temporary file\n", __FUNCTION__);
+        return 1;
+    }
+    close(fd);
+    if (tsWriterWriteMultiplex(tsPath, services, SIM_SERVICES, 1, SIM_CYCLE_PACKETS) != 0)
+    {
+        unlink(tsPath);
+        return 1;
+    }
+    memset(&hostConfig, 0, sizeof (hostConfig));
+    hostConfig.tsPath = tsPath;
+    hostConfig.lockDelayMs = SIM_LOCK_MS;
+    hostConfig.streamCreateMs = SIM_STREAM_MS;
+    hostConfig.bitrate = SIM_BITRATE;
+    hostConfig.filterCount = 16;
+    tdpHostConfigure(&hostConfig);
+
+    if (Tuner_Init() || Tuner_Register_Status_Callback(simTunerCallback) ||
+            Demux_Register_Section_Filter_Callback(simSectionCallback) ||
+            Player_Init(&(player.playerHandle)) || Player_Source_Open(player.playerHandle, &(player.sourceHandle)) ||
+            eventLoopInit() != 0)
+    {
+        unlink(tsPath);
+        return 1;
+    }
+    memset(&playing, 0, sizeof (playing));
+    zapOps.removeStream = simRemoveStream;
+    zapOps.createStream = simCreateStream;
+    zapOps.context = NULL;
+    zapMachineInit(&zapMachine, &zapOps, &playing);
+    pthread_create(&loopThread, NULL, simLoopThread, NULL);
+    clockHandOff();
+    pthread_create(&psiThread, NULL, simPsiThread, NULL);
+    if (Tuner_Lock_To_Frequency(754 * 1000000u, 8, DVB_T))
+    {
+        unlink(tsPath);
+        return 1;
+    }
+
+    // bursts of P+ presses, then a while on the last service
+    while (clockNow() < end)
+    {
+        presses = 1 + simRandom(&seed, 5);
+        for (i = 0; i < presses; i++)
+        {
+            gap = (60 + simRandom(&seed, 340)) * CLOCK_NS_PER_MS;
+            clockAdvance(gap);
+            service_number = (service_number % (SIM_SERVICES - 1)) + 1;
+            eventLoopPost(simKey, (void*) (uintptr_t) service_number);
+        }
+        gap = (2 + simRandom(&seed, 58)) * CLOCK_NS_PER_SEC;
+        clockAdvance((clockNow() + gap < end) ? gap : end - clockNow());
+    }
+
+    eventLoopStop();
+    pthread_join(loopThread, NULL);
+    eventLoopTimerDelete(&settleTimer);
+    zapMachineDeinit(&zapMachine);
+    pthread_mutex_lock(&simMutex);
+    psiStop = 1;
+    if (acquisitionActive)
+        pmtAcquisitionCancel(&acquisition);
+    clockBroadcast(&simCondition);
+    pthread_mutex_unlock(&simMutex);
+    pthread_join(psiThread, NULL);
+    // no section callback can run once the tuner thread is joined
+    Tuner_Deinit();
+    counters[6].value = acquisition.received;
+    if (acquisitionActive)
+        pmtAcquisitionStop(&acquisition);
+    eventLoopDeinit();
+    unlink(tsPath);
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+
+    counters[0].value = keyCount;
+    counters[1].value = keyRefused;
+    counters[2].value = zapRequests;
+    counters[3].value = zapMachine.retargets;
+    counters[4].value = simCountCalls("Player_Stream_Create", 0xFFFFFFFFu);
+    counters[5].value = simCountCalls("Player_Stream_Remove", 0xFFFFFFFFu);
+    counters[7].value = retryRounds;
+    counters[8].value = simCountCalls("Demux_Set_Filter", services[SIM_STUCK_SERVICE].pmtPid);
+    counters[9].value = tdpHostSectionCount();
+    counters[10].value = (clockNow() - start) / CLOCK_NS_PER_MS;
+
+    zapStatsReport(stdout);
+    for (i = 0; i < counterCount; i++)
+    {
+        printf("%-24s %10llu%s\n", counters[i].name, (unsigned long long) counters[i].value,
+               (counters[i].value != counters[i].expected) ? "  FAIL" : "");
+        if (counters[i].value != counters[i].expected)
+        {
+            printf("%-24s %10llu expected\n", "", (unsigned long long) counters[i].expected);
+            failures++;
+        }
+    }
+    printf("%u s simulated in %.3f s\n", SIM_DURATION_SEC,
+           (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9);
+    if (failures > 0)
+        return 1;
+    printf("OK\n");
+    return 0;
+}
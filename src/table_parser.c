@@ -12,7 +12,7 @@
  *
  * \file table_parser.c
  * \brief
- * Ovaj modul realizuje parsiranje PMT,PAT i EIT tabela, uz postojanje fukcija za
+ * Ovaj modul realizuje parsiranje PMT,PAT,NIT,SDT i EIT tabela, uz postojanje fukcija za
  * ispis sadrzaja na standardni izlaz.
  * 
  * @Author Milan Maric
@@ -28,67 +28,6 @@
 #include <stdint.h>
 #include <string.h>
 
-/****************************************************************************
- *
- * @brief
-Fukcija koja se koristi za parsiranje niza servisnih informacija iz PAT tabele
- *
- * @param
-buff - [in] Ulazni bafer sa odmercima
- *
-patServiceInfoArray - [out] niz servisnih informacija u koje je potrebno upisati parsirane vrijednosti
- *
-section_length - [in] vrijednost koja predstavlja duzinu sekcije(polje iz PAT header - a)
- *
- *
- *
- *****************************************************************************/
-void parsePatServiceInfoArray(uint8_t *buffer, PatServiceInfo patServiceInfoArray[], uint16_t section_length)
-{
-    int brojPidova = (section_length - 10) / 4;
-    int kraj;
-    int i = 0;
-    if (brojPidova < MAX_NUM_OF_PIDS)
-    {
-        kraj = brojPidova;
-    }
-    else
-    {
-        kraj = MAX_NUM_OF_PIDS;
-    }
-
-    for (i = 0; i < kraj; i++)
-    {
-        patServiceInfoArray[i].program_number = (uint16_t) ((*(buffer + i * 4 + 8) << 8) + *(buffer + i * 4 + 9));
-        patServiceInfoArray[i].pid = (uint16_t) (((*(buffer + i * 4 + 10) << 8) + *(buffer + i * 4 + 11)) & 0x1FFF);
-    }
-}
-
-/****************************************************************************
- *
- * @brief
-Fukcija koja se koristi za parsiranje zaglavlja PAT tabele
- *
- * @param
-buff - [in] Ulazni bafer sa odmercima
- *
-patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
- *
- *
- *
- *****************************************************************************/
-void parsePatHeader(uint8_t *buffer, PatHeader* patHeader)
-{
-    (*patHeader).table_id = (uint8_t) (*(buffer + 0));
-    (*patHeader).section_syntax_indicator = (uint8_t) (*(buffer + 1) << 7);
-    (*patHeader).section_length = (uint16_t) (((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
-    (*patHeader).transport_stream_id = (uint16_t) ((*(buffer + 3) << 8) + *(buffer + 4));
-    (*patHeader).version_number = (uint8_t) ((*(buffer + 5) >> 1) & 0x1F);
-    (*patHeader).current_next_indicator = (uint8_t) (*(buffer + 5) & 0x01);
-    (*patHeader).section_number = (uint8_t) (*(buffer + 6));
-    (*patHeader).last_section_number = (uint8_t) (*(buffer + 7));
-}
-
 /****************************************************************************
  *
  * @brief
@@ -126,14 +65,52 @@ table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parsePatTable(uint8_t *buffer, PatTable* table)
+int32_t parsePatTable(uint8_t *buffer, PatTable* table)
+{
+    SectionView view;
+    if (sectionViewInit(&view, buffer, PSI_SECTION_MAX_SIZE) != SECTION_OK)
+        return PARSING_ERROR;
+    return parsePatSection(&view, table);
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje PAT tabele iz validiranog pogleda na sekciju.
+ * Broj upisanih programa je ogranicen na MAX_NUM_OF_PIDS.
+ *
+ * @param
+view - [in] validiran pogled na PAT sekciju
+ *
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije PAT
+ *
+ *****************************************************************************/
+int32_t parsePatSection(const SectionView* view, PatTable* table)
 {
-    printf("%s started\n", __FUNCTION__);
-    parsePatHeader(buffer, table->patHeader);
-    printf("%s header parsed\n", __FUNCTION__);
-    parsePatServiceInfoArray(buffer, table->patServiceInfoArray, table->patHeader->section_length);
-    printf("%s service info parsed\n", __FUNCTION__);
-    (*table).serviceInfoCount = (uint8_t) ((*(*table).patHeader).section_length - 10) / 4;
+    PatProgramIterator it;
+    PatServiceInfo* info;
+    uint8_t count = 0;
+    if (patProgramIteratorInit(view, &it) != SECTION_OK)
+        return PARSING_ERROR;
+    table->patHeader->table_id = view->table_id;
+    table->patHeader->section_syntax_indicator = view->section_syntax_indicator;
+    table->patHeader->section_length = view->section_length;
+    table->patHeader->transport_stream_id = view->table_id_extension;
+    table->patHeader->version_number = view->version_number;
+    table->patHeader->current_next_indicator = view->current_next_indicator;
+    table->patHeader->section_number = view->section_number;
+    table->patHeader->last_section_number = view->last_section_number;
+    while (count < MAX_NUM_OF_PIDS)
+    {
+        info = &(table->patServiceInfoArray[count]);
+        if (!patProgramNext(&it, &(info->program_number), &(info->pid)))
+            break;
+        count++;
+    }
+    table->serviceInfoCount = count;
+    return 0;
 }
 
 /****************************************************************************
@@ -185,78 +162,211 @@ table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parsePmt(uint8_t *buffer, PmtTable* table)
+int32_t parsePmt(uint8_t *buffer, PmtTable* table)
 {
-    parsePmtHeader(buffer, table->pmtHeader);
-    parsePmtServiceInfoArray(buffer, table->pmtServiceInfoArray, &((*table).streamCount), &(table->teletekst));
+    SectionView view;
+    if (sectionViewInit(&view, buffer, PSI_SECTION_MAX_SIZE) != SECTION_OK)
+        return PARSING_ERROR;
+    return parsePmtSection(&view, table);
 }
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje zaglavlja PMT tabele
- *
- * @param
-buff - [in] Ulazni bafer sa odmercima
+Fukcije za obradu deskriptora elementarnog toka u PMT tabeli. Svaka funkcija
+ * dopunjava PmtServiceInfo tog toka.
  *
-patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
+ *****************************************************************************/
+static void pmtStreamLanguage(PmtServiceInfo* info, const uint8_t* code)
+{
+    if (info->language[0] == '\0')
+    {
+        memcpy(info->language, code, 3);
+        info->language[3] = '\0';
+    }
+}
+
+static int32_t pmtIso639LanguageDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    if (descriptor->length < 4)
+        return PARSING_ERROR;
+    pmtStreamLanguage((PmtServiceInfo*) userData, descriptor->data);
+    return 0;
+}
+
+static int32_t pmtTeletextDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    PmtServiceInfo* info = (PmtServiceInfo*) userData;
+    info->stream_class = STREAM_CLASS_TELETEXT;
+    // language (24), teletext_type (5), magazine (3), page (8)
+    if (descriptor->length >= 5)
+        pmtStreamLanguage(info, descriptor->data);
+    return 0;
+}
+
+static int32_t pmtSubtitlingDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    PmtServiceInfo* info = (PmtServiceInfo*) userData;
+    info->stream_class = STREAM_CLASS_SUBTITLES;
+    // language (24), subtitling_type (8), composition_page_id (16), ancillary_page_id (16)
+    if (descriptor->length >= 8)
+        pmtStreamLanguage(info, descriptor->data);
+    return 0;
+}
+
+static int32_t pmtAc3Descriptor(const DescriptorView* descriptor, void* userData)
+{
+    PmtServiceInfo* info = (PmtServiceInfo*) userData;
+    info->stream_class = STREAM_CLASS_AUDIO;
+    info->codec = (descriptor->tag == 0x7A) ? STREAM_CODEC_EAC3 : STREAM_CODEC_AC3;
+    return 0;
+}
+
+static int32_t pmtAacDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    PmtServiceInfo* info = (PmtServiceInfo*) userData;
+    info->stream_class = STREAM_CLASS_AUDIO;
+    info->codec = STREAM_CODEC_AAC;
+    return 0;
+}
+
+static int32_t pmtStreamIdentifierDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    PmtServiceInfo* info = (PmtServiceInfo*) userData;
+    if (descriptor->length < 1)
+        return PARSING_ERROR;
+    info->hasComponentTag = 1;
+    info->component_tag = descriptor->data[0];
+    return 0;
+}
+
+static DescriptorDispatchTable pmtStreamDescriptors;
+static pthread_once_t pmtStreamDescriptorsOnce = PTHREAD_ONCE_INIT;
+
+static void pmtStreamDescriptorsInit(void)
+{
+    descriptorDispatchInit(&pmtStreamDescriptors);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x0A, pmtIso639LanguageDescriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x52, pmtStreamIdentifierDescriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x56, pmtTeletextDescriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x59, pmtSubtitlingDescriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x6A, pmtAc3Descriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x7A, pmtAc3Descriptor);
+    descriptorDispatchRegister(&pmtStreamDescriptors, 0x7C, pmtAacDescriptor);
+}
+
+/****************************************************************************
  *
+ * @brief
+Fukcija koja klasifikuje elementarni tok po stream_type polju. Tokovi tipa
+ * 0x06 (PES private data) se klasifikuju tek preko deskriptora.
  *
+ * @param
+info - [in/out] elementarni tok sa popunjenim stream_type poljem
  *
  *****************************************************************************/
-void parsePmtHeader(uint8_t *buffer, PmtHeader* pmtHeader)
+static void pmtClassifyStreamType(PmtServiceInfo* info)
 {
-    (*pmtHeader).table_id = (uint8_t) (*(buffer + 0));
-    (*pmtHeader).section_syntax_indicator = (uint8_t) (*(buffer + 1) >> 7);
-    (*pmtHeader).section_length = (uint16_t) (((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
-    (*pmtHeader).program_number = (uint16_t) ((*(buffer + 3) << 8) + *(buffer + 4));
-    (*pmtHeader).version_number = (uint8_t) ((*(buffer + 5) >> 1) & 0x1F);
-    (*pmtHeader).current_next_indicator = (uint8_t) (*(buffer + 5) & 0x01);
-    (*pmtHeader).section_number = (uint8_t) (*(buffer + 6));
-    (*pmtHeader).last_section_number = (uint8_t) (*(buffer + 7));
-    (*pmtHeader).pcr_pid = (uint16_t) (((*(buffer + 8) << 8) + *(buffer + 9)) & 0x1FFF);
-    (*pmtHeader).program_info_length = (uint16_t) (((*(buffer + 10) << 8) + *(buffer + 11)) & 0x0FFF);
+    info->stream_class = STREAM_CLASS_UNKNOWN;
+    info->codec = STREAM_CODEC_UNKNOWN;
+    switch (info->stream_type)
+    {
+    case 0x01:
+        info->stream_class = STREAM_CLASS_VIDEO;
+        info->codec = STREAM_CODEC_MPEG1_VIDEO;
+        break;
+    case 0x02:
+        info->stream_class = STREAM_CLASS_VIDEO;
+        info->codec = STREAM_CODEC_MPEG2_VIDEO;
+        break;
+    case 0x1B:
+        info->stream_class = STREAM_CLASS_VIDEO;
+        info->codec = STREAM_CODEC_H264;
+        break;
+    case 0x24:
+        info->stream_class = STREAM_CLASS_VIDEO;
+        info->codec = STREAM_CODEC_HEVC;
+        break;
+    case 0x03:
+        info->stream_class = STREAM_CLASS_AUDIO;
+        info->codec = STREAM_CODEC_MPEG1_AUDIO;
+        break;
+    case 0x04:
+        info->stream_class = STREAM_CLASS_AUDIO;
+        info->codec = STREAM_CODEC_MPEG2_AUDIO;
+        break;
+    case 0x0F:
+    case 0x11:
+        info->stream_class = STREAM_CLASS_AUDIO;
+        info->codec = STREAM_CODEC_AAC;
+        break;
+    case 0x81:
+        info->stream_class = STREAM_CLASS_AUDIO;
+        info->codec = STREAM_CODEC_AC3;
+        break;
+    case 0x05:
+    case 0x0B:
+    case 0x0C:
+    case 0x0D:
+        info->stream_class = STREAM_CLASS_DATA;
+        break;
+    default:
+        break;
+    }
 }
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje niza servisnih informacija iz PMT tabele
+Fukcija koja se koristi za parsiranje PMT tabele iz validiranog pogleda na sekciju.
+ * Broj upisanih elementarnih tokova je ogranicen na MAX_NUM_OF_PIDS. Svaki tok
+ * se klasifikuje u jednom prolazu kroz petlju deskriptora.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
- *
-pmtServiceInfoArray - [out] niz servisnih informacija u koje je potrebno upisati parsirane vrijednosti
- *
-broj - [out] broj sekcija koje ce biti parsirane
+view - [in] validiran pogled na PMT sekciju
  *
+table - [out] tabela u koju je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako sekcija nije PMT
  *
  *****************************************************************************/
-void parsePmtServiceInfoArray(uint8_t *buffer, PmtServiceInfo pmtServiceInfoArray[], uint8_t* broj, uint8_t* teletekst)
+int32_t parsePmtSection(const SectionView* view, PmtTable* table)
 {
-    uint8_t section_length = (uint16_t) (((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
-    uint16_t program_info_length = (uint16_t) (((*(buffer + 10) << 8) + *(buffer + 11)) & 0x0FFF);
-    int kraj = section_length - 1;
-    int poc = program_info_length + 3 + 9;
-    int i = 0;
-    *teletekst = 0;
-    for (i = 0; poc < kraj; i++)
+    PmtStreamIterator it;
+    PmtStreamView stream;
+    PmtServiceInfo* info;
+    uint8_t count = 0;
+    if (pmtStreamIteratorInit(view, &it) != SECTION_OK)
+        return PARSING_ERROR;
+    pthread_once(&pmtStreamDescriptorsOnce, pmtStreamDescriptorsInit);
+    table->pmtHeader->table_id = view->table_id;
+    table->pmtHeader->section_syntax_indicator = view->section_syntax_indicator;
+    table->pmtHeader->section_length = view->section_length;
+    table->pmtHeader->program_number = view->table_id_extension;
+    table->pmtHeader->version_number = view->version_number;
+    table->pmtHeader->current_next_indicator = view->current_next_indicator;
+    table->pmtHeader->section_number = view->section_number;
+    table->pmtHeader->last_section_number = view->last_section_number;
+    table->pmtHeader->pcr_pid = pmtPcrPid(view);
+    table->pmtHeader->program_info_length = (uint16_t) (((view->data[10] << 8) + view->data[11]) & 0x0FFF);
+    table->teletekst = 0;
+    while (count < MAX_NUM_OF_PIDS && pmtStreamNext(&it, &stream))
     {
-        pmtServiceInfoArray[i].stream_type = (uint8_t) (*(buffer + poc));
-        poc++;
-        pmtServiceInfoArray[i].el_pid = (uint16_t) (((*(buffer + poc) << 8) + *(buffer + poc + 1)) & 0x1FFF);
-        poc += 2;
-        pmtServiceInfoArray[i].es_info_length = (uint16_t) (((*(buffer + poc) << 8) + *(buffer + poc + 1)) & 0x0FFF);
-        poc += 2;
-        if (pmtServiceInfoArray[i].es_info_length > 0)
-        {
-            if (*teletekst == 0)
-                *teletekst = (*(buffer + poc) == 0x56);
-        }
-        poc += pmtServiceInfoArray[i].es_info_length;
+        info = &(table->pmtServiceInfoArray[count]);
+        info->stream_type = stream.stream_type;
+        info->el_pid = stream.el_pid;
+        info->es_info_length = stream.es_info_length;
+        info->language[0] = '\0';
+        info->hasComponentTag = 0;
+        info->component_tag = 0;
+        pmtClassifyStreamType(info);
+        descriptorDispatch(&pmtStreamDescriptors, stream.es_info, stream.es_info_length, info);
+        if (info->stream_class == STREAM_CLASS_TELETEXT)
+            table->teletekst = 1;
+        count++;
     }
-    *broj = i;
+    table->streamCount = count;
+    return 0;
 }
 
 /****************************************************************************
@@ -287,7 +397,8 @@ void dumpPmtTable(PmtTable* pmtTable)
     printf("program_info_length: %d\n", pmtTable->pmtHeader->program_info_length);
     for (i = 0; i < pmtTable->streamCount; i++)
     {
-        printf("Service Type: %d el_pid: %d es_info_length %d\n", pmtTable->pmtServiceInfoArray[i].stream_type, pmtTable->pmtServiceInfoArray[i].el_pid, pmtTable->pmtServiceInfoArray[i].es_info_length);
+        printf("Service Type: %d el_pid: %d es_info_length %d class: %d codec: %d language: %s\n", pmtTable->pmtServiceInfoArray[i].stream_type, pmtTable->pmtServiceInfoArray[i].el_pid, pmtTable->pmtServiceInfoArray[i].es_info_length,
+               pmtTable->pmtServiceInfoArray[i].stream_class, pmtTable->pmtServiceInfoArray[i].codec, pmtTable->pmtServiceInfoArray[i].language);
     }
 }
 
@@ -327,69 +438,572 @@ table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parseEitTable(uint8_t* buffer, EitTable* table)
+int32_t parseEitTable(uint8_t* buffer, EitTable* table)
+{
+    SectionView view;
+    if (sectionViewInit(&view, buffer, SECTION_MAX_SIZE) != SECTION_OK)
+        return PARSING_ERROR;
+    return parseEitSection(&view, table);
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcije za obradu deskriptora dogadjaja u EIT tabeli. Svaka funkcija
+ * dopunjava EitEvents tog dogadjaja.
+ *
+ *****************************************************************************/
+static int32_t eitShortEventDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    EitEvents* event = (EitEvents*) userData;
+    if (event->hasShortEvent)
+        return 0;
+    event->hasShortEvent = (parseShortEventDescriptor(descriptor, &(event->shortEvent)) == 0);
+    return event->hasShortEvent ? 0 : PARSING_ERROR;
+}
+
+static int32_t eitExtendedEventDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    EitEvents* event = (EitEvents*) userData;
+    if (event->extendedEventCount >= EIT_MAX_EXTENDED_DESCRIPTORS)
+        return 0;
+    if (parseExtendedEventDescriptor(descriptor, &(event->extendedEvents[event->extendedEventCount])) != 0)
+        return PARSING_ERROR;
+    event->extendedEventCount++;
+    return 0;
+}
+
+static DescriptorDispatchTable eitEventDescriptors;
+static pthread_once_t eitEventDescriptorsOnce = PTHREAD_ONCE_INIT;
+
+static void eitEventDescriptorsInit(void)
 {
-    parseEitHeader(buffer, &(table->header));
-    dumpEitHeader(&(table->header));
-    parseEitEvent(buffer + 13, &(table->events[0]));
-    dumpEitEvent(&(table->events[0]));
-    dumpBuffer(buffer);
+    descriptorDispatchInit(&eitEventDescriptors);
+    descriptorDispatchRegister(&eitEventDescriptors, 0x4D, eitShortEventDescriptor);
+    descriptorDispatchRegister(&eitEventDescriptors, 0x4E, eitExtendedEventDescriptor);
 }
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje zaglavlja EIT tabele
+Fukcija koja se koristi za parsiranje EIT tabele (present/following i schedule)
+ * iz validiranog pogleda na sekciju. Parsiraju se svi dogadjaji (najvise
+ * MAX_NUM_OF_EVENTS) zajedno sa short_event i extended_event deskriptorima.
+ * Tekstualna polja pokazuju u bafer sekcije.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+view - [in] validiran pogled na EIT sekciju
+ *
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije EIT
+ *
+ *****************************************************************************/
+int32_t parseEitSection(const SectionView* view, EitTable* table)
+{
+    EitEventIterator it;
+    EitEventView eventView;
+    EitEvents* event;
+    const uint8_t* payload;
+    uint16_t length;
+    uint8_t count = 0;
+    if (eitEventIteratorInit(view, &it) != SECTION_OK)
+        return PARSING_ERROR;
+    pthread_once(&eitEventDescriptorsOnce, eitEventDescriptorsInit);
+    // the iterator checked that the payload holds the EIT fixed fields
+    payload = sectionViewPayload(view, &length);
+    table->header.table_id = view->table_id;
+    table->header.section_syntax_indicator = view->section_syntax_indicator;
+    table->header.section_length = view->section_length;
+    table->header.service_id = view->table_id_extension;
+    table->header.version_number = view->version_number;
+    table->header.current_next_indicator = view->current_next_indicator;
+    table->header.section_number = view->section_number;
+    table->header.last_section_number = view->last_section_number;
+    table->header.transport_stream_id = (uint16_t) ((payload[0] << 8) + payload[1]);
+    table->header.original_network_id = (uint16_t) ((payload[2] << 8) + payload[3]);
+    table->header.segment_last_section_number = payload[4];
+    table->header.last_table_id = payload[5];
+    while (count < MAX_NUM_OF_EVENTS && eitEventNext(&it, &eventView))
+    {
+        event = &(table->events[count]);
+        event->event_id = eventView.event_id;
+        memcpy(event->start_time, eventView.start_time, sizeof (event->start_time));
+        memcpy(event->durration, eventView.duration, sizeof (event->durration));
+        event->running_status = eventView.running_status;
+        event->free_CA_mode = eventView.free_CA_mode;
+        event->descriptor_loop_length = eventView.descriptors_loop_length;
+        event->hasShortEvent = 0;
+        event->extendedEventCount = 0;
+        descriptorDispatch(&eitEventDescriptors, eventView.descriptors, eventView.descriptors_loop_length, event);
+        count++;
+    }
+    table->eventCount = count;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje short_event deskriptora (0x4D)
  *
-header - [out] zaglavlje u koje je potrebno upisati vrijednosti
+ * @param
+descriptor - [in] pogled na deskriptor
  *
+shortEvent - [out] deskriptor u koji je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
  *
  *****************************************************************************/
-void parseEitHeader(uint8_t* buffer, EitHeader* header)
-{
-    header->table_id = buffer[0];
-    header->section_syntax_indicator = buffer[1] >> 7;
-    header->section_length = (uint16_t) (((*(buffer + 1) << 8) + *(buffer + 2)) & 0x0FFF);
-    header->service_id = (uint16_t) ((*(buffer + 3) << 8) + *(buffer + 4));
-    header->version_number = (buffer[5]&0x3E) >> 1;
-    header->current_next_indicator = buffer[5]&0x01;
-    header->section_number = buffer[6];
-    header->last_section_number = buffer[7];
-    header->transport_stream_id = buffer[8] << 8 + buffer[9];
-    header->original_network_id = buffer[10] << 8 + buffer[11];
-    header->segment_last_section_number = buffer[12];
-    header->last_table_id = buffer[13];
+int32_t parseShortEventDescriptor(const DescriptorView* descriptor, ShortEventDescriptor* shortEvent)
+{
+    const uint8_t* data = descriptor->data;
+    uint8_t length = descriptor->length;
+    if (length < 5)
+        return PARSING_ERROR;
+    shortEvent->dvb_DescriptorTag = descriptor->tag;
+    shortEvent->descriptor_length = length;
+    memcpy(shortEvent->language_code, data, 3);
+    shortEvent->event_name_length = data[3];
+    if (4 + shortEvent->event_name_length + 1 > length)
+        return PARSING_ERROR;
+    shortEvent->event_name = data + 4;
+    shortEvent->text_length = data[4 + shortEvent->event_name_length];
+    if (5 + shortEvent->event_name_length + shortEvent->text_length > length)
+        return PARSING_ERROR;
+    shortEvent->text = data + 5 + shortEvent->event_name_length;
+    return 0;
 }
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje EIT dogadjaja (event)
+Fukcija koja se koristi za parsiranje extended_event deskriptora (0x4E).
+ * Parsira se samo tekst dogadjaja, lista stavki (items) se preskace.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+descriptor - [in] pogled na deskriptor
+ *
+extendedEvent - [out] deskriptor u koji je potrebno upisati vrijednosti
  *
-event - [out] zaglavlje u koje je potrebno upisati vrijednosti
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
+ *
+ *****************************************************************************/
+int32_t parseExtendedEventDescriptor(const DescriptorView* descriptor, ExtendedEventDescriptor* extendedEvent)
+{
+    const uint8_t* data = descriptor->data;
+    uint8_t length = descriptor->length;
+    uint8_t itemsLength;
+    if (length < 6)
+        return PARSING_ERROR;
+    extendedEvent->descriptor_number = (uint8_t) (data[0] >> 4);
+    extendedEvent->last_descriptor_number = (uint8_t) (data[0] & 0x0F);
+    memcpy(extendedEvent->language_code, data + 1, 3);
+    itemsLength = data[4];
+    if (5 + itemsLength + 1 > length)
+        return PARSING_ERROR;
+    extendedEvent->text_length = data[5 + itemsLength];
+    if (6 + itemsLength + extendedEvent->text_length > length)
+        return PARSING_ERROR;
+    extendedEvent->text = data + 6 + itemsLength;
+    return 0;
+}
+
+/****************************************************************************
  *
+ * @brief
+Fukcija koja pronalazi servis transportnog toka NIT tabele, ili ga dodaje
+ * ako ne postoji.
  *
+ * @return pokazivac na servis, NULL ako je niz servisa pun
  *
  *****************************************************************************/
-void parseEitEvent(uint8_t* buffer, EitEvents* event)
+static NitService* nitTransportStreamService(NitTransportStream* ts, uint16_t service_id)
 {
-    event->event_id = buffer[0] << 8 + buffer[1];
-    event->start_time[0] = buffer[2];
-    event->start_time[1] = buffer[3];
-    event->start_time[2] = buffer[4];
-    event->start_time[3] = buffer[5];
-    event->start_time[4] = buffer[6];
-    event->durration[0] = buffer[7];
-    event->durration[1] = buffer[8];
-    event->durration[2] = buffer[9];
-    event->descriptor_loop_length = (buffer[10]&0xF0) << 8 + buffer[11];
+    NitService* service;
+    uint8_t i;
+    for (i = 0; i < ts->serviceCount; i++)
+    {
+        if (ts->services[i].service_id == service_id)
+            return &(ts->services[i]);
+    }
+    if (ts->serviceCount >= NIT_MAX_SERVICES)
+        return NULL;
+    service = &(ts->services[ts->serviceCount++]);
+    service->service_id = service_id;
+    service->service_type = 0;
+    service->visible_service_flag = 1;
+    service->logical_channel_number = 0;
+    return service;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcije za obradu deskriptora transportnog toka u NIT tabeli. Svaka funkcija
+ * dopunjava NitTransportStream tog toka.
+ *
+ *****************************************************************************/
+static int32_t nitTerrestrialDeliveryDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    NitTransportStream* ts = (NitTransportStream*) userData;
+    if (ts->hasTerrestrialDelivery)
+        return 0;
+    ts->hasTerrestrialDelivery = (parseTerrestrialDeliveryDescriptor(descriptor, &(ts->terrestrialDelivery)) == 0);
+    return ts->hasTerrestrialDelivery ? 0 : PARSING_ERROR;
+}
+
+static int32_t nitServiceListDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    NitTransportStream* ts = (NitTransportStream*) userData;
+    NitService* service;
+    uint8_t i;
+    // service_id (16), service_type (8)
+    for (i = 0; i + 3 <= descriptor->length; i += 3)
+    {
+        service = nitTransportStreamService(ts, (uint16_t) ((descriptor->data[i] << 8) + descriptor->data[i + 1]));
+        if (service != NULL)
+            service->service_type = descriptor->data[i + 2];
+    }
+    return 0;
+}
+
+static int32_t nitLogicalChannelDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    NitTransportStream* ts = (NitTransportStream*) userData;
+    NitService* service;
+    uint8_t i;
+    // EACEM/NorDig: service_id (16), visible_service_flag (1), reserved (5), LCN (10)
+    for (i = 0; i + 4 <= descriptor->length; i += 4)
+    {
+        service = nitTransportStreamService(ts, (uint16_t) ((descriptor->data[i] << 8) + descriptor->data[i + 1]));
+        if (service != NULL)
+        {
+            service->visible_service_flag = (uint8_t) (descriptor->data[i + 2] >> 7);
+            service->logical_channel_number = (uint16_t) (((descriptor->data[i + 2] << 8) + descriptor->data[i + 3]) & 0x03FF);
+        }
+    }
+    return 0;
+}
+
+static DescriptorDispatchTable nitTransportStreamDescriptors;
+static pthread_once_t nitTransportStreamDescriptorsOnce = PTHREAD_ONCE_INIT;
+
+static void nitTransportStreamDescriptorsInit(void)
+{
+    descriptorDispatchInit(&nitTransportStreamDescriptors);
+    descriptorDispatchRegister(&nitTransportStreamDescriptors, 0x41, nitServiceListDescriptor);
+    descriptorDispatchRegister(&nitTransportStreamDescriptors, 0x5A, nitTerrestrialDeliveryDescriptor);
+    descriptorDispatchRegister(&nitTransportStreamDescriptors, 0x83, nitLogicalChannelDescriptor);
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje NIT tabele (actual 0x40 ili other 0x41)
+ * iz validiranog pogleda na sekciju.
+ *
+ * @param
+view - [in] validiran pogled na NIT sekciju
+ *
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije NIT
+ *
+ *****************************************************************************/
+int32_t parseNitSection(const SectionView* view, NitTable* table)
+{
+    NitTransportStreamIterator it;
+    NitTransportStreamView tsView;
+    NitTransportStream* ts;
+    DescriptorIterator descriptors;
+    DescriptorView descriptor;
+    uint8_t count = 0;
+    if (nitTransportStreamIteratorInit(view, &it) != SECTION_OK)
+        return PARSING_ERROR;
+    pthread_once(&nitTransportStreamDescriptorsOnce, nitTransportStreamDescriptorsInit);
+    table->header.table_id = view->table_id;
+    table->header.section_syntax_indicator = view->section_syntax_indicator;
+    table->header.section_length = view->section_length;
+    table->header.network_id = view->table_id_extension;
+    table->header.version_number = view->version_number;
+    table->header.current_next_indicator = view->current_next_indicator;
+    table->header.section_number = view->section_number;
+    table->header.last_section_number = view->last_section_number;
+    table->network_name_length = 0;
+    table->network_name = NULL;
+    nitNetworkDescriptors(view, &descriptors);
+    while (descriptorNext(&descriptors, &descriptor))
+    {
+        if (descriptor.tag == 0x40)
+        {
+            table->network_name_length = descriptor.length;
+            table->network_name = descriptor.data;
+        }
+    }
+    while (count < NIT_MAX_TRANSPORT_STREAMS && nitTransportStreamNext(&it, &tsView))
+    {
+        ts = &(table->transportStreams[count]);
+        ts->transport_stream_id = tsView.transport_stream_id;
+        ts->original_network_id = tsView.original_network_id;
+        ts->hasTerrestrialDelivery = 0;
+        ts->serviceCount = 0;
+        descriptorDispatch(&nitTransportStreamDescriptors, tsView.descriptors, tsView.transport_descriptors_length, ts);
+        count++;
+    }
+    table->transportStreamCount = count;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje terrestrial_delivery_system deskriptora (0x5A)
+ *
+ * @param
+descriptor - [in] pogled na deskriptor
+ *
+delivery - [out] deskriptor u koji je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
+ *
+ *****************************************************************************/
+int32_t parseTerrestrialDeliveryDescriptor(const DescriptorView* descriptor, TerrestrialDeliveryDescriptor* delivery)
+{
+    const uint8_t* data = descriptor->data;
+    if (descriptor->length < 7)
+        return PARSING_ERROR;
+    // centre_frequency is coded in multiples of 10 Hz
+    delivery->centre_frequency = (((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) |
+            ((uint32_t) data[2] << 8) | data[3]) * 10;
+    delivery->bandwidth = (uint8_t) (8 - (data[4] >> 5));
+    delivery->priority = (uint8_t) ((data[4] >> 4) & 0x01);
+    delivery->constellation = (uint8_t) (data[5] >> 6);
+    delivery->hierarchy_information = (uint8_t) ((data[5] >> 3) & 0x07);
+    delivery->code_rate_HP_stream = (uint8_t) (data[5] & 0x07);
+    delivery->code_rate_LP_stream = (uint8_t) (data[6] >> 5);
+    delivery->guard_interval = (uint8_t) ((data[6] >> 3) & 0x03);
+    delivery->transmission_mode = (uint8_t) ((data[6] >> 1) & 0x03);
+    delivery->other_frequency_flag = (uint8_t) (data[6] & 0x01);
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija za obradu service deskriptora (0x48) servisa u SDT tabeli.
+ *
+ *****************************************************************************/
+static int32_t sdtServiceDescriptor(const DescriptorView* descriptor, void* userData)
+{
+    SdtService* service = (SdtService*) userData;
+    if (service->hasServiceDescriptor)
+        return 0;
+    service->hasServiceDescriptor = (parseServiceDescriptor(descriptor, &(service->serviceDescriptor)) == 0);
+    return service->hasServiceDescriptor ? 0 : PARSING_ERROR;
+}
+
+static DescriptorDispatchTable sdtServiceDescriptors;
+static pthread_once_t sdtServiceDescriptorsOnce = PTHREAD_ONCE_INIT;
+
+static void sdtServiceDescriptorsInit(void)
+{
+    descriptorDispatchInit(&sdtServiceDescriptors);
+    descriptorDispatchRegister(&sdtServiceDescriptors, 0x48, sdtServiceDescriptor);
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje SDT tabele (actual 0x42 ili other 0x46)
+ * iz validiranog pogleda na sekciju.
+ *
+ * @param
+view - [in] validiran pogled na SDT sekciju
+ *
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije SDT
+ *
+ *****************************************************************************/
+int32_t parseSdtSection(const SectionView* view, SdtTable* table)
+{
+    SdtServiceIterator it;
+    SdtServiceView serviceView;
+    SdtService* service;
+    uint8_t count = 0;
+    if (sdtServiceIteratorInit(view, &it) != SECTION_OK)
+        return PARSING_ERROR;
+    pthread_once(&sdtServiceDescriptorsOnce, sdtServiceDescriptorsInit);
+    table->header.table_id = view->table_id;
+    table->header.section_syntax_indicator = view->section_syntax_indicator;
+    table->header.section_length = view->section_length;
+    table->header.transport_stream_id = view->table_id_extension;
+    table->header.version_number = view->version_number;
+    table->header.current_next_indicator = view->current_next_indicator;
+    table->header.section_number = view->section_number;
+    table->header.last_section_number = view->last_section_number;
+    table->header.original_network_id = (uint16_t) ((view->data[8] << 8) + view->data[9]);
+    while (count < MAX_NUM_OF_SERVICES && sdtServiceNext(&it, &serviceView))
+    {
+        service = &(table->services[count]);
+        service->service_id = serviceView.service_id;
+        service->EIT_schedule_flag = serviceView.EIT_schedule_flag;
+        service->EIT_present_following_flag = serviceView.EIT_present_following_flag;
+        service->running_status = serviceView.running_status;
+        service->free_CA_mode = serviceView.free_CA_mode;
+        service->hasServiceDescriptor = 0;
+        descriptorDispatch(&sdtServiceDescriptors, serviceView.descriptors, serviceView.descriptors_loop_length, service);
+        count++;
+    }
+    table->serviceCount = count;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje service deskriptora (0x48)
+ *
+ * @param
+descriptor - [in] pogled na deskriptor
+ *
+service - [out] deskriptor u koji je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
+ *
+ *****************************************************************************/
+int32_t parseServiceDescriptor(const DescriptorView* descriptor, ServiceDescriptor* service)
+{
+    const uint8_t* data = descriptor->data;
+    uint8_t length = descriptor->length;
+    if (length < 3)
+        return PARSING_ERROR;
+    service->service_type = data[0];
+    service->provider_name_length = data[1];
+    if (2 + service->provider_name_length + 1 > length)
+        return PARSING_ERROR;
+    service->provider_name = data + 2;
+    service->service_name_length = data[2 + service->provider_name_length];
+    if (3 + service->provider_name_length + service->service_name_length > length)
+        return PARSING_ERROR;
+    service->service_name = data + 3 + service->provider_name_length;
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za ispis SDT tabele na standardni izlaz
+ *
+ * @param
+table - [in] tabela koju je potrebno ispisati
+ *
+ *****************************************************************************/
+void dumpSdtTable(SdtTable* table)
+{
+    char name[64];
+    char provider[64];
+    int i;
+    printf("\n<<<<<<<<<<<<<<<<<SDT TABLE>>>>>>>>>>>>>>>>>>>>>>>>\n");
+    printf("table_id: %x ts_id: %d onid: %d version: %d section: %d/%d\n", table->header.table_id,
+           table->header.transport_stream_id, table->header.original_network_id, table->header.version_number,
+           table->header.section_number, table->header.last_section_number);
+    for (i = 0; i < table->serviceCount; i++)
+    {
+        SdtService* service = &(table->services[i]);
+        name[0] = provider[0] = '\0';
+        if (service->hasServiceDescriptor)
+        {
+            dvbStringCopy(name, sizeof (name), service->serviceDescriptor.service_name, service->serviceDescriptor.service_name_length);
+            dvbStringCopy(provider, sizeof (provider), service->serviceDescriptor.provider_name, service->serviceDescriptor.provider_name_length);
+        }
+        printf("service_id: %d type: %x running: %d CA: %d name: %s provider: %s\n", service->service_id,
+               service->hasServiceDescriptor ? service->serviceDescriptor.service_type : 0,
+               service->running_status, service->free_CA_mode, name, provider);
+    }
+    printf("\n<<<<<<<<<<<<<<<<<SDT TABLE>>>>>>>>>>>>>>>>>>>>>>>>\n");
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja kopira DVB tekst (ETSI EN 300 468, Annex A) u C string. Izbor
+ * tabele karaktera na pocetku teksta i kontrolni kodovi 0x80 - 0x9F se
+ * preskacu.
+ *
+ * @param
+dst - [out] odredisni bafer
+ *
+dstSize - [in] velicina odredisnog bafera, ukljucujuci '\0'
+ *
+src - [in] DVB tekst
+ *
+length - [in] duzina DVB teksta
+ *
+ * @return broj upisanih karaktera (bez '\0')
+ *
+ *****************************************************************************/
+uint32_t dvbStringCopy(char* dst, uint32_t dstSize, const uint8_t* src, uint32_t length)
+{
+    uint32_t i = 0;
+    uint32_t written = 0;
+    if (dstSize == 0)
+        return 0;
+    if (length > 0 && src[0] < 0x20)
+    {
+        /* 0x10: tri bajta (ISO 8859 tabela), 0x1F: dva bajta, ostalo: jedan bajt */
+        i = (src[0] == 0x10) ? 3 : (src[0] == 0x1F) ? 2 : 1;
+    }
+    for (; i < length && written + 1 < dstSize; i++)
+    {
+        if (src[i] == 0x8A)
+            dst[written++] = ' ';
+        else if (src[i] >= 0x20 && (src[i] < 0x80 || src[i] > 0x9F))
+            dst[written++] = (char) src[i];
+    }
+    dst[written] = '\0';
+    return written;
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja pretvara start_time polje EIT dogadjaja (MJD + BCD UTC) u broj
+ * sekundi od 1.1.1970 (UTC).
+ *
+ * @param
+start_time - [in] 40-bitno polje iz EIT tabele
+ *
+ * @return broj sekundi, ili 0 ako vrijeme nije definisano
+ *
+ *****************************************************************************/
+uint32_t dvbTimeToEpoch(const uint8_t* start_time)
+{
+    uint32_t mjd = (uint32_t) ((start_time[0] << 8) + start_time[1]);
+    /* 40587 je MJD datuma 1.1.1970 */
+    if (mjd < 40587 || (start_time[0] == 0xFF && start_time[1] == 0xFF))
+        return 0;
+    return (mjd - 40587) * 86400 + dvbDurationToSeconds(start_time + 2);
+}
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja pretvara trajanje u BCD formatu (hh mm ss) u broj sekundi
+ *
+ * @param
+duration - [in] 24-bitno polje iz EIT tabele
+ *
+ * @return broj sekundi
+ *
+ *****************************************************************************/
+uint32_t dvbDurationToSeconds(const uint8_t* duration)
+{
+    uint32_t hours = (uint32_t) ((duration[0] >> 4) * 10 + (duration[0] & 0x0F));
+    uint32_t minutes = (uint32_t) ((duration[1] >> 4) * 10 + (duration[1] & 0x0F));
+    uint32_t seconds = (uint32_t) ((duration[2] >> 4) * 10 + (duration[2] & 0x0F));
+    return hours * 3600 + minutes * 60 + seconds;
 }
 
 /****************************************************************************
@@ -407,10 +1021,14 @@ patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
  *****************************************************************************/
 void dumpEitEvent(EitEvents *event)
 {
-    printf("\tEvent id: %d", event->event_id);
+    printf("\tEvent id: %d\n", event->event_id);
     printf("\tStart time %x%x%x%x%x\n", event->start_time[0], event->start_time[1], event->start_time[2], event->start_time[3], event->start_time[4]);
     printf("\tDuration %x:%x:%x\n", event->durration[0], event->durration[1], event->durration[2]);
     printf("\tDescriptors loop length %d\n", event->descriptor_loop_length);
+    if (event->hasShortEvent)
+    {
+        printf("\tName %.*s\n", event->shortEvent.event_name_length, (const char*) event->shortEvent.event_name);
+    }
 }
 
 /****************************************************************************
@@ -437,7 +1055,7 @@ void dumpEitHeader(EitHeader* table)
     printf("last_section_number %d\n", table->last_section_number);
     printf("transport_stream_id %d\n", table->transport_stream_id);
     printf("original_network_id %d\n", table->original_network_id);
-    printf("segment_last_section_number %d", table->segment_last_section_number);
+    printf("segment_last_section_number %d\n", table->segment_last_section_number);
     printf("last_table_id %d\n", table->last_table_id);
     printf("<<<<<<<<<<<<<<<<<<<<<<<>>>>>>>>>>>>>>>>>>>>>>>\n");
 }
@@ -12,7 +12,7 @@
  *
  * \file table_parser.c
  * \brief
- * Ovaj modul realizuje parsiranje PMT,PAT i EIT tabela, uz postojanje fukcija za
+ * Ovaj modul realizuje parsiranje PMT,PAT,NIT,SDT i EIT tabela, uz postojanje fukcija za
  * ispis sadrzaja na standardni izlaz.
  * 
  * @Author Milan Maric
@@ -23,12 +23,15 @@
 #define TABLES_H_
 
 #include <stdint.h>
-#include "config_parser.h"
+#include "section_view.h"
 
 #define MAX_NUM_OF_PIDS 20
 #define PARSING_ERROR -1
 #define INIT_ERROR -1
 #define MAX_NUM_OF_EVENTS 5
+#define MAX_NUM_OF_SERVICES 64
+#define NIT_MAX_TRANSPORT_STREAMS 16
+#define NIT_MAX_SERVICES 32
 
 typedef struct _PatHeader
 {
@@ -69,11 +72,40 @@ typedef struct _PmtHeader
     uint16_t program_info_length;
 } PmtHeader;
 
+typedef enum _StreamClass
+{
+    STREAM_CLASS_UNKNOWN = 0,
+    STREAM_CLASS_VIDEO,
+    STREAM_CLASS_AUDIO,
+    STREAM_CLASS_TELETEXT,
+    STREAM_CLASS_SUBTITLES,
+    STREAM_CLASS_DATA
+} StreamClass;
+
+typedef enum _StreamCodec
+{
+    STREAM_CODEC_UNKNOWN = 0,
+    STREAM_CODEC_MPEG1_VIDEO,
+    STREAM_CODEC_MPEG2_VIDEO,
+    STREAM_CODEC_H264,
+    STREAM_CODEC_HEVC,
+    STREAM_CODEC_MPEG1_AUDIO,
+    STREAM_CODEC_MPEG2_AUDIO,
+    STREAM_CODEC_AC3,
+    STREAM_CODEC_EAC3,
+    STREAM_CODEC_AAC
+} StreamCodec;
+
 typedef struct _PmtServiceInfo
 {
     uint8_t stream_type;
     uint16_t el_pid;
     uint16_t es_info_length;
+    uint8_t stream_class; // StreamClass, iz stream_type i deskriptora
+    uint8_t codec; // StreamCodec
+    char language[4]; // ISO 639-2 jezik (0x0A, 0x56 ili 0x59 deskriptor), "" ako nije naveden
+    uint8_t hasComponentTag; // 1 ako je stream_identifier deskriptor (0x52) pronadjen
+    uint8_t component_tag;
 } PmtServiceInfo;
 
 typedef struct _PmtTable
@@ -84,23 +116,40 @@ typedef struct _PmtTable
     uint8_t teletekst;
 } PmtTable;
 
+#define EIT_MAX_EXTENDED_DESCRIPTORS 4
+
 typedef struct _ShortEventDesriptor
 {
     uint8_t dvb_DescriptorTag;
     uint8_t descriptor_length;
-    uint8_t languageCode;
+    uint8_t language_code[3]; // ISO 639-2 jezik
     uint8_t event_name_length;
-    char* event_name;
+    const uint8_t* event_name; // pokazuje u bafer sekcije, validno dok traje callback
+    uint8_t text_length;
+    const uint8_t* text; // pokazuje u bafer sekcije, validno dok traje callback
 } ShortEventDescriptor;
 
+typedef struct _ExtendedEventDescriptor
+{
+    uint8_t descriptor_number;
+    uint8_t last_descriptor_number;
+    uint8_t language_code[3];
+    uint8_t text_length;
+    const uint8_t* text; // pokazuje u bafer sekcije, validno dok traje callback
+} ExtendedEventDescriptor;
+
 typedef struct _EitEvents
 {
     uint16_t event_id; //	16	This 16 bit field indicates the event id of the event for which information is given. Within a service this id must be unique.
     uint8_t start_time[5]; //start time	40	This 40 bit field gives the start time and date in UTC and MJD of the event. The first 16 bits represent the 16 bits MJD,then the 24-bit UTC as 6 digits in 4-bit BCD
     uint8_t durration[3]; //	24	This 24 bit field indicates the length of the event in hours, minutes, seconds as 4 bits BCD. for instance 02:25:30 is encoded as 0x022530
     uint8_t running_status; //	3	This field gives information about the status of the event, 000 = undefined, 001 = not running, 010 = start in a few seconds, 011 = pause, 100 = running, 101 - 111 reserved for future use. In the case of an NVOD reference event, the running status will be put to '0'
+    uint8_t free_CA_mode; //	1	0 = all component streams of the event are not scrambled
     uint16_t descriptor_loop_length; //12	The length of the descriptor loop.
-    ShortEventDescriptor descriptors[MAX_NUM_OF_PIDS];
+    uint8_t hasShortEvent; // 1 ako je short_event deskriptor (0x4D) pronadjen
+    ShortEventDescriptor shortEvent;
+    uint8_t extendedEventCount;
+    ExtendedEventDescriptor extendedEvents[EIT_MAX_EXTENDED_DESCRIPTORS];
 } EitEvents;
 
 typedef struct _EitHeader
@@ -123,8 +172,102 @@ typedef struct _EitTable
 {
     EitHeader header;
     EitEvents events[MAX_NUM_OF_EVENTS];
+    uint8_t eventCount;
 } EitTable;
 
+typedef struct _NitHeader
+{
+    uint8_t table_id;
+    uint8_t section_syntax_indicator;
+    uint16_t section_length;
+    uint16_t network_id;
+    uint8_t version_number;
+    uint8_t current_next_indicator;
+    uint8_t section_number;
+    uint8_t last_section_number;
+} NitHeader;
+
+typedef struct _TerrestrialDeliveryDescriptor
+{
+    uint32_t centre_frequency; // Hz
+    uint8_t bandwidth; // MHz (8, 7, 6 ili 5)
+    uint8_t priority;
+    uint8_t constellation; // 0 QPSK, 1 16-QAM, 2 64-QAM
+    uint8_t hierarchy_information;
+    uint8_t code_rate_HP_stream;
+    uint8_t code_rate_LP_stream;
+    uint8_t guard_interval;
+    uint8_t transmission_mode; // 0 2k, 1 8k, 2 4k
+    uint8_t other_frequency_flag;
+} TerrestrialDeliveryDescriptor;
+
+typedef struct _NitService
+{
+    uint16_t service_id;
+    uint8_t service_type; // iz service_list deskriptora (0x41), 0 ako nije naveden
+    uint8_t visible_service_flag;
+    uint16_t logical_channel_number; // iz LCN deskriptora (0x83), 0 ako nije naveden
+} NitService;
+
+typedef struct _NitTransportStream
+{
+    uint16_t transport_stream_id;
+    uint16_t original_network_id;
+    uint8_t hasTerrestrialDelivery; // 1 ako je terrestrial_delivery_system deskriptor (0x5A) pronadjen
+    TerrestrialDeliveryDescriptor terrestrialDelivery;
+    uint8_t serviceCount;
+    NitService services[NIT_MAX_SERVICES];
+} NitTransportStream;
+
+typedef struct _NitTable
+{
+    NitHeader header;
+    uint8_t network_name_length;
+    const uint8_t* network_name; // pokazuje u bafer sekcije, validno dok traje callback
+    uint8_t transportStreamCount;
+    NitTransportStream transportStreams[NIT_MAX_TRANSPORT_STREAMS];
+} NitTable;
+
+typedef struct _SdtHeader
+{
+    uint8_t table_id;
+    uint8_t section_syntax_indicator;
+    uint16_t section_length;
+    uint16_t transport_stream_id;
+    uint8_t version_number;
+    uint8_t current_next_indicator;
+    uint8_t section_number;
+    uint8_t last_section_number;
+    uint16_t original_network_id;
+} SdtHeader;
+
+typedef struct _ServiceDescriptor
+{
+    uint8_t service_type; // 0x01 TV, 0x02 radio, 0x0C data, 0x16/0x19 H.264 SD/HD...
+    uint8_t provider_name_length;
+    const uint8_t* provider_name; // pokazuje u bafer sekcije, validno dok traje callback
+    uint8_t service_name_length;
+    const uint8_t* service_name; // pokazuje u bafer sekcije, validno dok traje callback
+} ServiceDescriptor;
+
+typedef struct _SdtService
+{
+    uint16_t service_id;
+    uint8_t EIT_schedule_flag;
+    uint8_t EIT_present_following_flag;
+    uint8_t running_status;
+    uint8_t free_CA_mode;
+    uint8_t hasServiceDescriptor; // 1 ako je service deskriptor (0x48) pronadjen
+    ServiceDescriptor serviceDescriptor;
+} SdtService;
+
+typedef struct _SdtTable
+{
+    SdtHeader header;
+    SdtService services[MAX_NUM_OF_SERVICES];
+    uint8_t serviceCount;
+} SdtTable;
+
 /****************************************************************************
  *
  * @brief
@@ -138,87 +281,198 @@ table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parseEitTable(uint8_t* buffer, EitTable* table);
+int32_t parseEitTable(uint8_t* buffer, EitTable* table);
 
 /****************************************************************************
  *
  * @brief
- * Fukcija koja se koristi za ispis zaglavlja EIT tabele na standardni izlaz
+Fukcija koja se koristi za parsiranje EIT tabele (present/following i schedule)
+ * iz validiranog pogleda na sekciju. Parsiraju se svi dogadjaji (najvise
+ * MAX_NUM_OF_EVENTS) zajedno sa short_event i extended_event deskriptorima.
+ * Tekstualna polja pokazuju u bafer sekcije.
  *
  * @param
- * table - [in] tabela cije ce zaglavlje biti ispisano
+view - [in] validiran pogled na EIT sekciju
  *
+table - [out] tabela u koju je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako sekcija nije EIT
  *
  *****************************************************************************/
-void dumpEitHeader(EitHeader* table);
+int32_t parseEitSection(const SectionView* view, EitTable* table);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje zaglavlja EIT tabele
+Fukcija koja se koristi za parsiranje short_event deskriptora (0x4D)
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+descriptor - [in] pogled na deskriptor
+ *
+shortEvent - [out] deskriptor u koji je potrebno upisati vrijednosti
  *
-header - [out] zaglavlje u koje je potrebno upisati vrijednosti
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
+ *
+ *****************************************************************************/
+int32_t parseShortEventDescriptor(const DescriptorView* descriptor, ShortEventDescriptor* shortEvent);
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja se koristi za parsiranje extended_event deskriptora (0x4E).
+ * Parsira se samo tekst dogadjaja, lista stavki (items) se preskace.
+ *
+ * @param
+descriptor - [in] pogled na deskriptor
  *
+extendedEvent - [out] deskriptor u koji je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
  *
  *****************************************************************************/
-void parseEitHeader(uint8_t* buffer, EitHeader* header);
+int32_t parseExtendedEventDescriptor(const DescriptorView* descriptor, ExtendedEventDescriptor* extendedEvent);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje EIT dogadjaja (event)
+Fukcija koja se koristi za parsiranje NIT tabele (actual 0x40 ili other 0x41)
+ * iz validiranog pogleda na sekciju. Za svaki transportni tok se parsiraju
+ * terrestrial_delivery_system (0x5A), service_list (0x41) i
+ * logical_channel_number (0x83) deskriptori.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+view - [in] validiran pogled na NIT sekciju
+ *
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije NIT
+ *
+ *****************************************************************************/
+int32_t parseNitSection(const SectionView* view, NitTable* table);
+
+/****************************************************************************
  *
-event - [out] zaglavlje u koje je potrebno upisati vrijednosti
+ * @brief
+Fukcija koja se koristi za parsiranje terrestrial_delivery_system deskriptora (0x5A)
+ *
+ * @param
+descriptor - [in] pogled na deskriptor
  *
+delivery - [out] deskriptor u koji je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
  *
  *****************************************************************************/
-void parseEitEvent(uint8_t* buffer, EitEvents* event);
+int32_t parseTerrestrialDeliveryDescriptor(const DescriptorView* descriptor, TerrestrialDeliveryDescriptor* delivery);
 
 /****************************************************************************
  *
  * @brief
- * Fukcija koja se koristi za ispis EIT evenata na standardni izlaz
+Fukcija koja se koristi za parsiranje SDT tabele (actual 0x42 ili other 0x46)
+ * iz validiranog pogleda na sekciju. Broj upisanih servisa je ogranicen na
+ * MAX_NUM_OF_SERVICES, a nazivi pokazuju u bafer sekcije.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+view - [in] validiran pogled na SDT sekciju
  *
-patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
+table - [out] tabela u koju je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako sekcija nije SDT
  *
+ *****************************************************************************/
+int32_t parseSdtSection(const SectionView* view, SdtTable* table);
+
+/****************************************************************************
  *
+ * @brief
+Fukcija koja se koristi za parsiranje service deskriptora (0x48)
+ *
+ * @param
+descriptor - [in] pogled na deskriptor
+ *
+service - [out] deskriptor u koji je potrebno upisati vrijednosti
+ *
+ * @return 0, ili PARSING_ERROR ako deskriptor nije ispravan
  *
  *****************************************************************************/
-void dumpEitEvent(EitEvents* event);
+int32_t parseServiceDescriptor(const DescriptorView* descriptor, ServiceDescriptor* service);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje niza servisnih informacija iz PAT tabele
+Fukcija koja se koristi za ispis SDT tabele na standardni izlaz
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+table - [in] tabela koju je potrebno ispisati
+ *
+ *****************************************************************************/
+void dumpSdtTable(SdtTable* table);
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja kopira DVB tekst (ETSI EN 300 468, Annex A) u C string. Izbor
+ * tabele karaktera na pocetku teksta i kontrolni kodovi 0x80 - 0x9F se
+ * preskacu.
  *
-patServiceInfoArray - [out] niz servisnih informacija u koje je potrebno upisati parsirane vrijednosti
+ * @param
+dst - [out] odredisni bafer
  *
-section_length - [in] vrijednost koja predstavlja duzinu sekcije(polje iz PAT header - a)
+dstSize - [in] velicina odredisnog bafera, ukljucujuci '\0'
  *
+src - [in] DVB tekst
  *
+length - [in] duzina DVB teksta
+ *
+ * @return broj upisanih karaktera (bez '\0')
+ *
+ *****************************************************************************/
+uint32_t dvbStringCopy(char* dst, uint32_t dstSize, const uint8_t* src, uint32_t length);
+
+/****************************************************************************
+ *
+ * @brief
+Fukcija koja pretvara start_time polje EIT dogadjaja (MJD + BCD UTC) u broj
+ * sekundi od 1.1.1970 (UTC).
+ *
+ * @param
+start_time - [in] 40-bitno polje iz EIT tabele
+ *
+ * @return broj sekundi, ili 0 ako vrijeme nije definisano
  *
  *****************************************************************************/
-void parsePatServiceInfoArray(uint8_t *buffer, PatServiceInfo patServiceInfoArray[], uint16_t section_length);
+uint32_t dvbTimeToEpoch(const uint8_t* start_time);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje zaglavlja PAT tabele
+Fukcija koja pretvara trajanje u BCD formatu (hh mm ss) u broj sekundi
+ *
+ * @param
+duration - [in] 24-bitno polje iz EIT tabele
+ *
+ * @return broj sekundi
+ *
+ *****************************************************************************/
+uint32_t dvbDurationToSeconds(const uint8_t* duration);
+
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja se koristi za ispis zaglavlja EIT tabele na standardni izlaz
+ *
+ * @param
+ * table - [in] tabela cije ce zaglavlje biti ispisano
+ *
+ *
+ *
+ *****************************************************************************/
+void dumpEitHeader(EitHeader* table);
+
+/****************************************************************************
+ *
+ * @brief
+ * Fukcija koja se koristi za ispis EIT evenata na standardni izlaz
  *
  * @param
 buff - [in] Ulazni bafer sa odmercima
@@ -228,7 +482,9 @@ patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parsePatHeader(uint8_t *buffer, PatHeader* patHeader);
+void dumpEitEvent(EitEvents* event);
+
+
 
 /****************************************************************************
  *
@@ -243,54 +499,58 @@ table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *****************************************************************************/
-void parsePatTable(uint8_t *buffer, PatTable* table);
+int32_t parsePatTable(uint8_t *buffer, PatTable* table);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje PMT tabele
+Fukcija koja se koristi za parsiranje PAT tabele iz validiranog pogleda na sekciju.
+ * Broj upisanih programa je ogranicen na MAX_NUM_OF_PIDS.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
+view - [in] validiran pogled na PAT sekciju
  *
 table - [out] tabela u koju je potrebno upisati vrijednosti
  *
- *
+ * @return 0, ili PARSING_ERROR ako sekcija nije PAT
  *
  *****************************************************************************/
-void parsePmt(uint8_t *buffer, PmtTable* table);
+int32_t parsePatSection(const SectionView* view, PatTable* table);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje zaglavlja PMT tabele
+Fukcija koja se koristi za parsiranje PMT tabele
  *
  * @param
 buff - [in] Ulazni bafer sa odmercima
  *
-patHeader - [out] zaglavlje u koje je potrebno upisati vrijednosti
+table - [out] tabela u koju je potrebno upisati vrijednosti
  *
  *
  *
  *****************************************************************************/
-void parsePmtHeader(uint8_t *buffer, PmtHeader* pmtHeader);
+int32_t parsePmt(uint8_t *buffer, PmtTable* table);
 
 /****************************************************************************
  *
  * @brief
-Fukcija koja se koristi za parsiranje niza servisnih informacija iz PMT tabele
+Fukcija koja se koristi za parsiranje PMT tabele iz validiranog pogleda na sekciju.
+ * Broj upisanih elementarnih tokova je ogranicen na MAX_NUM_OF_PIDS. Svaki tok
+ * se klasifikuje (video, audio, teletekst, titlovi) po stream_type polju i
+ * deskriptorima 0x0A, 0x52, 0x56, 0x59, 0x6A, 0x7A i 0x7C.
  *
  * @param
-buff - [in] Ulazni bafer sa odmercima
- *
-pmtServiceInfoArray - [out] niz servisnih informacija u koje je potrebno upisati parsirane vrijednosti
- *
-broj - [out] broj sekcija koje ce biti parsirane
+view - [in] validiran pogled na PMT sekciju
  *
+table - [out] tabela u koju je potrebno upisati vrijednosti
  *
+ * @return 0, ili PARSING_ERROR ako sekcija nije PMT
  *
  *****************************************************************************/
-void parsePmtServiceInfoArray(uint8_t *buffer, PmtServiceInfo pmtServiceInfoArray[], uint8_t* broj, uint8_t* teletekst);
+int32_t parsePmtSection(const SectionView* view, PmtTable* table);
+
+
 
 /****************************************************************************
  *
@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file drawing_host.c
+ * \brief
+ * Zamjena za drawing.c na racunaru, bez DirectFB-a. Funkcije ne iscrtavaju
+ * nista, tako da se device_control.c moze povezati sa libtdp_host.a.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "drawing.h"
+#include <stdint.h>
+
+void drawTextInfo(int32_t service_number, const char* name, uint16_t vpid, uint16_t apid, uint8_t teletekst, const char* title)
+{
+}
+
+void initDirectFB()
+{
+}
+
+void deinitDirectFB()
+{
+}
+
+void drawVolume(int32_t volume)
+{
+}
+
+void fillBlack()
+{
+}
+
+void fillTransparent()
+{
+}
@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file tdp_api.h
+ * \brief
+ * Zamjena za tdp_api biblioteku proizvodjaca za prevodjenje na racunaru.
+ * Tipovi i potpisi funkcija su isti kao u originalnom tdp_api.h, tako da se
+ * device_control.c i config_parser.c prevode bez izmjena kada je ovaj
+ * direktorijum naveden u putanji za zaglavlja (-Itdp_host). Implementacija je
+ * u tdp_host.c, a dodatne funkcije za podesavanje simulacije u tdp_host.h.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef TDP_API_H
+#define TDP_API_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#define NO_ERROR 0
+#define ERROR 1
+
+typedef enum
+{
+    STATUS_ERROR = 0,
+    STATUS_LOCKED
+} t_LockStatus;
+
+typedef enum
+{
+    DVB_T = 0,
+    DVB_T2
+} t_Module;
+
+typedef enum
+{
+    VIDEO_TYPE_H264 = 0,
+    VIDEO_TYPE_VC1,
+    VIDEO_TYPE_MPEG4,
+    VIDEO_TYPE_MPEG2,
+    VIDEO_TYPE_MPEG1,
+    VIDEO_TYPE_JPEG,
+    VIDEO_TYPE_DIV3,
+    VIDEO_TYPE_DIV4,
+    VIDEO_TYPE_DX50,
+    VIDEO_TYPE_MVC,
+    VIDEO_TYPE_WMV3,
+    VIDEO_TYPE_DIVX,
+    VIDEO_TYPE_DIV5,
+    VIDEO_TYPE_RV30,
+    VIDEO_TYPE_RV40,
+    VIDEO_TYPE_VP6,
+    VIDEO_TYPE_SORENSON,
+    VIDEO_TYPE_H263,
+    VIDEO_TYPE_JPEG_SINGLE,
+    VIDEO_TYPE_VP8,
+    VIDEO_TYPE_VP6F,
+
+    AUDIO_TYPE_DOLBY_AC3 = 100,
+    AUDIO_TYPE_DOLBY_PLUS,
+    AUDIO_TYPE_DOLBY_TRUE_HD,
+    AUDIO_TYPE_LPCM_SD,
+    AUDIO_TYPE_LPCM_BD,
+    AUDIO_TYPE_LPCM_HD,
+    AUDIO_TYPE_MLP,
+    AUDIO_TYPE_DTS,
+    AUDIO_TYPE_DTS_HD,
+    AUDIO_TYPE_MPEG_AUDIO,
+    AUDIO_TYPE_MP3,
+    AUDIO_TYPE_HE_AAC,
+    AUDIO_TYPE_WMA,
+    AUDIO_TYPE_WMA_PRO,
+    AUDIO_TYPE_WMA_LOSSLESS,
+    AUDIO_TYPE_RAW_PCM,
+    AUDIO_TYPE_SDDS,
+    AUDIO_TYPE_DD_DCV,
+    AUDIO_TYPE_DRA,
+    AUDIO_TYPE_DRA_EXT,
+    AUDIO_TYPE_DTS_LBR,
+    AUDIO_TYPE_DTS_HRES,
+    AUDIO_TYPE_LPCM_SESF,
+    AUDIO_TYPE_DV_SD,
+    AUDIO_TYPE_VORBIS,
+    AUDIO_TYPE_FLAC,
+    AUDIO_TYPE_RAW_AAC,
+    AUDIO_TYPE_RA8,
+    AUDIO_TYPE_RAAC,
+    AUDIO_TYPE_ADPCM,
+    AUDIO_TYPE_SPDIF_INPUT,
+    AUDIO_TYPE_G711A,
+    AUDIO_TYPE_G711U,
+    AUDIO_RAW_SIGNED_PCM,
+    AUDIO_RAW_UNSIGNED_PCM,
+    AUDIO_AMR_WB,
+    AUDIO_AMR_NB,
+    AUDIO_TYPE_UNSUPPORTED
+} tStreamType;
+
+typedef int32_t(*Tuner_Status_Callback)(t_LockStatus status);
+typedef int32_t(*Demux_Section_Filter_Callback)(uint8_t *buffer);
+
+int32_t Tuner_Init();
+int32_t Tuner_Deinit();
+int32_t Tuner_Lock_To_Frequency(uint32_t tuneFrequency, uint32_t bandwidth, t_Module module);
+int32_t Tuner_Register_Status_Callback(Tuner_Status_Callback tunerStatusCallback);
+int32_t Tuner_Unregister_Status_Callback(Tuner_Status_Callback tunerStatusCallback);
+
+int32_t Player_Init(uint32_t *playerHandle);
+int32_t Player_Deinit(uint32_t playerHandle);
+int32_t Player_Source_Open(uint32_t playerHandle, uint32_t *sourceHandle);
+int32_t Player_Source_Close(uint32_t playerHandle, uint32_t sourceHandle);
+int32_t Player_Stream_Create(uint32_t playerHandle, uint32_t sourceHandle, uint32_t PID, tStreamType streamType, uint32_t *streamHandle);
+int32_t Player_Stream_Remove(uint32_t playerHandle, uint32_t sourceHandle, uint32_t streamHandle);
+int32_t Player_Volume_Set(uint32_t playerHandle, uint32_t volume);
+int32_t Player_Volume_Get(uint32_t playerHandle, uint32_t *volume);
+
+int32_t Demux_Set_Filter(uint32_t playerHandle, uint32_t PID, uint32_t tableID, uint32_t *filterHandle);
+int32_t Demux_Free_Filter(uint32_t playerHandle, uint32_t filterHandle);
+int32_t Demux_Register_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback);
+int32_t Demux_Unregister_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback);
+
+#endif
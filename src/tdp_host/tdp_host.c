@@ -0,0 +1,559 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file tdp_host.c
+ * \brief
+ * Zamjena za tdp_api na racunaru. Nit tjunera nakon kasnjenja zakljucavanja
+ * poziva callback funkciju tjunera, a zatim reprodukuje transportni tok iz
+ * fajla kroz section_assembler. Sekcije ciji PID i table_id odgovaraju nekom
+ * postavljenom filteru se kopiraju u bafer i predaju callback funkciji
+ * demultipleksera, kao sto to radi drajver na uredjaju. Sastavljac koristi
+ * samo nit tjunera; ostale niti samo mijenjaju tabelu filtera, a nit tjunera
+ * uskladjuje PID-ove sastavljaca prije svakog bloka paketa. Callback funkcije
+ * se pozivaju bez zakljucanog mutex-a, tako da smiju pozivati Demux_*.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "tdp_api.h"
+#include "tdp_host.h"
+#include "section_assembler.h"
+#include "section_view.h"
+#include "clock_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TDP_HOST_DEFAULT_LOCK_MS 300
+#define TDP_HOST_DEFAULT_STREAM_MS 40
+#define TDP_HOST_DEFAULT_BITRATE 20000000
+#define TDP_HOST_DEFAULT_FILTERS 8
+
+typedef struct _TdpHostFilter
+{
+    uint8_t used;
+    uint16_t pid;
+    uint8_t tableId;
+} TdpHostFilter;
+
+static TdpHostConfig config;
+static uint8_t configured = 0;
+/* config.log was opened from TDP_HOST_LOG and is closed by Tuner_Deinit */
+static uint8_t logOwned = 0;
+static pthread_mutex_t tdpMutex = PTHREAD_MUTEX_INITIALIZER;
+/* signalled when the tuner thread has to stop waiting */
+static pthread_cond_t tdpCondition = PTHREAD_COND_INITIALIZER;
+
+static TdpHostCall calls[TDP_HOST_MAX_CALLS];
+static uint32_t callCount = 0;
+static uint64_t startTime = 0;
+
+static Tuner_Status_Callback tunerCallback = NULL;
+static Demux_Section_Filter_Callback sectionCallback = NULL;
+
+static TdpHostFilter filters[TDP_HOST_MAX_FILTERS];
+static uint8_t filtersChanged = 0;
+/* PID-ovi ukljuceni u sastavljacu, mijenja ih samo nit tjunera */
+static uint16_t assembledPids[TDP_HOST_MAX_FILTERS];
+static uint32_t assembledCount = 0;
+
+static SectionAssembler* assembler = NULL;
+static uint8_t sectionBuffer[SECTION_MAX_SIZE];
+static uint64_t sectionCount = 0;
+
+static const uint8_t* tsData = NULL;
+static size_t tsSize = 0;
+static pthread_t tunerThread;
+static uint8_t tunerRunning = 0;
+static volatile uint8_t tunerStop = 0;
+
+static uint32_t playerVolume = 0;
+static uint32_t nextStreamHandle = 0;
+
+static uint64_t tdpHostNow(void)
+{
+    return clockNow();
+}
+
+/* waits on the clock source, so a simulation can run the tuner on virtual time */
+static void tdpHostSleepUntil(uint64_t deadline, const volatile uint8_t* stop)
+{
+    pthread_mutex_lock(&tdpMutex);
+    while ((stop == NULL || !*stop) && clockWait(&tdpCondition, &tdpMutex, deadline) != ETIMEDOUT);
+    pthread_mutex_unlock(&tdpMutex);
+}
+
+static uint32_t tdpHostEnv(const char* name, uint32_t defaultValue)
+{
+    const char* value = getenv(name);
+    return (value != NULL) ? (uint32_t) strtoul(value, NULL, 10) : defaultValue;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita podesavanja iz okruzenja ako tdpHostConfigure nije
+ * pozvana.
+ *
+ *****************************************************************************/
+static void tdpHostLoadDefaults(void)
+{
+    const char* logPath;
+    if (configured)
+        return;
+    config.tsPath = getenv("TDP_HOST_TS");
+    config.lockDelayMs = tdpHostEnv("TDP_HOST_LOCK_MS", TDP_HOST_DEFAULT_LOCK_MS);
+    config.streamCreateMs = tdpHostEnv("TDP_HOST_STREAM_MS", TDP_HOST_DEFAULT_STREAM_MS);
+    config.bitrate = tdpHostEnv("TDP_HOST_BITRATE", TDP_HOST_DEFAULT_BITRATE);
+    config.filterCount = tdpHostEnv("TDP_HOST_FILTERS", TDP_HOST_DEFAULT_FILTERS);
+    logPath = getenv("TDP_HOST_LOG");
+    config.log = (logPath != NULL) ? fopen(logPath, "w") : NULL;
+    logOwned = (config.log != NULL);
+    if (config.filterCount > TDP_HOST_MAX_FILTERS)
+        config.filterCount = TDP_HOST_MAX_FILTERS;
+    configured = 1;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja biljezi poziv tdp_api funkcije.
+ *
+ * @param function - [in] naziv funkcije
+ * @param start - [in] vrijeme pocetka poziva (tdpHostNow)
+ * @param a0, a1, a2 - [in] argumenti poziva
+ * @param result - [in] rezultat poziva
+ * @return result
+ *****************************************************************************/
+static int32_t tdpHostRecord(const char* function, uint64_t start, uint32_t a0, uint32_t a1, uint32_t a2, int32_t result)
+{
+    TdpHostCall* call;
+    uint64_t end = tdpHostNow();
+    pthread_mutex_lock(&tdpMutex);
+    if (startTime == 0)
+        startTime = start;
+    if (callCount < TDP_HOST_MAX_CALLS)
+    {
+        call = &calls[callCount++];
+        call->timestamp = start - startTime;
+        call->duration = end - start;
+        call->function = function;
+        call->args[0] = a0;
+        call->args[1] = a1;
+        call->args[2] = a2;
+        call->result = result;
+        if (config.log != NULL)
+        {
+            fprintf(config.log, "%12.3f ms %-42s %6u %6u %6u -> %d (%.3f ms)\n", call->timestamp / 1e6, function, a0, a1, a2,
+                    result, call->duration / 1e6);
+            fflush(config.log);
+        }
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return result;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ukljucuje PID-ove postavljenih filtera u sastavljacu i
+ * iskljucuje ostale. Poziva je samo nit tjunera.
+ *
+ *****************************************************************************/
+static void tdpHostSyncPids(void)
+{
+    uint16_t wanted[TDP_HOST_MAX_FILTERS];
+    uint32_t wantedCount = 0;
+    uint32_t i;
+    uint32_t j;
+    pthread_mutex_lock(&tdpMutex);
+    if (!filtersChanged)
+    {
+        pthread_mutex_unlock(&tdpMutex);
+        return;
+    }
+    for (i = 0; i < TDP_HOST_MAX_FILTERS; i++)
+    {
+        if (filters[i].used)
+            wanted[wantedCount++] = filters[i].pid;
+    }
+    filtersChanged = 0;
+    pthread_mutex_unlock(&tdpMutex);
+
+    for (i = 0; i < assembledCount; i++)
+    {
+        for (j = 0; j < wantedCount && wanted[j] != assembledPids[i]; j++);
+        if (j == wantedCount)
+            sectionAssemblerRemovePid(assembler, assembledPids[i]);
+    }
+    assembledCount = 0;
+    for (i = 0; i < wantedCount; i++)
+    {
+        for (j = 0; j < assembledCount && assembledPids[j] != wanted[i]; j++);
+        if (j < assembledCount)
+            continue;
+        sectionAssemblerAddPid(assembler, wanted[i]);
+        assembledPids[assembledCount++] = wanted[i];
+    }
+}
+
+static int32_t tdpHostSection(uint16_t pid, const uint8_t* section, uint16_t length, void* userData)
+{
+    Demux_Section_Filter_Callback callback;
+    uint32_t i;
+    pthread_mutex_lock(&tdpMutex);
+    for (i = 0; i < TDP_HOST_MAX_FILTERS; i++)
+    {
+        if (filters[i].used && filters[i].pid == pid && filters[i].tableId == section[0])
+            break;
+    }
+    callback = sectionCallback;
+    pthread_mutex_unlock(&tdpMutex);
+    if (i == TDP_HOST_MAX_FILTERS || callback == NULL)
+        return 0;
+    // the driver hands out a full section buffer, bytes past the section are zero
+    memcpy(sectionBuffer, section, length);
+    memset(sectionBuffer + length, 0, SECTION_MAX_SIZE - length);
+    sectionCount++;
+    callback(sectionBuffer);
+    return 0;
+}
+
+static void* tdpHostTunerThread(void* arg)
+{
+    const uint32_t chunk = TDP_HOST_CHUNK_PACKETS * TS_PACKET_SIZE;
+    uint64_t deadline;
+    size_t offset = 0;
+    uint32_t size;
+    Tuner_Status_Callback callback;
+
+    clockThreadDriven(1);
+    clockTakeOver();
+    tdpHostSleepUntil(tdpHostNow() + config.lockDelayMs * CLOCK_NS_PER_MS, &tunerStop);
+    pthread_mutex_lock(&tdpMutex);
+    callback = tunerCallback;
+    pthread_mutex_unlock(&tdpMutex);
+    if (callback != NULL && !tunerStop)
+        callback(STATUS_LOCKED);
+
+    deadline = tdpHostNow();
+    while (!tunerStop && tsData != NULL)
+    {
+        tdpHostSyncPids();
+        size = (tsSize - offset > chunk) ? chunk : (uint32_t) (tsSize - offset);
+        offset += sectionAssemblerPush(assembler, tsData + offset, size);
+        // the capture is played in a loop, like a live multiplex
+        if (tsSize - offset < TS_PACKET_SIZE)
+            offset = 0;
+        if (config.bitrate > 0)
+        {
+            deadline += (uint64_t) size * 8u * CLOCK_NS_PER_SEC / config.bitrate;
+            tdpHostSleepUntil(deadline, &tunerStop);
+        }
+    }
+    clockThreadDriven(0);
+    return NULL;
+}
+
+void tdpHostConfigure(const TdpHostConfig* hostConfig)
+{
+    if (logOwned)
+        fclose(config.log);
+    logOwned = 0;
+    config = *hostConfig;
+    if (config.filterCount == 0 || config.filterCount > TDP_HOST_MAX_FILTERS)
+        config.filterCount = TDP_HOST_MAX_FILTERS;
+    configured = 1;
+}
+
+uint32_t tdpHostCallCount(void)
+{
+    uint32_t count;
+    pthread_mutex_lock(&tdpMutex);
+    count = callCount;
+    pthread_mutex_unlock(&tdpMutex);
+    return count;
+}
+
+int32_t tdpHostGetCall(uint32_t index, TdpHostCall* call)
+{
+    int32_t result = -1;
+    pthread_mutex_lock(&tdpMutex);
+    if (index < callCount)
+    {
+        *call = calls[index];
+        result = 0;
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return result;
+}
+
+void tdpHostDumpCalls(FILE* out)
+{
+    uint32_t i;
+    pthread_mutex_lock(&tdpMutex);
+    for (i = 0; i < callCount; i++)
+    {
+        fprintf(out, "%12.3f ms %-42s %6u %6u %6u -> %d (%.3f ms)\n", calls[i].timestamp / 1e6, calls[i].function,
+                calls[i].args[0], calls[i].args[1], calls[i].args[2], calls[i].result, calls[i].duration / 1e6);
+    }
+    pthread_mutex_unlock(&tdpMutex);
+}
+
+uint64_t tdpHostSectionCount(void)
+{
+    return sectionCount;
+}
+
+int32_t Tuner_Init()
+{
+    uint64_t start = tdpHostNow();
+    int32_t result = NO_ERROR;
+    tdpHostLoadDefaults();
+    pthread_mutex_lock(&tdpMutex);
+    startTime = start;
+    callCount = 0;
+    memset(filters, 0, sizeof (filters));
+    filtersChanged = 1;
+    assembledCount = 0;
+    pthread_mutex_unlock(&tdpMutex);
+    if (assembler == NULL)
+        assembler = sectionAssemblerCreate(tdpHostSection, NULL);
+    if (assembler == NULL)
+        result = ERROR;
+    return tdpHostRecord(__FUNCTION__, start, 0, 0, 0, result);
+}
+
+int32_t Tuner_Deinit()
+{
+    uint64_t start = tdpHostNow();
+    if (tunerRunning)
+    {
+        pthread_mutex_lock(&tdpMutex);
+        tunerStop = 1;
+        pthread_cond_broadcast(&tdpCondition);
+        pthread_mutex_unlock(&tdpMutex);
+        pthread_join(tunerThread, NULL);
+        tunerRunning = 0;
+    }
+    if (tsData != NULL)
+    {
+        munmap((void*) tsData, tsSize);
+        tsData = NULL;
+    }
+    sectionAssemblerDestroy(assembler);
+    assembler = NULL;
+    tdpHostRecord(__FUNCTION__, start, 0, 0, 0, NO_ERROR);
+    pthread_mutex_lock(&tdpMutex);
+    if (logOwned)
+    {
+        // the next Tuner_Init reads the environment and reopens the log
+        fclose(config.log);
+        config.log = NULL;
+        logOwned = 0;
+        configured = 0;
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return NO_ERROR;
+}
+
+int32_t Tuner_Lock_To_Frequency(uint32_t tuneFrequency, uint32_t bandwidth, t_Module module)
+{
+    uint64_t start = tdpHostNow();
+    struct stat st;
+    int fd;
+    if (assembler == NULL || tunerRunning)
+        return tdpHostRecord(__FUNCTION__, start, tuneFrequency, bandwidth, module, ERROR);
+    if (config.tsPath != NULL)
+    {
+        fd = open(config.tsPath, O_RDONLY);
+        if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < TS_PACKET_SIZE)
+        {
+            printf("%s: ERROR cannot open %s\n", __FUNCTION__, config.tsPath);
+            if (fd >= 0)
+                close(fd);
+            return tdpHostRecord(__FUNCTION__, start, tuneFrequency, bandwidth, module, ERROR);
+        }
+        tsSize = (size_t) st.st_size - (size_t) st.st_size % TS_PACKET_SIZE;
+        tsData = (const uint8_t*) mmap(NULL, tsSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (tsData == MAP_FAILED)
+        {
+            tsData = NULL;
+            return tdpHostRecord(__FUNCTION__, start, tuneFrequency, bandwidth, module, ERROR);
+        }
+    }
+    tunerStop = 0;
+    // the clock does not move on before the tuner thread waits for the lock delay
+    clockHandOff();
+    if (pthread_create(&tunerThread, NULL, tdpHostTunerThread, NULL) != 0)
+    {
+        clockTakeOver();
+        clockThreadIdle();
+        return tdpHostRecord(__FUNCTION__, start, tuneFrequency, bandwidth, module, ERROR);
+    }
+    tunerRunning = 1;
+    return tdpHostRecord(__FUNCTION__, start, tuneFrequency, bandwidth, module, NO_ERROR);
+}
+
+int32_t Tuner_Register_Status_Callback(Tuner_Status_Callback tunerStatusCallback)
+{
+    uint64_t start = tdpHostNow();
+    pthread_mutex_lock(&tdpMutex);
+    tunerCallback = tunerStatusCallback;
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, 0, 0, 0, NO_ERROR);
+}
+
+int32_t Tuner_Unregister_Status_Callback(Tuner_Status_Callback tunerStatusCallback)
+{
+    uint64_t start = tdpHostNow();
+    int32_t result = ERROR;
+    pthread_mutex_lock(&tdpMutex);
+    if (tunerCallback == tunerStatusCallback)
+    {
+        tunerCallback = NULL;
+        result = NO_ERROR;
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, 0, 0, 0, result);
+}
+
+int32_t Player_Init(uint32_t *playerHandle)
+{
+    uint64_t start = tdpHostNow();
+    *playerHandle = 1;
+    return tdpHostRecord(__FUNCTION__, start, *playerHandle, 0, 0, NO_ERROR);
+}
+
+int32_t Player_Deinit(uint32_t playerHandle)
+{
+    uint64_t start = tdpHostNow();
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, 0, 0, NO_ERROR);
+}
+
+int32_t Player_Source_Open(uint32_t playerHandle, uint32_t *sourceHandle)
+{
+    uint64_t start = tdpHostNow();
+    *sourceHandle = 1;
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, *sourceHandle, 0, NO_ERROR);
+}
+
+int32_t Player_Source_Close(uint32_t playerHandle, uint32_t sourceHandle)
+{
+    uint64_t start = tdpHostNow();
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, sourceHandle, 0, NO_ERROR);
+}
+
+int32_t Player_Stream_Create(uint32_t playerHandle, uint32_t sourceHandle, uint32_t PID, tStreamType streamType, uint32_t *streamHandle)
+{
+    uint64_t start = tdpHostNow();
+    if (PID >= TS_NUM_OF_PIDS)
+        return tdpHostRecord(__FUNCTION__, start, PID, streamType, 0, ERROR);
+    // decoder setup on the board takes tens of milliseconds
+    tdpHostSleepUntil(start + config.streamCreateMs * CLOCK_NS_PER_MS, NULL);
+    pthread_mutex_lock(&tdpMutex);
+    *streamHandle = ++nextStreamHandle;
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, PID, streamType, *streamHandle, NO_ERROR);
+}
+
+int32_t Player_Stream_Remove(uint32_t playerHandle, uint32_t sourceHandle, uint32_t streamHandle)
+{
+    uint64_t start = tdpHostNow();
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, sourceHandle, streamHandle, NO_ERROR);
+}
+
+int32_t Player_Volume_Set(uint32_t playerHandle, uint32_t volume)
+{
+    uint64_t start = tdpHostNow();
+    playerVolume = volume;
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, volume, 0, NO_ERROR);
+}
+
+int32_t Player_Volume_Get(uint32_t playerHandle, uint32_t *volume)
+{
+    uint64_t start = tdpHostNow();
+    *volume = playerVolume;
+    return tdpHostRecord(__FUNCTION__, start, playerHandle, *volume, 0, NO_ERROR);
+}
+
+int32_t Demux_Set_Filter(uint32_t playerHandle, uint32_t PID, uint32_t tableID, uint32_t *filterHandle)
+{
+    uint64_t start = tdpHostNow();
+    int32_t result = ERROR;
+    uint32_t i;
+    if (PID >= TS_NUM_OF_PIDS || tableID > 0xFF)
+        return tdpHostRecord(__FUNCTION__, start, PID, tableID, 0, ERROR);
+    pthread_mutex_lock(&tdpMutex);
+    for (i = 0; i < config.filterCount; i++)
+    {
+        if (!filters[i].used)
+        {
+            filters[i].used = 1;
+            filters[i].pid = (uint16_t) PID;
+            filters[i].tableId = (uint8_t) tableID;
+            filtersChanged = 1;
+            *filterHandle = i;
+            result = NO_ERROR;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, PID, tableID, (result == NO_ERROR) ? *filterHandle : 0, result);
+}
+
+int32_t Demux_Free_Filter(uint32_t playerHandle, uint32_t filterHandle)
+{
+    uint64_t start = tdpHostNow();
+    int32_t result = ERROR;
+    pthread_mutex_lock(&tdpMutex);
+    if (filterHandle < TDP_HOST_MAX_FILTERS && filters[filterHandle].used)
+    {
+        filters[filterHandle].used = 0;
+        filtersChanged = 1;
+        result = NO_ERROR;
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, filterHandle, 0, 0, result);
+}
+
+int32_t Demux_Register_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback)
+{
+    uint64_t start = tdpHostNow();
+    pthread_mutex_lock(&tdpMutex);
+    sectionCallback = demuxSectionFilterCallback;
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, 0, 0, 0, NO_ERROR);
+}
+
+int32_t Demux_Unregister_Section_Filter_Callback(Demux_Section_Filter_Callback demuxSectionFilterCallback)
+{
+    uint64_t start = tdpHostNow();
+    int32_t result = ERROR;
+    pthread_mutex_lock(&tdpMutex);
+    if (sectionCallback == demuxSectionFilterCallback)
+    {
+        sectionCallback = NULL;
+        result = NO_ERROR;
+    }
+    pthread_mutex_unlock(&tdpMutex);
+    return tdpHostRecord(__FUNCTION__, start, 0, 0, 0, result);
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file tdp_host.h
+ * \brief
+ * Podesavanje i dnevnik poziva zamjene za tdp_api na racunaru. Tjuner se
+ * "zakljucava" nakon zadatog kasnjenja, a zatim se transportni tok iz fajla
+ * reprodukuje zadatim protokom (u krug) kroz filtere sekcija. Svaki poziv
+ * tdp_api funkcije se biljezi sa vremenom, argumentima i rezultatom.
+ *
+ * Ako tdpHostConfigure nije pozvana, podesavanja se citaju iz okruzenja:
+ * TDP_HOST_TS, TDP_HOST_LOCK_MS, TDP_HOST_STREAM_MS, TDP_HOST_BITRATE,
+ * TDP_HOST_FILTERS i TDP_HOST_LOG (fajl u koji se upisuje svaki poziv).
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef TDP_HOST_H
+#define TDP_HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TDP_HOST_MAX_FILTERS 32
+#define TDP_HOST_MAX_CALLS 65536
+/* broj paketa koji se predaje filterima odjednom (kao DMA blok demultipleksera) */
+#define TDP_HOST_CHUNK_PACKETS 64
+
+typedef struct _TdpHostConfig
+{
+    const char* tsPath; // fajl sa transportnim tokom
+    uint32_t lockDelayMs; // vrijeme od Tuner_Lock_To_Frequency do STATUS_LOCKED
+    uint32_t streamCreateMs; // trajanje Player_Stream_Create
+    uint32_t bitrate; // protok reprodukcije u bit/s, 0 za najvecu brzinu
+    uint32_t filterCount; // broj filtera sekcija (najvise TDP_HOST_MAX_FILTERS)
+    FILE* log; // NULL ako se pozivi ne upisuju u fajl
+} TdpHostConfig;
+
+typedef struct _TdpHostCall
+{
+    uint64_t timestamp; // ns od Tuner_Init
+    uint64_t duration; // ns
+    const char* function;
+    uint32_t args[3];
+    int32_t result;
+} TdpHostCall;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja postavlja podesavanja simulacije. Poziva se prije Tuner_Init.
+ *
+ * @param config - [in] podesavanja
+ *****************************************************************************/
+void tdpHostConfigure(const TdpHostConfig* config);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca broj zabiljezenih poziva.
+ *
+ * @return broj poziva (najvise TDP_HOST_MAX_CALLS)
+ *****************************************************************************/
+uint32_t tdpHostCallCount(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja cita jedan zabiljezeni poziv.
+ *
+ * @param index - [in] redni broj poziva
+ * @param call - [out] poziv
+ * @return 0 ako poziv postoji, -1 u suprotnom
+ *****************************************************************************/
+int32_t tdpHostGetCall(uint32_t index, TdpHostCall* call);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ispisuje sve zabiljezene pozive.
+ *
+ * @param out - [in] izlazni fajl
+ *****************************************************************************/
+void tdpHostDumpCalls(FILE* out);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca broj sekcija predatih callback funkciji demultipleksera.
+ *
+ * @return broj sekcija
+ *****************************************************************************/
+uint64_t tdpHostSectionCount(void);
+
+#endif
@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_writer.c
+ * \brief
+ * Tabele se pakuju u pakete sa pointer_field-om na pocetku sekcije, a ostatak
+ * paketa se popunjava sa 0xFF. Svaka tabela zauzima jedan paket.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "ts_writer.h"
+#include "section_assembler.h"
+#include "crc32.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TS_WRITER_PAT_PID 0x0000
+#define TS_WRITER_PAT_TABLE_ID 0x00
+#define TS_WRITER_PMT_TABLE_ID 0x02
+/* najveca sekcija koja staje u jedan paket uz zaglavlje i pointer_field */
+#define TS_WRITER_MAX_SECTION (TS_PACKET_SIZE - 5)
+
+static uint8_t continuityCounter[TS_NUM_OF_PIDS];
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zavrsava sekciju: upisuje section_length i CRC.
+ *
+ * @param section - [in/out] sekcija bez CRC-a
+ * @param length - [in] duzina sekcije bez CRC-a
+ * @return ukupna duzina sekcije
+ *****************************************************************************/
+static uint32_t tsWriterFinishSection(uint8_t* section, uint32_t length)
+{
+    uint32_t crc;
+    uint32_t sectionLength = length + 4 - 3;
+    section[1] = 0xB0 | ((sectionLength >> 8) & 0x0F);
+    section[2] = sectionLength & 0xFF;
+    crc = crc32Mpeg2(section, length);
+    section[length] = (crc >> 24) & 0xFF;
+    section[length + 1] = (crc >> 16) & 0xFF;
+    section[length + 2] = (crc >> 8) & 0xFF;
+    section[length + 3] = crc & 0xFF;
+    return length + 4;
+}
+
+static uint32_t tsWriterPat(uint8_t* section, const TsWriterService* services, uint32_t count, uint16_t transportStreamId)
+{
+    uint32_t length = 8;
+    uint32_t i;
+    section[0] = TS_WRITER_PAT_TABLE_ID;
+    section[3] = transportStreamId >> 8;
+    section[4] = transportStreamId & 0xFF;
+    section[5] = 0xC1; // version 0, current
+    section[6] = 0;
+    section[7] = 0;
+    for (i = 0; i < count; i++)
+    {
+        section[length++] = services[i].program_number >> 8;
+        section[length++] = services[i].program_number & 0xFF;
+        section[length++] = 0xE0 | (services[i].pmtPid >> 8);
+        section[length++] = services[i].pmtPid & 0xFF;
+    }
+    return tsWriterFinishSection(section, length);
+}
+
+static uint32_t tsWriterStream(uint8_t* entry, uint8_t streamType, uint16_t pid)
+{
+    entry[0] = streamType;
+    entry[1] = 0xE0 | (pid >> 8);
+    entry[2] = pid & 0xFF;
+    entry[3] = 0xF0; // no ES descriptors
+    entry[4] = 0;
+    return 5;
+}
+
+static uint32_t tsWriterPmt(uint8_t* section, const TsWriterService* service)
+{
+    uint32_t length = 12;
+    uint16_t pcrPid = (service->videoPid != 0) ? service->videoPid : service->audioPid;
+    section[0] = TS_WRITER_PMT_TABLE_ID;
+    section[3] = service->program_number >> 8;
+    section[4] = service->program_number & 0xFF;
+    section[5] = 0xC1;
+    section[6] = 0;
+    section[7] = 0;
+    section[8] = 0xE0 | (pcrPid >> 8);
+    section[9] = pcrPid & 0xFF;
+    section[10] = 0xF0; // no program descriptors
+    section[11] = 0;
+    if (service->videoPid != 0)
+        length += tsWriterStream(section + length, service->videoStreamType, service->videoPid);
+    if (service->audioPid != 0)
+        length += tsWriterStream(section + length, service->audioStreamType, service->audioPid);
+    return tsWriterFinishSection(section, length);
+}
+
+static int32_t tsWriterPacket(FILE* file, uint16_t pid, const uint8_t* section, uint32_t length)
+{
+    uint8_t packet[TS_PACKET_SIZE];
+    memset(packet, 0xFF, TS_PACKET_SIZE);
+    packet[0] = TS_SYNC_BYTE;
+    packet[1] = ((section != NULL) ? 0x40 : 0x00) | (pid >> 8); // payload_unit_start_indicator
+    packet[2] = pid & 0xFF;
+    packet[3] = 0x10 | continuityCounter[pid]; // payload only
+    continuityCounter[pid] = (continuityCounter[pid] + 1) & 0x0F;
+    if (section != NULL)
+    {
+        packet[4] = 0; // pointer_field
+        memcpy(packet + 5, section, length);
+    }
+    return (fwrite(packet, TS_PACKET_SIZE, 1, file) == 1) ? 0 : -1;
+}
+
+int32_t tsWriterWriteMultiplex(const char* path, const TsWriterService* services, uint32_t count,
+                               uint16_t transportStreamId, uint32_t cyclePackets)
+{
+    uint8_t section[TS_WRITER_MAX_SECTION + 4];
+    uint32_t packets = 0;
+    uint32_t length;
+    uint32_t i;
+    int32_t result = 0;
+    FILE* file;
+    if ((8 + 4 * count + 4) > TS_WRITER_MAX_SECTION)
+    {
+        printf("%s: ERROR %u services do not fit in one PAT packet\n", __FUNCTION__, count);
+        return -1;
+    }
+    file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("%s: ERROR cannot open %s\n", __FUNCTION__, path);
+        return -1;
+    }
+    memset(continuityCounter, 0, sizeof (continuityCounter));
+    length = tsWriterPat(section, services, count, transportStreamId);
+    result |= tsWriterPacket(file, TS_WRITER_PAT_PID, section, length);
+    packets++;
+    for (i = 0; i < count; i++)
+    {
+        if (services[i].omitPmt)
+            continue;
+        length = tsWriterPmt(section, &services[i]);
+        result |= tsWriterPacket(file, services[i].pmtPid, section, length);
+        packets++;
+    }
+    for (; packets < cyclePackets; packets++)
+        result |= tsWriterPacket(file, TS_NULL_PID, NULL, 0);
+    if (fclose(file) != 0)
+        result = -1;
+    if (result != 0)
+        printf("%s: ERROR cannot write %s\n", __FUNCTION__, path);
+    return result;
+}
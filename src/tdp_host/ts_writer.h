@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_writer.h
+ * \brief
+ * Ovaj modul pravi mali transportni tok za tdp_host: jedan ciklus sa PAT
+ * tabelom, PMT tabelama zadatih programa i null paketima. tdp_host
+ * reprodukuje fajl u petlji, pa ciklus odredjuje period ponavljanja tabela.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef TS_WRITER_H
+#define TS_WRITER_H
+
+#include <stdint.h>
+
+typedef struct _TsWriterService
+{
+    uint16_t program_number;
+    uint16_t pmtPid;
+    uint16_t videoPid; // 0 ako program nema video
+    uint8_t videoStreamType;
+    uint16_t audioPid; // 0 ako program nema audio
+    uint8_t audioStreamType;
+    uint8_t omitPmt; // PMT se ne emituje (program iz PAT bez PMT tabele)
+} TsWriterService;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje jedan ciklus multipleksa u fajl.
+ *
+ * @param path - [in] putanja do fajla
+ * @param services - [in] programi
+ * @param count - [in] broj programa
+ * @param transportStreamId - [in] transport_stream_id iz PAT tabele
+ * @param cyclePackets - [in] broj paketa u ciklusu, ostatak su null paketi
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t tsWriterWriteMultiplex(const char* path, const TsWriterService* services, uint32_t count,
+                               uint16_t transportStreamId, uint32_t cyclePackets);
+
+#endif
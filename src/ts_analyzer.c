@@ -0,0 +1,336 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_analyzer.c
+ * \brief
+ * Program za analizu snimljenog transportnog toka na racunaru, bez tjunera i
+ * demultipleksera. Fajl se mapira u memoriju, sekcije se sastavljaju modulom
+ * section_assembler i parsiraju istim kodom kao na uredjaju (table_parser,
+ * now_next, epg_index, service_cache, network_map). Na kraju se ispisuju PAT,
+ * PMT, SDT i EIT podaci, kao i propusnost (paketa/s i MB/s).
+ *
+ * Upotreba: ts_analyzer [-q] fajl.ts
+ *      -q  ispisuje samo statistiku i propusnost
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "section_assembler.h"
+#include "section_view.h"
+#include "psi_cache.h"
+#include "table_parser.h"
+#include "now_next.h"
+#include "epg_index.h"
+#include "service_cache.h"
+#include "network_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NIT_PID 0x10
+#define SDT_PID 0x11
+#define EIT_PID 0x12
+/* najveci dio fajla koji se odjednom predaje sastavljacu */
+#define ANALYZER_CHUNK_SIZE (TS_PACKET_SIZE * 1024u * 1024u)
+
+typedef struct _Analyzer
+{
+    SectionAssembler* assembler;
+    PsiCache cache;
+    PatHeader patHeader;
+    PatTable patTable;
+    uint8_t hasPat;
+    PmtHeader pmtHeaders[MAX_NUM_OF_PIDS];
+    PmtTable pmtTables[MAX_NUM_OF_PIDS]; // indeksirano kao patServiceInfoArray
+    uint8_t hasPmt[MAX_NUM_OF_PIDS];
+    int8_t pmtIndex[TS_NUM_OF_PIDS]; // PID -> indeks programa u PAT, -1 ako nije PMT PID
+    SdtTable sdtTable;
+    NitTable nitTable;
+    EitTable eitTable;
+    uint64_t sectionsParsed;
+    uint64_t sectionsRepeated;
+    uint64_t sectionsNext; // current_next_indicator = 0
+    uint32_t sectionsInvalid;
+} Analyzer;
+
+static const char* streamClassNames[] = {"unknown", "video", "audio", "teletext", "subtitles", "data"};
+static const char* streamCodecNames[] = {"", "MPEG-1", "MPEG-2", "H.264", "HEVC", "MPEG-1", "MPEG-2", "AC-3",
+                                         "E-AC-3", "AAC"};
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja nakon nove PAT sekcije ukljucuje sastavljanje sekcija na
+ * PMT PID-ovima programa.
+ *
+ *****************************************************************************/
+static void analyzerUpdatePmtPids(Analyzer* analyzer)
+{
+    uint32_t i;
+    uint16_t pid;
+    for (i = 0; i < TS_NUM_OF_PIDS; i++)
+    {
+        if (analyzer->pmtIndex[i] >= 0 && i > EIT_PID)
+            sectionAssemblerRemovePid(analyzer->assembler, (uint16_t) i);
+        analyzer->pmtIndex[i] = -1;
+    }
+    memset(analyzer->hasPmt, 0, sizeof (analyzer->hasPmt));
+    for (i = 0; i < analyzer->patTable.serviceInfoCount; i++)
+    {
+        pid = analyzer->patTable.patServiceInfoArray[i].pid;
+        if (analyzer->patTable.patServiceInfoArray[i].program_number == 0 || pid >= TS_NUM_OF_PIDS)
+            continue;
+        analyzer->pmtIndex[pid] = (int8_t) i;
+        psiCacheInvalidatePid(&(analyzer->cache), pid);
+        sectionAssemblerAddPid(analyzer->assembler, pid);
+    }
+}
+
+static int32_t analyzerSectionCallback(uint16_t pid, const uint8_t* section, uint16_t length, void* userData)
+{
+    Analyzer* analyzer = (Analyzer*) userData;
+    SectionView view;
+    int32_t index;
+    PsiCacheResult cached;
+
+    // carousels repeat every table many times a second, skip unchanged copies before the CRC
+    cached = psiCacheCheck(&(analyzer->cache), pid, section, length);
+    if (cached == PSI_CACHE_UNCHANGED)
+    {
+        analyzer->sectionsRepeated++;
+        return 0;
+    }
+    if (cached == PSI_CACHE_NEXT)
+    {
+        analyzer->sectionsNext++;
+        return 0;
+    }
+    if (sectionViewInit(&view, section, length) != SECTION_OK)
+    {
+        analyzer->sectionsInvalid++;
+        return -1;
+    }
+    psiCacheUpdate(&(analyzer->cache), pid, &view);
+    analyzer->sectionsParsed++;
+
+    if (pid == 0 && view.table_id == PAT_TABLE_ID)
+    {
+        if (parsePatSection(&view, &(analyzer->patTable)) == 0)
+        {
+            analyzer->hasPat = 1;
+            analyzerUpdatePmtPids(analyzer);
+        }
+    }
+    else if (view.table_id == PMT_TABLE_ID)
+    {
+        index = analyzer->pmtIndex[pid];
+        if (index >= 0 && parsePmtSection(&view, &(analyzer->pmtTables[index])) == 0)
+            analyzer->hasPmt[index] = 1;
+    }
+    else if (view.table_id == NIT_ACTUAL_TABLE_ID)
+    {
+        if (parseNitSection(&view, &(analyzer->nitTable)) == 0)
+            networkMapUpdate(&(analyzer->nitTable));
+    }
+    else if (view.table_id == SDT_ACTUAL_TABLE_ID)
+    {
+        if (parseSdtSection(&view, &(analyzer->sdtTable)) == 0)
+            serviceCacheUpdate(&(analyzer->sdtTable));
+    }
+    else if (view.table_id == EIT_PF_ACTUAL_TABLE_ID)
+    {
+        if (parseEitSection(&view, &(analyzer->eitTable)) == 0)
+            nowNextUpdate(&(analyzer->eitTable));
+    }
+    else if (view.table_id >= EIT_SCHEDULE_FIRST_TABLE_ID && view.table_id <= EIT_SCHEDULE_LAST_TABLE_ID)
+    {
+        epgIndexAddSection(&view);
+    }
+    return 0;
+}
+
+static void analyzerPrintEvent(const char* label, const NowNextEvent* event)
+{
+    char start[32];
+    time_t t;
+    struct tm tm;
+    if (!event->valid)
+        return;
+    t = (time_t) event->start_time;
+    gmtime_r(&t, &tm);
+    strftime(start, sizeof (start), "%Y-%m-%d %H:%M", &tm);
+    printf("    %s: %s UTC (%u min) %s\n", label, start, event->duration / 60, event->name);
+}
+
+static void analyzerReport(Analyzer* analyzer)
+{
+    const PmtTable* pmt;
+    const PmtServiceInfo* stream;
+    ServiceInfo service;
+    NowNextEvent present;
+    NowNextEvent following;
+    NetworkChannel channel;
+    uint16_t program_number;
+    uint32_t i;
+    uint32_t j;
+
+    if (!analyzer->hasPat)
+    {
+        printf("no PAT found\n");
+        return;
+    }
+    printf("PAT: transport_stream_id %u, version %u, %u programs\n", analyzer->patHeader.transport_stream_id,
+           analyzer->patHeader.version_number, analyzer->patTable.serviceInfoCount);
+    for (i = 0; i < analyzer->patTable.serviceInfoCount; i++)
+    {
+        program_number = analyzer->patTable.patServiceInfoArray[i].program_number;
+        if (program_number == 0)
+        {
+            printf("  NIT PID 0x%04x\n", analyzer->patTable.patServiceInfoArray[i].pid);
+            continue;
+        }
+        printf("  program %u, PMT PID 0x%04x", program_number, analyzer->patTable.patServiceInfoArray[i].pid);
+        if (serviceCacheGet(program_number, &service) == 0)
+            printf(", \"%s\" (%s, type 0x%02x%s)", service.name, service.provider, service.service_type,
+                   service.free_CA_mode ? ", scrambled" : "");
+        printf("\n");
+        if (!analyzer->hasPmt[i])
+        {
+            printf("    no PMT\n");
+        }
+        else
+        {
+            pmt = &(analyzer->pmtTables[i]);
+            printf("    PCR PID 0x%04x, PMT version %u\n", pmt->pmtHeader->pcr_pid, pmt->pmtHeader->version_number);
+            for (j = 0; j < pmt->streamCount; j++)
+            {
+                stream = &(pmt->pmtServiceInfoArray[j]);
+                printf("    stream_type 0x%02x PID 0x%04x %s %s %s\n", stream->stream_type, stream->el_pid,
+                       streamClassNames[stream->stream_class], streamCodecNames[stream->codec], stream->language);
+            }
+        }
+        if (nowNextGet(program_number, &present, &following) == 0)
+        {
+            analyzerPrintEvent("now", &present);
+            analyzerPrintEvent("next", &following);
+        }
+    }
+    for (i = 1; i < NETWORK_MAP_MAX_LCN; i++)
+    {
+        if (networkMapLookupLcn((uint16_t) i, &channel) == 0)
+            printf("LCN %4u: service %u, type 0x%02x, %u Hz%s\n", i, channel.service_id, channel.service_type,
+                   channel.multiplex.frequency, channel.visible_service_flag ? "" : " (hidden)");
+    }
+    printf("EIT schedule: %u events\n", epgIndexEventCount());
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    static Analyzer analyzer;
+    const SectionAssemblerStats* stats;
+    const char* path = NULL;
+    const uint8_t* data;
+    struct stat st;
+    struct timespec start;
+    struct timespec end;
+    uint64_t offset = 0;
+    uint32_t pushed;
+    uint32_t chunk;
+    uint8_t quiet = 0;
+    double seconds;
+    int32_t fd;
+    int32_t i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-q") == 0)
+            quiet = 1;
+        else
+            path = argv[i];
+    }
+    if (path == NULL)
+    {
+        printf("usage: %s [-q] file.ts\n", argv[0]);
+        return 1;
+    }
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < TS_PACKET_SIZE)
+    {
+        printf("%s: ERROR cannot open %s\n", __FUNCTION__, path);
+        return 1;
+    }
+    data = (const uint8_t*) mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        printf("%s: ERROR cannot map %s\n", __FUNCTION__, path);
+        close(fd);
+        return 1;
+    }
+    madvise((void*) data, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+    analyzer.patTable.patHeader = &(analyzer.patHeader);
+    for (i = 0; i < MAX_NUM_OF_PIDS; i++)
+    {
+        analyzer.pmtTables[i].pmtHeader = &(analyzer.pmtHeaders[i]);
+    }
+    memset(analyzer.pmtIndex, -1, sizeof (analyzer.pmtIndex));
+    psiCacheReset(&(analyzer.cache));
+    nowNextReset();
+    epgIndexReset();
+    serviceCacheReset();
+    networkMapReset();
+    analyzer.assembler = sectionAssemblerCreate(analyzerSectionCallback, &analyzer);
+    if (analyzer.assembler == NULL)
+        return 1;
+    sectionAssemblerAddPid(analyzer.assembler, 0);
+    sectionAssemblerAddPid(analyzer.assembler, NIT_PID);
+    sectionAssemblerAddPid(analyzer.assembler, SDT_PID);
+    sectionAssemblerAddPid(analyzer.assembler, EIT_PID);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while ((uint64_t) st.st_size - offset >= TS_PACKET_SIZE)
+    {
+        chunk = ((uint64_t) st.st_size - offset > ANALYZER_CHUNK_SIZE) ? ANALYZER_CHUNK_SIZE :
+                (uint32_t) ((uint64_t) st.st_size - offset);
+        pushed = sectionAssemblerPush(analyzer.assembler, data + offset, chunk);
+        if (pushed == 0)
+            break;
+        offset += pushed;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (!quiet)
+        analyzerReport(&analyzer);
+    stats = sectionAssemblerGetStats(analyzer.assembler);
+    printf("packets %llu, sections %llu (parsed %llu, repeated %llu, next %llu, invalid %u)\n",
+           (unsigned long long) stats->packets, (unsigned long long) stats->sections,
+           (unsigned long long) analyzer.sectionsParsed, (unsigned long long) analyzer.sectionsRepeated,
+           (unsigned long long) analyzer.sectionsNext, analyzer.sectionsInvalid);
+    printf("errors: sync %u, transport %u, continuity %u, section %u\n", stats->syncErrors,
+           stats->transportErrors, stats->continuityErrors, stats->sectionErrors);
+    if (seconds > 0)
+        printf("%.3f s, %.0f packets/s, %.1f MB/s\n", seconds, (double) stats->packets / seconds,
+               (double) offset / seconds / (1024.0 * 1024.0));
+
+    sectionAssemblerDestroy(analyzer.assembler);
+    epgIndexReset();
+    munmap((void*) data, (size_t) st.st_size);
+    close(fd);
+    return 0;
+}
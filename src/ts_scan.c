@@ -0,0 +1,307 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_scan.c
+ * \brief
+ * Ovaj modul realizuje brzi prolaz kroz niz transportnih paketa. Kernel cita
+ * prva cetiri bajta svakog paketa u bloku kao 32-bitnu rijec (sync bajt i
+ * PID su u bajtovima 0..2), a zatim sync i PID obradjuje vektorski.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "ts_scan.h"
+#include "section_assembler.h"
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TS_SCAN_HAVE_X86 1
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define TS_SCAN_HAVE_NEON 1
+#endif
+
+#define TS_SCAN_BLOCK_SIZE (TS_SCAN_BLOCK_PACKETS * TS_PACKET_SIZE)
+
+/* vraca masku paketa bloka bez sync bajta (bit i za paket i), 0 ako je blok ispravan */
+typedef uint32_t(*TsScanBlockFunction)(const uint8_t* data, uint16_t* pids);
+
+static pthread_once_t scanOnce = PTHREAD_ONCE_INIT;
+static TsScanBlockFunction scanBlock = NULL;
+static TsScanImplementation scanImplementation = TS_SCAN_IMPL_SCALAR;
+static uint8_t avx2Supported = 0;
+
+static inline uint32_t tsScanLoad32(const uint8_t* data)
+{
+    uint32_t word;
+    memcpy(&word, data, sizeof (word));
+    return word;
+}
+
+static uint32_t tsScanBlockScalar(const uint8_t* data, uint16_t* pids)
+{
+    uint32_t mask = 0;
+    uint32_t i;
+    for (i = 0; i < TS_SCAN_BLOCK_PACKETS; i++)
+    {
+        mask |= (uint32_t) (data[0] != TS_SYNC_BYTE) << i;
+        pids[i] = (uint16_t) (((data[1] << 8) | data[2]) & 0x1FFF);
+        data += TS_PACKET_SIZE;
+    }
+    return mask;
+}
+
+#ifdef TS_SCAN_HAVE_X86
+
+__attribute__((target("sse2")))
+static inline __m128i tsScanPidSse2(__m128i words)
+{
+    // little endian word: byte 0 sync, byte 1 flags and PID high bits, byte 2 PID low bits
+    __m128i high = _mm_and_si128(_mm_srli_epi32(words, 8), _mm_set1_epi32(0x1F));
+    __m128i low = _mm_and_si128(_mm_srli_epi32(words, 16), _mm_set1_epi32(0xFF));
+    return _mm_or_si128(_mm_slli_epi32(high, 8), low);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i tsScanLoad4Sse2(const uint8_t* data)
+{
+    __m128i a = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int32_t) tsScanLoad32(data)),
+                                   _mm_cvtsi32_si128((int32_t) tsScanLoad32(data + TS_PACKET_SIZE)));
+    __m128i b = _mm_unpacklo_epi32(_mm_cvtsi32_si128((int32_t) tsScanLoad32(data + 2 * TS_PACKET_SIZE)),
+                                   _mm_cvtsi32_si128((int32_t) tsScanLoad32(data + 3 * TS_PACKET_SIZE)));
+    return _mm_unpacklo_epi64(a, b);
+}
+
+__attribute__((target("sse2")))
+static uint32_t tsScanBlockSse2(const uint8_t* data, uint16_t* pids)
+{
+    const __m128i sync = _mm_set1_epi32(TS_SYNC_BYTE);
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    __m128i words[4];
+    __m128i equal;
+    uint32_t mask = 0;
+    uint32_t g;
+    for (g = 0; g < 4; g++)
+    {
+        words[g] = tsScanLoad4Sse2(data + g * 4 * TS_PACKET_SIZE);
+        equal = _mm_cmpeq_epi32(_mm_and_si128(words[g], byteMask), sync);
+        mask |= (uint32_t) (~_mm_movemask_ps(_mm_castsi128_ps(equal)) & 0x0F) << (g * 4);
+    }
+    _mm_storeu_si128((__m128i*) pids, _mm_packs_epi32(tsScanPidSse2(words[0]), tsScanPidSse2(words[1])));
+    _mm_storeu_si128((__m128i*) (pids + 8), _mm_packs_epi32(tsScanPidSse2(words[2]), tsScanPidSse2(words[3])));
+    return mask;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i tsScanPidAvx2(__m256i words)
+{
+    __m256i high = _mm256_and_si256(_mm256_srli_epi32(words, 8), _mm256_set1_epi32(0x1F));
+    __m256i low = _mm256_and_si256(_mm256_srli_epi32(words, 16), _mm256_set1_epi32(0xFF));
+    return _mm256_or_si256(_mm256_slli_epi32(high, 8), low);
+}
+
+__attribute__((target("avx2")))
+static uint32_t tsScanBlockAvx2(const uint8_t* data, uint16_t* pids)
+{
+    const __m256i index = _mm256_setr_epi32(0, TS_PACKET_SIZE, 2 * TS_PACKET_SIZE, 3 * TS_PACKET_SIZE,
+                                            4 * TS_PACKET_SIZE, 5 * TS_PACKET_SIZE, 6 * TS_PACKET_SIZE,
+                                            7 * TS_PACKET_SIZE);
+    const __m256i sync = _mm256_set1_epi32(TS_SYNC_BYTE);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    __m256i first = _mm256_i32gather_epi32((const int*) data, index, 1);
+    __m256i second = _mm256_i32gather_epi32((const int*) (data + 8 * TS_PACKET_SIZE), index, 1);
+    __m256i packed;
+    uint32_t mask;
+    mask = (uint32_t) (~_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_and_si256(first, byteMask), sync))) & 0xFF);
+    mask |= (uint32_t) (~_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_and_si256(second, byteMask), sync))) & 0xFF) << 8;
+    // packs works per 128-bit lane, the permute restores packet order
+    packed = _mm256_packs_epi32(tsScanPidAvx2(first), tsScanPidAvx2(second));
+    _mm256_storeu_si256((__m256i*) pids, _mm256_permute4x64_epi64(packed, 0xD8));
+    return mask;
+}
+
+#endif
+
+#ifdef TS_SCAN_HAVE_NEON
+
+static uint32_t tsScanBlockNeon(const uint8_t* data, uint16_t* pids)
+{
+    static const uint32_t laneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(laneBits);
+    const uint32x4_t sync = vdupq_n_u32(TS_SYNC_BYTE);
+    uint32_t words[4];
+    uint32x4_t v;
+    uint32x4_t pid;
+    uint32x2_t sum;
+    uint32_t mask = 0;
+    uint32_t g;
+    for (g = 0; g < 4; g++)
+    {
+        const uint8_t* p = data + g * 4 * TS_PACKET_SIZE;
+        words[0] = tsScanLoad32(p);
+        words[1] = tsScanLoad32(p + TS_PACKET_SIZE);
+        words[2] = tsScanLoad32(p + 2 * TS_PACKET_SIZE);
+        words[3] = tsScanLoad32(p + 3 * TS_PACKET_SIZE);
+        v = vld1q_u32(words);
+        // lanes without sync contribute their bit, then a horizontal add folds them
+        v = vandq_u32(vmvnq_u32(vceqq_u32(vandq_u32(v, vdupq_n_u32(0xFF)), sync)), bits);
+        sum = vadd_u32(vget_low_u32(v), vget_high_u32(v));
+        sum = vpadd_u32(sum, sum);
+        mask |= vget_lane_u32(sum, 0) << (g * 4);
+        v = vld1q_u32(words);
+        pid = vorrq_u32(vshlq_n_u32(vandq_u32(vshrq_n_u32(v, 8), vdupq_n_u32(0x1F)), 8),
+                        vandq_u32(vshrq_n_u32(v, 16), vdupq_n_u32(0xFF)));
+        vst1_u16(pids + g * 4, vmovn_u32(pid));
+    }
+    return mask;
+}
+
+#endif
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja bira implementaciju kernela. Poziva se tacno jednom.
+ *
+ *****************************************************************************/
+static void tsScanInitOnce(void)
+{
+    scanBlock = tsScanBlockScalar;
+    scanImplementation = TS_SCAN_IMPL_SCALAR;
+#ifdef TS_SCAN_HAVE_X86
+    __builtin_cpu_init();
+    avx2Supported = (uint8_t) (__builtin_cpu_supports("avx2") != 0);
+    if (avx2Supported)
+    {
+        scanBlock = tsScanBlockAvx2;
+        scanImplementation = TS_SCAN_IMPL_AVX2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        scanBlock = tsScanBlockSse2;
+        scanImplementation = TS_SCAN_IMPL_SSE2;
+    }
+#endif
+#ifdef TS_SCAN_HAVE_NEON
+    scanBlock = tsScanBlockNeon;
+    scanImplementation = TS_SCAN_IMPL_NEON;
+#endif
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja trazi sljedeci sync bajt koji je potvrdjen i u sljedecem
+ * paketu (ili iza kojeg vise nema cijelog paketa).
+ *
+ * @return pomjeraj pronadjenog paketa, ili pomjeraj iza kojeg nema cijelog paketa
+ *****************************************************************************/
+static uint32_t tsScanResync(const uint8_t* data, uint32_t size, uint32_t offset)
+{
+    const uint8_t* found;
+    while (offset + TS_PACKET_SIZE <= size)
+    {
+        found = (const uint8_t*) memchr(data + offset, TS_SYNC_BYTE, size - TS_PACKET_SIZE + 1 - offset);
+        if (found == NULL)
+            return size - TS_PACKET_SIZE + 1;
+        offset = (uint32_t) (found - data);
+        if (offset + TS_PACKET_SIZE >= size || data[offset + TS_PACKET_SIZE] == TS_SYNC_BYTE)
+            return offset;
+        offset++;
+    }
+    return offset;
+}
+
+uint32_t tsScanPackets(const uint8_t* data, uint32_t size, uint32_t* offsets, uint16_t* pids, uint32_t maxPackets,
+                       uint32_t* consumed, uint32_t* resyncs)
+{
+    uint32_t offset = 0;
+    uint32_t count = 0;
+    uint32_t good;
+    uint32_t mask;
+    uint32_t i;
+    pthread_once(&scanOnce, tsScanInitOnce);
+    *resyncs = 0;
+    while (count < maxPackets && offset + TS_PACKET_SIZE <= size)
+    {
+        if (count + TS_SCAN_BLOCK_PACKETS <= maxPackets && offset + TS_SCAN_BLOCK_SIZE <= size)
+        {
+            mask = scanBlock(data + offset, pids + count);
+            good = (mask == 0) ? TS_SCAN_BLOCK_PACKETS : (uint32_t) __builtin_ctz(mask);
+            for (i = 0; i < good; i++)
+            {
+                offsets[count + i] = offset + i * TS_PACKET_SIZE;
+            }
+            count += good;
+            offset += good * TS_PACKET_SIZE;
+            if (mask == 0)
+                continue;
+        }
+        else if (data[offset] == TS_SYNC_BYTE)
+        {
+            offsets[count] = offset;
+            pids[count] = (uint16_t) (((data[offset + 1] << 8) | data[offset + 2]) & 0x1FFF);
+            count++;
+            offset += TS_PACKET_SIZE;
+            continue;
+        }
+        (*resyncs)++;
+        offset = tsScanResync(data, size, offset + 1);
+    }
+    *consumed = offset;
+    return count;
+}
+
+TsScanImplementation tsScanGetImplementation(void)
+{
+    pthread_once(&scanOnce, tsScanInitOnce);
+    return scanImplementation;
+}
+
+int32_t tsScanSelectImplementation(TsScanImplementation implementation)
+{
+    pthread_once(&scanOnce, tsScanInitOnce);
+    if (implementation == TS_SCAN_IMPL_SCALAR)
+    {
+        scanBlock = tsScanBlockScalar;
+        scanImplementation = implementation;
+        return 0;
+    }
+#ifdef TS_SCAN_HAVE_X86
+    if (implementation == TS_SCAN_IMPL_SSE2 && __builtin_cpu_supports("sse2"))
+    {
+        scanBlock = tsScanBlockSse2;
+        scanImplementation = implementation;
+        return 0;
+    }
+    if (implementation == TS_SCAN_IMPL_AVX2 && avx2Supported)
+    {
+        scanBlock = tsScanBlockAvx2;
+        scanImplementation = implementation;
+        return 0;
+    }
+#endif
+#ifdef TS_SCAN_HAVE_NEON
+    if (implementation == TS_SCAN_IMPL_NEON)
+    {
+        scanBlock = tsScanBlockNeon;
+        scanImplementation = implementation;
+        return 0;
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_scan.h
+ * \brief
+ * Ovaj modul realizuje brzi prolaz kroz niz transportnih paketa: provjeru
+ * sync bajta i izdvajanje PID-a za blok od TS_SCAN_BLOCK_PACKETS paketa
+ * odjednom. Implementacija se bira u toku izvrsavanja (AVX2 ili SSE2 na x86,
+ * NEON na ARM-u, a u suprotnom skalarna), a nakon gubitka sinhronizacije
+ * sljedeci sync bajt se trazi sa memchr.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef TS_SCAN_H
+#define TS_SCAN_H
+
+#include <stdint.h>
+
+/* broj paketa koji se obradjuju jednim pozivom SIMD kernela */
+#define TS_SCAN_BLOCK_PACKETS 16
+
+typedef enum _TsScanImplementation
+{
+    TS_SCAN_IMPL_SCALAR = 0, /* radi na svim procesorima */
+    TS_SCAN_IMPL_SSE2,
+    TS_SCAN_IMPL_AVX2,
+    TS_SCAN_IMPL_NEON
+} TsScanImplementation;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pronalazi uzastopne transportne pakete u nizu bajtova i za
+ * svaki upisuje pomjeraj i PID. Ako paket nema sync bajt, preskace se do
+ * sljedeceg sync bajta koji je potvrdjen i u paketu iza njega.
+ *
+ * @param data - [in] niz bajtova
+ * @param size - [in] duzina niza
+ * @param offsets - [out] pomjeraji pronadjenih paketa u nizu
+ * @param pids - [out] PID-ovi pronadjenih paketa
+ * @param maxPackets - [in] velicina nizova offsets i pids
+ * @param consumed - [out] broj obradjenih bajtova (sljedeci poziv pocinje od ovog pomjeraja)
+ * @param resyncs - [out] broj gubitaka sinhronizacije
+ * @return broj pronadjenih paketa
+ *****************************************************************************/
+uint32_t tsScanPackets(const uint8_t* data, uint32_t size, uint32_t* offsets, uint16_t* pids, uint32_t maxPackets,
+                       uint32_t* consumed, uint32_t* resyncs);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja vraca implementaciju koja je trenutno u upotrebi.
+ *
+ * @return izabrana implementacija
+ *****************************************************************************/
+TsScanImplementation tsScanGetImplementation(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja forsira odredjenu implementaciju (koristi se za mjerenja).
+ *
+ * @param implementation - [in] zeljena implementacija
+ * @return 0 ako je implementacija podrzana na ovom procesoru, -1 u suprotnom
+ *****************************************************************************/
+int32_t tsScanSelectImplementation(TsScanImplementation implementation);
+
+#endif
@@ -0,0 +1,126 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file ts_scan_bench.c
+ * \brief
+ * Program za mjerenje brzine provjere sync bajta i izdvajanja PID-a
+ * (ts_scan) za sve implementacije podrzane na ovom procesoru, na ispravnom
+ * toku i na toku sa ubacenim smetnjama. Ispisuje se broj nanosekundi po paketu.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "ts_scan.h"
+#include "section_assembler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/* 2048 paketa (385 KB) staje u L2 kes, pa se mjeri kernel, a ne propusnost memorije */
+#define BENCH_PACKETS 2048u
+#define BENCH_PASSES 4096
+#define BENCH_BATCH 256
+/* u toku sa smetnjama, posle svakih BENCH_CORRUPT_EVERY paketa ubacuje se nekoliko bajtova */
+#define BENCH_CORRUPT_EVERY 500
+
+static const char* implementationNames[] = {"scalar", "sse2", "avx2", "neon"};
+
+static double benchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static void benchRun(const char* name, const uint8_t* data, uint32_t size)
+{
+    static uint32_t offsets[BENCH_BATCH];
+    static uint16_t pids[BENCH_BATCH];
+    uint64_t packets = 0;
+    uint64_t resyncTotal = 0;
+    uint32_t checksum = 0;
+    uint32_t offset;
+    uint32_t consumed;
+    uint32_t resyncs;
+    uint32_t count;
+    uint32_t pass;
+    uint32_t i;
+    double start;
+    double elapsed;
+    start = benchNow();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+        offset = 0;
+        do
+        {
+            count = tsScanPackets(data + offset, size - offset, offsets, pids, BENCH_BATCH, &consumed, &resyncs);
+            for (i = 0; i < count; i++)
+            {
+                checksum += pids[i];
+            }
+            packets += count;
+            resyncTotal += resyncs;
+            offset += consumed;
+        }
+        while (count == BENCH_BATCH);
+    }
+    elapsed = benchNow() - start;
+    printf("%-6s %-9s: %5.3f ns/packet, %llu packets, %llu resyncs (pid sum %08x)\n",
+           implementationNames[tsScanGetImplementation()], name, elapsed / (double) packets,
+           (unsigned long long) packets, (unsigned long long) resyncTotal, checksum);
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    uint8_t* clean;
+    uint8_t* corrupt;
+    uint8_t* p;
+    uint32_t cleanSize = BENCH_PACKETS * TS_PACKET_SIZE;
+    uint32_t corruptSize = 0;
+    uint32_t i;
+    uint32_t impl;
+
+    clean = (uint8_t*) malloc(cleanSize);
+    corrupt = (uint8_t*) malloc(cleanSize + (BENCH_PACKETS / BENCH_CORRUPT_EVERY + 1) * 8);
+    if (clean == NULL || corrupt == NULL)
+        return 1;
+    srand(1);
+    for (i = 0; i < BENCH_PACKETS; i++)
+    {
+        p = clean + i * TS_PACKET_SIZE;
+        memset(p, 0xA5, TS_PACKET_SIZE);
+        p[0] = TS_SYNC_BYTE;
+        p[1] = (uint8_t) ((rand() & 0x1F) | ((i & 7) == 0 ? 0x40 : 0));
+        p[2] = (uint8_t) rand();
+        p[3] = (uint8_t) (0x10 | (i & 0x0F));
+        if (i % BENCH_CORRUPT_EVERY == BENCH_CORRUPT_EVERY - 1)
+        {
+            memcpy(corrupt + corruptSize, "\x12\x34\x47\x56\x78", 5);
+            corruptSize += 5;
+        }
+        memcpy(corrupt + corruptSize, p, TS_PACKET_SIZE);
+        corruptSize += TS_PACKET_SIZE;
+    }
+
+    for (impl = TS_SCAN_IMPL_SCALAR; impl <= TS_SCAN_IMPL_NEON; impl++)
+    {
+        if (tsScanSelectImplementation((TsScanImplementation) impl) != 0)
+            continue;
+        benchRun("clean", clean, cleanSize);
+        benchRun("corrupted", corrupt, corruptSize);
+    }
+    free(clean);
+    free(corrupt);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file zap_machine.c
+ * \brief
+ * Mutex stiti samo zahtjev; nit masine ga ne drzi dok poziva plejer. Kada
+ * se zahtjev zamijeni, masina krece ispocetka sa novim programom, a stream
+ * koji vec ima trazeni PID ostaje netaknut.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "zap_machine.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "clock_source.h"
+#include "zap_stats.h"
+
+static void zapMachineRemove(ZapMachine* machine, ZapStream stream, const ZapTarget* target)
+{
+    uint64_t start;
+    if (machine->playing.pid[stream] == 0)
+        return;
+    if (machine->playing.pid[stream] == target->pid[stream] && machine->playing.type[stream] == target->type[stream])
+        return;
+    start = clockNow();
+    if (machine->ops.removeStream(machine->ops.context, stream) != 0)
+        printf("%s: ERROR stream %u not removed\n", __FUNCTION__, machine->playing.pid[stream]);
+    zapStatsRecord((stream == ZAP_STREAM_VIDEO) ? ZAP_PHASE_VIDEO_REMOVE : ZAP_PHASE_AUDIO_REMOVE, clockNow() - start);
+    machine->playing.pid[stream] = 0;
+    machine->playing.type[stream] = 0;
+}
+
+static void zapMachineCreate(ZapMachine* machine, ZapStream stream, const ZapTarget* target)
+{
+    uint64_t start;
+    // only a zero PID means "no stream": VIDEO_TYPE_H264 is 0 in tdp_api.h
+    if (target->pid[stream] == 0 || machine->playing.pid[stream] != 0)
+        return;
+    start = clockNow();
+    if (machine->ops.createStream(machine->ops.context, stream, target->pid[stream], target->type[stream]) == 0)
+    {
+        machine->playing.pid[stream] = target->pid[stream];
+        machine->playing.type[stream] = target->type[stream];
+    }
+    else
+    {
+        printf("%s: ERROR stream %u not created\n", __FUNCTION__, target->pid[stream]);
+    }
+    zapStatsRecord((stream == ZAP_STREAM_VIDEO) ? ZAP_PHASE_VIDEO_CREATE : ZAP_PHASE_AUDIO_CREATE, clockNow() - start);
+}
+
+/* runs one phase without the mutex and returns the next one */
+static ZapState zapMachineStep(ZapMachine* machine, ZapState state, const ZapTarget* target)
+{
+    switch (state)
+    {
+    case ZAP_STATE_VIDEO_REMOVE:
+        zapMachineRemove(machine, ZAP_STREAM_VIDEO, target);
+        return ZAP_STATE_VIDEO_CREATE;
+    case ZAP_STATE_VIDEO_CREATE:
+        zapMachineCreate(machine, ZAP_STREAM_VIDEO, target);
+        return ZAP_STATE_AUDIO_REMOVE;
+    case ZAP_STATE_AUDIO_REMOVE:
+        zapMachineRemove(machine, ZAP_STREAM_AUDIO, target);
+        return ZAP_STATE_AUDIO_CREATE;
+    case ZAP_STATE_AUDIO_CREATE:
+        zapMachineCreate(machine, ZAP_STREAM_AUDIO, target);
+        machine->playing.service_number = target->service_number;
+        return ZAP_STATE_IDLE;
+    default:
+        return ZAP_STATE_IDLE;
+    }
+}
+
+static void* zapMachineThread(void* arg)
+{
+    ZapMachine* machine = (ZapMachine*) arg;
+    ZapTarget target;
+    ZapState state = ZAP_STATE_IDLE;
+    // on virtual time the clock waits for the zap steps, starting with the hand-off of zapMachineInit
+    clockThreadDriven(1);
+    clockTakeOver();
+    pthread_mutex_lock(&(machine->mutex));
+    while (!machine->stop)
+    {
+        // every phase boundary is a point where a newer request takes over
+        if (machine->requested)
+        {
+            if (state != ZAP_STATE_IDLE)
+                machine->retargets++;
+            target = machine->request;
+            machine->requested = 0;
+            state = ZAP_STATE_VIDEO_REMOVE;
+        }
+        machine->state = state;
+        if (state == ZAP_STATE_IDLE)
+        {
+            clockWait(&(machine->condition), &(machine->mutex), CLOCK_FOREVER);
+            continue;
+        }
+        pthread_mutex_unlock(&(machine->mutex));
+        state = zapMachineStep(machine, state, &target);
+        pthread_mutex_lock(&(machine->mutex));
+    }
+    machine->state = ZAP_STATE_IDLE;
+    pthread_mutex_unlock(&(machine->mutex));
+    clockThreadDriven(0);
+    return NULL;
+}
+
+int32_t zapMachineInit(ZapMachine* machine, const ZapMachineOps* ops, const ZapTarget* playing)
+{
+    memset(machine, 0, sizeof (ZapMachine));
+    machine->ops = *ops;
+    machine->playing = *playing;
+    pthread_mutex_init(&(machine->mutex), NULL);
+    pthread_cond_init(&(machine->condition), NULL);
+    clockHandOff();
+    if (pthread_create(&(machine->thread), NULL, zapMachineThread, machine) != 0)
+    {
+        printf("%s: ERROR zap thread not created\n", __FUNCTION__);
+        // the hand-off is taken back by this thread
+        clockTakeOver();
+        clockThreadIdle();
+        pthread_cond_destroy(&(machine->condition));
+        pthread_mutex_destroy(&(machine->mutex));
+        return -1;
+    }
+    return 0;
+}
+
+void zapMachineDeinit(ZapMachine* machine)
+{
+    pthread_mutex_lock(&(machine->mutex));
+    machine->stop = 1;
+    clockBroadcast(&(machine->condition));
+    pthread_mutex_unlock(&(machine->mutex));
+    pthread_join(machine->thread, NULL);
+    pthread_cond_destroy(&(machine->condition));
+    pthread_mutex_destroy(&(machine->mutex));
+}
+
+void zapMachineRequest(ZapMachine* machine, const ZapTarget* target)
+{
+    pthread_mutex_lock(&(machine->mutex));
+    machine->request = *target;
+    machine->requested = 1;
+    clockBroadcast(&(machine->condition));
+    pthread_mutex_unlock(&(machine->mutex));
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file zap_machine.h
+ * \brief
+ * Ovaj modul realizuje promjenu programa kao masinu stanja koja se izvrsava
+ * u posebnoj niti: uklanjanje video streama, kreiranje video streama,
+ * uklanjanje audio streama i kreiranje audio streama. Nit korisnickog
+ * interfejsa samo upisuje zahtjev i nikada ne ceka plejer. Novi zahtjev
+ * zamjenjuje onaj koji se izvrsava na granici sljedeceg koraka, a koraci
+ * ciji je stream vec onakav kakav novi program trazi se preskacu.
+ * Plejer se zadaje preko pokazivaca na funkcije, tako da se isti kod
+ * koristi i na racunaru.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef ZAP_MACHINE_H
+#define ZAP_MACHINE_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+typedef enum
+{
+    ZAP_STREAM_VIDEO = 0,
+    ZAP_STREAM_AUDIO,
+    ZAP_STREAM_COUNT
+} ZapStream;
+
+typedef enum
+{
+    ZAP_STATE_IDLE = 0, // nema zahtjeva
+    ZAP_STATE_VIDEO_REMOVE,
+    ZAP_STATE_VIDEO_CREATE,
+    ZAP_STATE_AUDIO_REMOVE,
+    ZAP_STATE_AUDIO_CREATE
+} ZapState;
+
+typedef struct _ZapTarget
+{
+    uint32_t service_number;
+    uint16_t pid[ZAP_STREAM_COUNT]; // 0 ako program nema stream
+    uint8_t type[ZAP_STREAM_COUNT];
+} ZapTarget;
+
+typedef struct _ZapMachineOps
+{
+    /* uklanja stream, vraca 0 ako nema greske */
+    int32_t(*removeStream)(void* context, ZapStream stream);
+    /* kreira stream, vraca 0 ako nema greske */
+    int32_t(*createStream)(void* context, ZapStream stream, uint16_t pid, uint8_t type);
+    void* context;
+} ZapMachineOps;
+
+typedef struct _ZapMachine
+{
+    ZapMachineOps ops;
+    ZapTarget playing; // streamovi koji postoje u plejeru (samo nit masine)
+    ZapTarget request;
+    uint8_t requested; // request jos nije preuzet
+    uint8_t stop;
+    ZapState state;
+    uint32_t retargets; // zahtjevi zamijenjeni prije nego sto su zavrseni
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+} ZapMachine;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pokrece nit masine stanja.
+ *
+ * @param machine - [out] masina stanja
+ * @param ops - [in] funkcije plejera
+ * @param playing - [in] streamovi koji su vec kreirani
+ * @return 0 ako nema greske, -1 u suprotnom
+ *****************************************************************************/
+int32_t zapMachineInit(ZapMachine* machine, const ZapMachineOps* ops, const ZapTarget* playing);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja zaustavlja nit masine stanja nakon koraka koji se izvrsava.
+ * Zahtjev koji nije zavrsen se odbacuje.
+ *
+ * @param machine - [in/out] masina stanja
+ *****************************************************************************/
+void zapMachineDeinit(ZapMachine* machine);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje zahtjev za promjenu programa i vraca se odmah. Ako
+ * se prethodni zahtjev jos izvrsava, masina prelazi na novi na granici
+ * sljedeceg koraka.
+ *
+ * @param machine - [in/out] masina stanja
+ * @param target - [in] program i njegovi streamovi
+ *****************************************************************************/
+void zapMachineRequest(ZapMachine* machine, const ZapTarget* target);
+
+#endif
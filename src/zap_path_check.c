@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file zap_path_check.c
+ * \brief
+ * Program koji pokrece pravi device_control.c nad libtdp_host.a: zakljucava
+ * tjuner na multipleks koji pravi ts_writer, ceka PAT i PMT tabele, prelazi
+ * na drugi program kroz petlju dogadjaja i na kraju provjerava dnevnik
+ * poziva tdp_api funkcija. OSD je zamijenjen sa drawing_host.c. Ispisuje OK,
+ * ili dnevnik poziva i izlazi sa 1 ako provjera ne prodje.
+ *
+ * Upotreba: zap_path_check
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "tdp_api.h"
+#include "tdp_host.h"
+#include "ts_writer.h"
+#include "clock_source.h"
+#include "event_loop.h"
+#include "channel_db.h"
+#include "config_parser.h"
+#include "device_control.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECK_FREQUENCY 754
+#define CHECK_SERVICES 4 // PAT index 0 is the NIT
+#define CHECK_ZAP_SERVICE 2
+#define CHECK_CYCLE_PACKETS 100
+#define CHECK_SETTLE_MS 100
+#define CHECK_TIMEOUT_MS 5000
+#define CHECK_POLL_MS 10
+
+static const TsWriterService services[CHECK_SERVICES] = {
+    {0, 0x10, 0, 0, 0, 0, 1},
+    {101, 0x100, 0x101, 0x02, 0x102, 0x03, 0},
+    {102, 0x110, 0x111, 0x02, 0x112, 0x03, 0},
+    {103, 0x120, 0x121, 0x02, 0x122, 0x03, 0},
+};
+
+static pthread_mutex_t checkMutex = PTHREAD_MUTEX_INITIALIZER;
+static int32_t zapResult = ERROR;
+static uint8_t zapDone = 0;
+
+static void* checkLoopThread(void* arg)
+{
+    eventLoopRun();
+    return NULL;
+}
+
+/* runs on the event loop thread, like a key press from remote.c */
+static void checkZap(void* arg)
+{
+    int32_t result = remoteServiceCallback((uint32_t) (uintptr_t) arg);
+    pthread_mutex_lock(&checkMutex);
+    zapResult = result;
+    zapDone = 1;
+    pthread_mutex_unlock(&checkMutex);
+}
+
+static void checkSleep(uint32_t ms)
+{
+    struct timespec delay;
+    delay.tv_sec = ms / 1000;
+    delay.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&delay, NULL);
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja trazi poziv u dnevniku od zadatog indeksa. Argument cija je
+ * vrijednost CHECK_ANY se ne poredi.
+ *
+ * @param function - [in] naziv funkcije
+ * @param a0, a1 - [in] prva dva argumenta
+ * @param from - [in] prvi indeks koji se pretrazuje
+ * @return indeks poziva, -1 ako ga nema
+ *****************************************************************************/
+#define CHECK_ANY 0xFFFFFFFFu
+static int32_t checkFind(const char* function, uint32_t a0, uint32_t a1, uint32_t from)
+{
+    TdpHostCall call;
+    uint32_t i;
+    for (i = from; tdpHostGetCall(i, &call) == 0; i++)
+    {
+        if (strcmp(call.function, function) == 0 && call.result == NO_ERROR &&
+                (a0 == CHECK_ANY || call.args[0] == a0) && (a1 == CHECK_ANY || call.args[1] == a1))
+            return (int32_t) i;
+    }
+    return -1;
+}
+
+static int32_t checkFail(const char* what)
+{
+    printf("FAIL: %s\n", what);
+    tdpHostDumpCalls(stdout);
+    return 1;
+}
+
+/* waits until the zap thread has created both streams of the service */
+static int32_t checkWaitStreams(const TsWriterService* service, uint64_t deadline)
+{
+    while (clockNow() < deadline)
+    {
+        if (checkFind("Player_Stream_Create", service->audioPid, CHECK_ANY, 0) >= 0)
+            return 0;
+        checkSleep(CHECK_POLL_MS);
+    }
+    return -1;
+}
+
+static int32_t checkZapToService(uint32_t service_number, uint64_t deadline)
+{
+    int32_t result;
+    uint8_t done;
+    // the service is refused until its PMT has arrived
+    while (clockNow() < deadline)
+    {
+        pthread_mutex_lock(&checkMutex);
+        zapDone = 0;
+        pthread_mutex_unlock(&checkMutex);
+        eventLoopPost(checkZap, (void*) (uintptr_t) service_number);
+        do
+        {
+            checkSleep(CHECK_POLL_MS);
+            pthread_mutex_lock(&checkMutex);
+            done = zapDone;
+            result = zapResult;
+            pthread_mutex_unlock(&checkMutex);
+        }
+        while (!done && clockNow() < deadline);
+        if (done && result == NO_ERROR)
+            return 0;
+    }
+    return -1;
+}
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja provjerava dnevnik poziva nakon deviceDeInit.
+ *
+ * @return 0 ako je dnevnik ispravan, 1 u suprotnom
+ *****************************************************************************/
+static int32_t checkCallLog(void)
+{
+    const TsWriterService* boot = &services[1];
+    const TsWriterService* target = &services[CHECK_ZAP_SERVICE];
+    TdpHostCall call;
+    int32_t setFilters = 0;
+    int32_t patSet;
+    int32_t patFree;
+    int32_t videoCreate;
+    int32_t audioCreate;
+    int32_t index;
+    uint32_t count = tdpHostCallCount();
+    uint32_t i;
+
+    if (count == 0 || tdpHostGetCall(0, &call) != 0 || strcmp(call.function, "Tuner_Init") != 0)
+        return checkFail("Tuner_Init is not the first call");
+    if (tdpHostGetCall(count - 1, &call) != 0 || strcmp(call.function, "Tuner_Deinit") != 0)
+        return checkFail("Tuner_Deinit is not the last call");
+    if (checkFind("Tuner_Lock_To_Frequency", CHECK_FREQUENCY * MHZ, CHECK_ANY, 0) < 0)
+        return checkFail("tuner not locked to the configured frequency");
+
+    // the PAT filter is freed before the PMT filters are set
+    patSet = checkFind("Demux_Set_Filter", 0x00, 0x00, 0);
+    if (patSet < 0 || tdpHostGetCall((uint32_t) patSet, &call) != 0)
+        return checkFail("no PAT filter");
+    patFree = checkFind("Demux_Free_Filter", call.args[2], CHECK_ANY, (uint32_t) patSet + 1);
+    if (patFree < 0)
+        return checkFail("PAT filter not freed");
+    for (i = 1; i < CHECK_SERVICES; i++)
+    {
+        if (checkFind("Demux_Set_Filter", services[i].pmtPid, 0x02, (uint32_t) patFree + 1) < 0)
+            return checkFail("PMT filter missing");
+    }
+    for (i = 0; i < count; i++)
+    {
+        tdpHostGetCall(i, &call);
+        if (call.result != NO_ERROR)
+            continue;
+        if (strcmp(call.function, "Demux_Set_Filter") == 0)
+            setFilters++;
+        if (strcmp(call.function, "Demux_Free_Filter") == 0)
+            setFilters--;
+    }
+    if (setFilters != 0)
+        return checkFail("demux filters left open");
+
+    // the configured PIDs play right after the lock, the zap replaces both streams
+    index = checkFind("Player_Stream_Create", boot->videoPid, VIDEO_TYPE_MPEG2, 0);
+    if (index < 0 || checkFind("Player_Stream_Create", boot->audioPid, AUDIO_TYPE_DOLBY_AC3, (uint32_t) index + 1) < 0)
+        return checkFail("boot streams not created");
+    videoCreate = checkFind("Player_Stream_Create", target->videoPid, VIDEO_TYPE_MPEG2, 0);
+    audioCreate = checkFind("Player_Stream_Create", target->audioPid, AUDIO_TYPE_DOLBY_AC3, 0);
+    if (videoCreate < 0 || audioCreate < videoCreate)
+        return checkFail("zap streams not created in order");
+    index = checkFind("Player_Stream_Remove", CHECK_ANY, CHECK_ANY, 0);
+    if (index < 0 || index > videoCreate)
+        return checkFail("video stream not removed before the zap");
+    index = checkFind("Player_Stream_Remove", CHECK_ANY, CHECK_ANY, (uint32_t) videoCreate + 1);
+    if (index < 0 || index > audioCreate)
+        return checkFail("audio stream not removed before the zap");
+    return 0;
+}
+
+int32_t main(int32_t argc, char** argv)
+{
+    char tsPath[] = "/tmp/zap_path_check_XXXXXX";
+    TdpHostConfig hostConfig;
+    config_parameters parms;
+    DeviceHandle handle;
+    pthread_t loopThread;
+    uint64_t deadline;
+    int32_t result = 0;
+    int fd;
+
+    fd = mkstemp(tsPath);
+    if (fd < 0)
+    {
+        printf("%s: ERROR cannot create a temporary file\n", __FUNCTION__);
+        return 1;
+    }
+    close(fd);
+    if (tsWriterWriteMultiplex(tsPath, services, CHECK_SERVICES, 1, CHECK_CYCLE_PACKETS) != 0)
+    {
+        unlink(tsPath);
+        return 1;
+    }
+    // the previous run must not start a service from the channel database
+    unlink(CHANNEL_DB_PATH);
+
+    memset(&hostConfig, 0, sizeof (hostConfig));
+    hostConfig.tsPath = tsPath;
+    hostConfig.lockDelayMs = 50;
+    hostConfig.streamCreateMs = 5;
+    hostConfig.bitrate = 2000000;
+    hostConfig.filterCount = 8;
+    tdpHostConfigure(&hostConfig);
+
+    memset(&parms, 0, sizeof (parms));
+    parms.frequency = CHECK_FREQUENCY;
+    parms.bandwidth = 8;
+    parms.module = DVB_T;
+    parms.vPid = services[1].videoPid;
+    parms.vType = VIDEO_TYPE_MPEG2;
+    parms.aPid = services[1].audioPid;
+    parms.aType = AUDIO_TYPE_DOLBY_AC3;
+    parms.zapSettleMs = CHECK_SETTLE_MS;
+
+    if (eventLoopInit() != 0 || pthread_create(&loopThread, NULL, checkLoopThread, NULL) != 0)
+    {
+        unlink(tsPath);
+        return 1;
+    }
+    memset(&handle, 0, sizeof (handle));
+    if (deviceInit(&parms, &handle) != NO_ERROR)
+    {
+        eventLoopStop();
+        pthread_join(loopThread, NULL);
+        eventLoopDeinit();
+        unlink(tsPath);
+        return checkFail("deviceInit failed");
+    }
+
+    deadline = clockNow() + CHECK_TIMEOUT_MS * CLOCK_NS_PER_MS;
+    if (checkZapToService(CHECK_ZAP_SERVICE, deadline) != 0)
+        result = -1;
+    else if (checkWaitStreams(&services[CHECK_ZAP_SERVICE], deadline) != 0)
+        result = -2;
+
+    eventLoopStop();
+    pthread_join(loopThread, NULL);
+    deviceDeInit(&handle);
+    eventLoopDeinit();
+    unlink(tsPath);
+    unlink(CHANNEL_DB_PATH);
+
+    if (result == -1)
+        return checkFail("service never became ready");
+    if (result == -2)
+        return checkFail("zap streams never created");
+    if (checkCallLog() != 0)
+        return 1;
+    printf("OK: %u tdp_api calls, %llu sections delivered\n", tdpHostCallCount(),
+           (unsigned long long) tdpHostSectionCount());
+    return 0;
+}
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file zap_stats.c
+ * \brief
+ * Vrijednost v < 32 us ide u korpu v. Za vece vrijednosti grupa g je broj
+ * bita za koji se v pomjera udesno da bi pao u opseg [16, 32), a korpa je
+ * g * 16 + (v >> g). Korpe susjednih grupa se tako nastavljaju bez rupa.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+#include "zap_stats.h"
+#include <stdint.h>
+#include <string.h>
+
+#define ZAP_STATS_HALF (ZAP_STATS_SUB_BUCKETS / 2)
+#define ZAP_STATS_SUB_BITS 5
+
+static uint32_t histogram[ZAP_PHASE_COUNT][ZAP_STATS_BUCKETS];
+static uint32_t maxima[ZAP_PHASE_COUNT];
+static uint64_t pendingKeyEvent = 0;
+/* key press of the zap whose banner the render thread has not shown yet */
+static uint64_t pendingOsd = 0;
+
+static const char* phaseNames[ZAP_PHASE_COUNT] = {
+    "key -> dispatch",
+    "video remove",
+    "video create",
+    "audio remove",
+    "audio create",
+    "OSD flip",
+    "key -> OSD (total)"
+};
+
+static uint32_t zapStatsBucket(uint32_t value)
+{
+    uint32_t group;
+    if (value < ZAP_STATS_SUB_BUCKETS)
+        return value;
+    group = (uint32_t) (31 - __builtin_clz(value)) - (ZAP_STATS_SUB_BITS - 1);
+    return group * ZAP_STATS_HALF + (value >> group);
+}
+
+/* highest value that falls into the bucket, percentiles are reported conservatively */
+static uint32_t zapStatsBucketValue(uint32_t bucket)
+{
+    uint32_t group;
+    uint32_t sub;
+    if (bucket < ZAP_STATS_SUB_BUCKETS)
+        return bucket;
+    group = bucket / ZAP_STATS_HALF - 1;
+    sub = bucket - group * ZAP_STATS_HALF;
+    return (uint32_t) ((((uint64_t) sub + 1) << group) - 1);
+}
+
+void zapStatsKeyEvent(uint64_t timestamp)
+{
+    __atomic_store_n(&pendingKeyEvent, timestamp, __ATOMIC_RELEASE);
+}
+
+uint64_t zapStatsTakeKeyEvent(void)
+{
+    return __atomic_exchange_n(&pendingKeyEvent, 0, __ATOMIC_ACQ_REL);
+}
+
+void zapStatsOsdPending(uint64_t keyTime)
+{
+    __atomic_store_n(&pendingOsd, keyTime, __ATOMIC_RELEASE);
+}
+
+void zapStatsOsdPresented(uint64_t now)
+{
+    uint64_t keyTime = __atomic_exchange_n(&pendingOsd, 0, __ATOMIC_ACQ_REL);
+    if (keyTime != 0 && now >= keyTime)
+        zapStatsRecord(ZAP_PHASE_TOTAL, now - keyTime);
+}
+
+void zapStatsRecord(ZapPhase phase, uint64_t duration)
+{
+    uint64_t us = duration / 1000;
+    uint32_t value = (us > UINT32_MAX) ? UINT32_MAX : (uint32_t) us;
+    uint32_t max;
+    if (phase >= ZAP_PHASE_COUNT)
+        return;
+    __atomic_fetch_add(&histogram[phase][zapStatsBucket(value)], 1, __ATOMIC_RELAXED);
+    max = __atomic_load_n(&maxima[phase], __ATOMIC_RELAXED);
+    while (value > max && !__atomic_compare_exchange_n(&maxima[phase], &max, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void zapStatsGetPercentiles(ZapPhase phase, ZapPercentiles* percentiles)
+{
+    const uint32_t quantiles[3] = {50, 95, 99};
+    uint32_t* targets[3];
+    uint64_t seen = 0;
+    uint64_t count;
+    uint32_t bucket;
+    uint32_t q = 0;
+
+    memset(percentiles, 0, sizeof (ZapPercentiles));
+    if (phase >= ZAP_PHASE_COUNT)
+        return;
+    targets[0] = &(percentiles->p50);
+    targets[1] = &(percentiles->p95);
+    targets[2] = &(percentiles->p99);
+    count = 0;
+    for (bucket = 0; bucket < ZAP_STATS_BUCKETS; bucket++)
+        count += __atomic_load_n(&histogram[phase][bucket], __ATOMIC_RELAXED);
+    percentiles->count = count;
+    percentiles->max = __atomic_load_n(&maxima[phase], __ATOMIC_RELAXED);
+    if (count == 0)
+        return;
+    for (bucket = 0; bucket < ZAP_STATS_BUCKETS && q < 3; bucket++)
+    {
+        seen += __atomic_load_n(&histogram[phase][bucket], __ATOMIC_RELAXED);
+        while (q < 3 && seen * 100 >= count * quantiles[q])
+        {
+            *targets[q] = zapStatsBucketValue(bucket);
+            if (*targets[q] > percentiles->max)
+                *targets[q] = percentiles->max;
+            q++;
+        }
+    }
+}
+
+void zapStatsReport(FILE* out)
+{
+    ZapPercentiles percentiles;
+    uint32_t phase;
+    fprintf(out, "%-20s %8s %10s %10s %10s %10s\n", "zap phase", "count", "p50 ms", "p95 ms", "p99 ms", "max ms");
+    for (phase = 0; phase < ZAP_PHASE_COUNT; phase++)
+    {
+        zapStatsGetPercentiles((ZapPhase) phase, &percentiles);
+        if (percentiles.count == 0)
+            continue;
+        fprintf(out, "%-20s %8llu %10.3f %10.3f %10.3f %10.3f\n", phaseNames[phase], (unsigned long long) percentiles.count,
+                percentiles.p50 / 1e3, percentiles.p95 / 1e3, percentiles.p99 / 1e3, percentiles.max / 1e3);
+    }
+}
+
+void zapStatsReset(void)
+{
+    memset(histogram, 0, sizeof (histogram));
+    memset(maxima, 0, sizeof (maxima));
+    pendingKeyEvent = 0;
+    pendingOsd = 0;
+}
@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * Univerzitet u Banjoj Luci, Elektrotehnicki fakultet
+ *
+ * -----------------------------------------------------
+ * Ispitni zadatak iz predmeta:
+ *
+ * MULTIMEDIJALNI SISTEMI
+ * -----------------------------------------------------
+ * DTV Zapper
+ * -----------------------------------------------------
+ *
+ * \file zap_stats.h
+ * \brief
+ * Ovaj modul mjeri trajanje promjene programa po fazama. Svaka faza ima
+ * histogram sa logaritamsko-linearnim korpama (kao HdrHistogram): vrijednosti
+ * u mikrosekundama se dijele na grupe po stepenu dvojke, a svaka grupa na 16
+ * linearnih korpi, pa je greska percentila najvise oko 6%. Upis je samo
+ * atomsko sabiranje, bez mutex-a, tako da se moze pozivati iz bilo koje niti.
+ *
+ * @Author Milan Maric
+ *
+ *****************************************************************************/
+
+#ifndef ZAP_STATS_H
+#define ZAP_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* vrijednosti ispod ovog broja mikrosekundi imaju svoju korpu */
+#define ZAP_STATS_SUB_BUCKETS 32
+/* korpe do 2^32 us (oko 71 minut) */
+#define ZAP_STATS_BUCKETS (ZAP_STATS_SUB_BUCKETS + 27 * (ZAP_STATS_SUB_BUCKETS / 2))
+
+typedef enum
+{
+    ZAP_PHASE_KEY_DISPATCH = 0, // vrijeme dogadjaja u kernelu -> remoteServiceCallback
+    ZAP_PHASE_VIDEO_REMOVE, // Player_Stream_Remove za video
+    ZAP_PHASE_VIDEO_CREATE, // Player_Stream_Create za video
+    ZAP_PHASE_AUDIO_REMOVE, // Player_Stream_Remove za audio
+    ZAP_PHASE_AUDIO_CREATE, // Player_Stream_Create za audio
+    ZAP_PHASE_OSD_FLIP, // Flip povrsine sa informacijama o programu
+    ZAP_PHASE_TOTAL, // pritisak tastera -> iscrtane informacije o programu
+    ZAP_PHASE_COUNT
+} ZapPhase;
+
+typedef struct _ZapPercentiles
+{
+    uint64_t count;
+    uint32_t p50; // us
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+} ZapPercentiles;
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pamti vrijeme pritiska tastera. Sljedeca promjena programa
+ * mjeri ukupno trajanje od tog trenutka.
+ *
+ * @param timestamp - [in] vrijeme dogadjaja po clockNow() u ns
+ *****************************************************************************/
+void zapStatsKeyEvent(uint64_t timestamp);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja preuzima zapamceno vrijeme pritiska tastera i brise ga.
+ *
+ * @return vrijeme u ns, 0 ako taster nije zapamcen
+ *****************************************************************************/
+uint64_t zapStatsTakeKeyEvent(void);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja pamti vrijeme pritiska tastera za promjenu programa ciji ce
+ * OSD biti iscrtan u drugoj niti. Ukupno trajanje se upisuje tek u
+ * zapStatsOsdPresented.
+ *
+ * @param keyTime - [in] vrijeme pritiska tastera po clockNow() u ns
+ *****************************************************************************/
+void zapStatsOsdPending(uint64_t keyTime);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja se poziva kada su informacije o programu prikazane na
+ * ekranu i upisuje ZAP_PHASE_TOTAL ako promjena programa ceka na to.
+ *
+ * @param now - [in] vrijeme prikaza po clockNow() u ns
+ *****************************************************************************/
+void zapStatsOsdPresented(uint64_t now);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja upisuje trajanje faze u histogram.
+ *
+ * @param phase - [in] faza
+ * @param duration - [in] trajanje u ns
+ *****************************************************************************/
+void zapStatsRecord(ZapPhase phase, uint64_t duration);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja racuna percentile faze.
+ *
+ * @param phase - [in] faza
+ * @param percentiles - [out] broj mjerenja i percentili u us
+ *****************************************************************************/
+void zapStatsGetPercentiles(ZapPhase phase, ZapPercentiles* percentiles);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja ispisuje p50/p95/p99/max za sve faze sa bar jednim mjerenjem.
+ *
+ * @param out - [in] izlazni fajl
+ *****************************************************************************/
+void zapStatsReport(FILE* out);
+
+/****************************************************************************
+ *
+ * @brief
+ * Funkcija koja brise sva mjerenja. Ne smije se pozivati dok druge niti upisuju.
+ *
+ *****************************************************************************/
+void zapStatsReset(void);
+
+#endif